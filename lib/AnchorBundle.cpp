@@ -0,0 +1,550 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+//
+// AnchorBundle.cpp - precompiled, memory-mapped image of the system roots
+//
+#include "AnchorBundle.h"
+#include <security_keychain/Globals.h>
+#include <security_keychain/Certificate.h>
+#include <security_keychain/KeyItem.h>
+#include <security_keychain/KCCursor.h>
+#include <security_utilities/errors.h>
+#include <security_utilities/debugging.h>
+#include <Security/oidscert.h>
+#include <CommonCrypto/CommonDigest.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace Security {
+namespace KeychainCore {
+
+
+const char * const AnchorBundle::defaultPath = "/System/Library/Keychains/SystemRootCertificates.anchors";
+
+static const char *SYSTEM_ROOTS_PATH = "/System/Library/Keychains/SystemRootCertificates.keychain";
+static const char *EV_ROOTS_PATH = "/System/Library/Keychains/EVRoots.plist";
+
+ModuleNexus<AnchorBundle> gAnchorBundle;
+
+
+//
+// The file layout. Everything is in host byte order (the magic number
+// tells), and all offsets are from the start of the file. The three
+// indexes are sorted by key; each key is a SHA-1 digest, of the
+// certificate, of its subject key identifier, or of its normalized
+// subject followed by its public key digest.
+//
+static const uint32 kAnchorBundleMagic = 'ancb';
+static const uint32 kAnchorBundleVersion = 2;
+
+struct AnchorBundle::Header {
+	uint64 rootsSize;			// SystemRootCertificates.keychain as built from
+	int64 rootsModified;		// mtime in nanoseconds
+	uint64 rootsInode;
+	uint64 evSize;				// EVRoots.plist as built from; zero if absent
+	int64 evModified;
+	uint64 evInode;
+	uint32 magic;
+	uint32 version;
+	uint32 size;				// of the whole file
+	uint32 certCount;
+	uint32 certsOffset;			// Cert[certCount]
+	uint32 sha1Offset;			// IndexEntry[certCount]
+	uint32 skidOffset;			// IndexEntry[skidCount]
+	uint32 skidCount;
+	uint32 subjectOffset;		// IndexEntry[subjectCount]
+	uint32 subjectCount;
+	uint32 evOffset;			// EVEntry[evCount]
+	uint32 evCount;
+	uint32 evHashesOffset;		// SHA-1 digests[evHashCount]
+	uint32 evHashCount;
+};
+
+struct AnchorBundle::IndexEntry {
+	uint8 key[CC_SHA1_DIGEST_LENGTH];
+	uint32 cert;
+};
+
+namespace {
+
+struct Cert {
+	uint32 offset;
+	uint32 length;
+};
+
+struct EVEntry {
+	uint32 oidOffset;			// UTF-8, not terminated
+	uint32 oidLength;
+	uint32 firstHash;
+	uint32 hashCount;
+};
+
+} // end anonymous namespace
+
+
+//
+// Map the system bundle, if there is a usable one
+//
+AnchorBundle::AnchorBundle()
+	: mMap(NULL), mMapSize(0), mHeader(NULL)
+{
+	if (map(defaultPath))
+		secdebug("anchors", "anchor bundle mapped: %u roots", count());
+	else
+		secdebug("anchors", "no usable anchor bundle");
+}
+
+AnchorBundle::~AnchorBundle()
+{
+	if (mMap)
+		::munmap(mMap, mMapSize);
+}
+
+
+//
+// Does the file we were built from still look the way it did?
+// Installers replace the roots with files carrying their packaged mtimes,
+// so the inode is compared as well. A file modified in the same second the
+// bundle was written may not show a new mtime on a filesystem with
+// one-second timestamps, so that is taken as a change too.
+//
+static int64 modifiedTime(const struct stat &st)
+{
+	return int64(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+}
+
+static bool sourceUnchanged(const char *path, uint64 size, int64 modified, uint64 inode,
+	bool optional, time_t bundleWritten)
+{
+	struct stat st;
+	if (::stat(path, &st))
+		return optional && size == 0 && modified == 0;
+	if (st.st_mtimespec.tv_sec >= bundleWritten)
+		return false;
+	return uint64(st.st_size) == size && modifiedTime(st) == modified
+		&& uint64(st.st_ino) == inode;
+}
+
+//
+// Map a bundle and check it over completely, so the lookups needn't
+//
+bool AnchorBundle::map(const char *path)
+{
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (::fstat(fd, &st) || st.st_size < off_t(sizeof(Header)) || st.st_size > off_t(UINT32_MAX)) {
+		::close(fd);
+		return false;
+	}
+	void *mapping = ::mmap(NULL, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (mapping == MAP_FAILED)
+		return false;
+
+	const Header *h = reinterpret_cast<const Header *>(mapping);
+	const uint8 *base = reinterpret_cast<const uint8 *>(mapping);
+	uint64 size = uint64(st.st_size);
+	#define TABLE_FITS(offset, count, type) \
+		(uint64(offset) + uint64(count) * sizeof(type) <= size && (offset) % sizeof(uint32) == 0)
+	bool good = h->magic == kAnchorBundleMagic
+		&& h->version == kAnchorBundleVersion
+		&& h->size == size
+		&& TABLE_FITS(h->certsOffset, h->certCount, Cert)
+		&& TABLE_FITS(h->sha1Offset, h->certCount, IndexEntry)
+		&& TABLE_FITS(h->skidOffset, h->skidCount, IndexEntry)
+		&& TABLE_FITS(h->subjectOffset, h->subjectCount, IndexEntry)
+		&& TABLE_FITS(h->evOffset, h->evCount, EVEntry)
+		&& uint64(h->evHashesOffset) + uint64(h->evHashCount) * CC_SHA1_DIGEST_LENGTH <= size;
+	#undef TABLE_FITS
+
+	if (good) {
+		const Cert *certs = reinterpret_cast<const Cert *>(base + h->certsOffset);
+		for (uint32 n = 0; good && n < h->certCount; n++)
+			good = certs[n].length > 0 && uint64(certs[n].offset) + certs[n].length <= size;
+		const struct { uint32 offset, count; } indexes[] = {
+			{ h->sha1Offset, h->certCount },
+			{ h->skidOffset, h->skidCount },
+			{ h->subjectOffset, h->subjectCount }
+		};
+		for (unsigned ix = 0; good && ix < sizeof(indexes) / sizeof(indexes[0]); ix++) {
+			const IndexEntry *entries = reinterpret_cast<const IndexEntry *>(base + indexes[ix].offset);
+			for (uint32 n = 0; good && n < indexes[ix].count; n++)
+				good = entries[n].cert < h->certCount
+					&& (n == 0 || memcmp(entries[n-1].key, entries[n].key, CC_SHA1_DIGEST_LENGTH) <= 0);
+		}
+		const EVEntry *ev = reinterpret_cast<const EVEntry *>(base + h->evOffset);
+		for (uint32 n = 0; good && n < h->evCount; n++)
+			good = uint64(ev[n].oidOffset) + ev[n].oidLength <= size
+				&& uint64(ev[n].firstHash) + ev[n].hashCount <= h->evHashCount;
+	}
+
+	if (good)
+		good = sourceUnchanged(SYSTEM_ROOTS_PATH, h->rootsSize, h->rootsModified, h->rootsInode,
+				false, st.st_mtimespec.tv_sec)
+			&& sourceUnchanged(EV_ROOTS_PATH, h->evSize, h->evModified, h->evInode,
+				true, st.st_mtimespec.tv_sec);
+
+	if (!good) {
+		secdebug("anchors", "anchor bundle %s is damaged or stale; ignored", path);
+		::munmap(mapping, size_t(st.st_size));
+		return false;
+	}
+	mMap = mapping;
+	mMapSize = size_t(st.st_size);
+	mHeader = h;
+	return true;
+}
+
+
+uint32 AnchorBundle::count() const
+{
+	return mHeader ? mHeader->certCount : 0;
+}
+
+CssmData AnchorBundle::certificate(uint32 index) const
+{
+	assert(mHeader && index < mHeader->certCount);
+	const uint8 *base = reinterpret_cast<const uint8 *>(mMap);
+	const Cert &cert = reinterpret_cast<const Cert *>(base + mHeader->certsOffset)[index];
+	return CssmData(const_cast<uint8 *>(base + cert.offset), cert.length);
+}
+
+
+//
+// Lookups: binary search of a sorted index
+//
+bool AnchorBundle::find(uint32 indexOffset, uint32 indexCount, const uint8 *key,
+	CssmData &cert) const
+{
+	if (!mHeader)
+		return false;
+	const IndexEntry *entries = reinterpret_cast<const IndexEntry *>(
+		reinterpret_cast<const uint8 *>(mMap) + indexOffset);
+	uint32 low = 0, high = indexCount;
+	while (low < high) {
+		uint32 mid = low + (high - low) / 2;
+		int cmp = memcmp(entries[mid].key, key, CC_SHA1_DIGEST_LENGTH);
+		if (cmp == 0) {
+			cert = certificate(entries[mid].cert);
+			return true;
+		}
+		if (cmp < 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return false;
+}
+
+bool AnchorBundle::findBySHA1(const CssmData &digest, CssmData &cert) const
+{
+	if (!mHeader || digest.length() != CC_SHA1_DIGEST_LENGTH)
+		return false;
+	return find(mHeader->sha1Offset, mHeader->certCount, digest.data<uint8>(), cert);
+}
+
+bool AnchorBundle::findBySubjectKeyID(const CssmData &subjectKeyID, CssmData &cert) const
+{
+	if (!mHeader || !subjectKeyID.length())
+		return false;
+	uint8 key[CC_SHA1_DIGEST_LENGTH];
+	CC_SHA1(subjectKeyID.data(), (CC_LONG)subjectKeyID.length(), key);
+	return find(mHeader->skidOffset, mHeader->skidCount, key, cert);
+}
+
+static void subjectAndKeyDigest(const CssmData &normalizedSubject, const CssmData &keyDigest,
+	uint8 key[CC_SHA1_DIGEST_LENGTH])
+{
+	CC_SHA1_CTX ctx;
+	CC_SHA1_Init(&ctx);
+	CC_SHA1_Update(&ctx, normalizedSubject.data(), (CC_LONG)normalizedSubject.length());
+	CC_SHA1_Update(&ctx, keyDigest.data(), (CC_LONG)keyDigest.length());
+	CC_SHA1_Final(key, &ctx);
+}
+
+bool AnchorBundle::findBySubjectAndKey(const CssmData &normalizedSubject,
+	const CssmData &keyDigest, CssmData &cert) const
+{
+	if (!mHeader)
+		return false;
+	uint8 key[CC_SHA1_DIGEST_LENGTH];
+	subjectAndKeyDigest(normalizedSubject, keyDigest, key);
+	return find(mHeader->subjectOffset, mHeader->subjectCount, key, cert);
+}
+
+
+CFDictionaryRef AnchorBundle::copyEVPolicies() const
+{
+	if (!mHeader)
+		return NULL;
+	const uint8 *base = reinterpret_cast<const uint8 *>(mMap);
+	const EVEntry *ev = reinterpret_cast<const EVEntry *>(base + mHeader->evOffset);
+	const uint8 *hashes = base + mHeader->evHashesOffset;
+	CFMutableDictionaryRef dict = CFDictionaryCreateMutable(NULL, mHeader->evCount,
+		&kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+	if (!dict)
+		return NULL;
+	for (uint32 n = 0; n < mHeader->evCount; n++) {
+		CFRef<CFStringRef> oid(CFStringCreateWithBytes(NULL, base + ev[n].oidOffset,
+			ev[n].oidLength, kCFStringEncodingUTF8, false));
+		CFRef<CFMutableArrayRef> roots(CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks));
+		if (!oid || !roots)
+			continue;
+		for (uint32 h = 0; h < ev[n].hashCount; h++) {
+			CFRef<CFDataRef> hash(CFDataCreate(NULL,
+				hashes + (ev[n].firstHash + h) * CC_SHA1_DIGEST_LENGTH, CC_SHA1_DIGEST_LENGTH));
+			if (hash)
+				CFArrayAppendValue(roots, hash);
+		}
+		CFDictionarySetValue(dict, oid, roots);
+	}
+	return dict;
+}
+
+
+//
+// Building a bundle
+//
+static bool indexEntryLess(const AnchorBundle::IndexEntry &a, const AnchorBundle::IndexEntry &b)
+{
+	return memcmp(a.key, b.key, CC_SHA1_DIGEST_LENGTH) < 0;
+}
+
+static CFDictionaryRef copyEVRootsPlist()
+{
+	int fd = ::open(EV_ROOTS_PATH, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	std::vector<UInt8> contents;
+	UInt8 buffer[4096];
+	ssize_t got;
+	while ((got = ::read(fd, buffer, sizeof(buffer))) > 0)
+		contents.insert(contents.end(), buffer, buffer + got);
+	::close(fd);
+	if (got < 0 || contents.empty())
+		return NULL;
+	CFRef<CFDataRef> data(CFDataCreateWithBytesNoCopy(NULL, &contents[0], contents.size(), kCFAllocatorNull));
+	CFPropertyListRef plist = CFPropertyListCreateFromXMLData(NULL, data, kCFPropertyListImmutable, NULL);
+	if (plist && CFGetTypeID(plist) != CFDictionaryGetTypeID()) {
+		CFRelease(plist);
+		plist = NULL;
+	}
+	return (CFDictionaryRef)plist;
+}
+
+void AnchorBundle::write(const char *path)
+{
+	Header header;
+	memset(&header, 0, sizeof(header));
+	header.magic = kAnchorBundleMagic;
+	header.version = kAnchorBundleVersion;
+
+	struct stat st;
+	if (::stat(SYSTEM_ROOTS_PATH, &st))
+		UnixError::throwMe();
+	header.rootsSize = st.st_size;
+	header.rootsModified = modifiedTime(st);
+	header.rootsInode = st.st_ino;
+	time_t newestSource = st.st_mtimespec.tv_sec;
+	if (::stat(EV_ROOTS_PATH, &st) == 0) {
+		header.evSize = st.st_size;
+		header.evModified = modifiedTime(st);
+		header.evInode = st.st_ino;
+		newestSource = std::max(newestSource, time_t(st.st_mtimespec.tv_sec));
+	}
+
+	// gather the roots and their keys
+	std::vector<Cert> certs;
+	std::vector<IndexEntry> sha1Index, skidIndex, subjectIndex;
+	std::vector<uint8> arena;
+
+	StorageManager::KeychainList keychains;
+	keychains.push_back(globals().storageManager.make(SYSTEM_ROOTS_PATH, false));
+	KCCursor cursor(keychains, kSecCertificateItemClass, NULL);
+	Item item;
+	while (cursor->next(item)) {
+		Certificate *cert = dynamic_cast<Certificate *>(item.get());
+		if (cert == NULL)
+			continue;
+		const CssmData &der = cert->data();
+		IndexEntry entry;
+		entry.cert = uint32(certs.size());
+
+		Cert location = { uint32(arena.size()), uint32(der.length()) };
+		certs.push_back(location);
+		arena.insert(arena.end(), der.data<uint8>(), der.data<uint8>() + der.length());
+
+		CC_SHA1(der.data(), (CC_LONG)der.length(), entry.key);
+		sha1Index.push_back(entry);
+
+		const CssmData &skid = cert->subjectKeyIdentifier();
+		if (skid.length()) {
+			CC_SHA1(skid.data(), (CC_LONG)skid.length(), entry.key);
+			skidIndex.push_back(entry);
+		}
+
+		// self-issued roots, by normalized subject and key, as
+		// _rootCertificateWithSubjectOfCertificate matches them
+		CSSM_DATA_PTR subject = cert->copyFirstFieldValue(CSSMOID_X509V1SubjectName);
+		CSSM_DATA_PTR issuer = cert->copyFirstFieldValue(CSSMOID_X509V1IssuerName);
+		if (subject && issuer && CssmData::overlay(*subject) == CssmData::overlay(*issuer)) {
+			try {
+				SecPointer<KeyItem> publicKey = cert->publicKey();
+				const CSSM_KEY *cssmKey = publicKey->key();
+				if (cssmKey && cssmKey->KeyData.Data && cssmKey->KeyData.Length) {
+					uint8 keyDigest[CC_SHA1_DIGEST_LENGTH];
+					CC_SHA1(cssmKey->KeyData.Data, (CC_LONG)cssmKey->KeyData.Length, keyDigest);
+					subjectAndKeyDigest(CssmData::overlay(*subject),
+						CssmData(keyDigest, sizeof(keyDigest)), entry.key);
+					subjectIndex.push_back(entry);
+				}
+			} catch (...) {
+				secdebug("anchors", "root %u: no usable public key; not indexed by subject", entry.cert);
+			}
+		}
+		if (subject)
+			cert->releaseFieldValue(CSSMOID_X509V1SubjectName, subject);
+		if (issuer)
+			cert->releaseFieldValue(CSSMOID_X509V1IssuerName, issuer);
+	}
+	std::sort(sha1Index.begin(), sha1Index.end(), indexEntryLess);
+	std::sort(skidIndex.begin(), skidIndex.end(), indexEntryLess);
+	std::sort(subjectIndex.begin(), subjectIndex.end(), indexEntryLess);
+
+	// EV OIDs and their roots' hashes
+	std::vector<EVEntry> evEntries;
+	std::vector<uint8> evHashes;
+	if (CFRef<CFDictionaryRef> evRoots = copyEVRootsPlist()) {
+		CFIndex count = CFDictionaryGetCount(evRoots);
+		std::vector<const void *> keys(count), values(count);
+		if (count)
+			CFDictionaryGetKeysAndValues(evRoots, &keys[0], &values[0]);
+		for (CFIndex n = 0; n < count; n++) {
+			if (CFGetTypeID(keys[n]) != CFStringGetTypeID() || CFGetTypeID(values[n]) != CFArrayGetTypeID())
+				continue;
+			char oid[256];
+			if (!CFStringGetCString(CFStringRef(keys[n]), oid, sizeof(oid), kCFStringEncodingUTF8))
+				continue;
+			EVEntry ev = { uint32(arena.size()), uint32(strlen(oid)),
+				uint32(evHashes.size() / CC_SHA1_DIGEST_LENGTH), 0 };
+			arena.insert(arena.end(), oid, oid + ev.oidLength);
+			CFArrayRef hashes = CFArrayRef(values[n]);
+			for (CFIndex h = 0; h < CFArrayGetCount(hashes); h++) {
+				CFTypeRef hash = CFArrayGetValueAtIndex(hashes, h);
+				if (CFGetTypeID(hash) != CFDataGetTypeID()
+						|| CFDataGetLength(CFDataRef(hash)) != CC_SHA1_DIGEST_LENGTH)
+					continue;
+				const UInt8 *bytes = CFDataGetBytePtr(CFDataRef(hash));
+				evHashes.insert(evHashes.end(), bytes, bytes + CC_SHA1_DIGEST_LENGTH);
+				ev.hashCount++;
+			}
+			evEntries.push_back(ev);
+		}
+	}
+
+	// lay it out: header, tables, arena
+	uint32 offset = sizeof(Header);
+	header.certCount = uint32(certs.size());
+	header.certsOffset = offset;		offset += certs.size() * sizeof(Cert);
+	header.sha1Offset = offset;			offset += sha1Index.size() * sizeof(IndexEntry);
+	header.skidOffset = offset;			offset += skidIndex.size() * sizeof(IndexEntry);
+	header.skidCount = uint32(skidIndex.size());
+	header.subjectOffset = offset;		offset += subjectIndex.size() * sizeof(IndexEntry);
+	header.subjectCount = uint32(subjectIndex.size());
+	header.evOffset = offset;			offset += evEntries.size() * sizeof(EVEntry);
+	header.evCount = uint32(evEntries.size());
+	header.evHashesOffset = offset;		offset += evHashes.size();
+	header.evHashCount = uint32(evHashes.size() / CC_SHA1_DIGEST_LENGTH);
+	uint32 arenaOffset = offset;
+	header.size = offset + uint32(arena.size());
+	for (std::vector<Cert>::iterator it = certs.begin(); it != certs.end(); it++)
+		it->offset += arenaOffset;
+	for (std::vector<EVEntry>::iterator it = evEntries.begin(); it != evEntries.end(); it++)
+		it->oidOffset += arenaOffset;
+
+	std::vector<uint8> image;
+	image.reserve(header.size);
+	#define APPEND(ptr, len) \
+		image.insert(image.end(), reinterpret_cast<const uint8 *>(ptr), reinterpret_cast<const uint8 *>(ptr) + (len))
+	APPEND(&header, sizeof(header));
+	if (!certs.empty())			APPEND(&certs[0], certs.size() * sizeof(Cert));
+	if (!sha1Index.empty())		APPEND(&sha1Index[0], sha1Index.size() * sizeof(IndexEntry));
+	if (!skidIndex.empty())		APPEND(&skidIndex[0], skidIndex.size() * sizeof(IndexEntry));
+	if (!subjectIndex.empty())	APPEND(&subjectIndex[0], subjectIndex.size() * sizeof(IndexEntry));
+	if (!evEntries.empty())		APPEND(&evEntries[0], evEntries.size() * sizeof(EVEntry));
+	if (!evHashes.empty())		APPEND(&evHashes[0], evHashes.size());
+	if (!arena.empty())			APPEND(&arena[0], arena.size());
+	#undef APPEND
+	assert(image.size() == header.size);
+
+	// A source modified in the second the bundle is written counts as
+	// changed (see sourceUnchanged), and installers write the sources and
+	// then the bundle straight away, so let that second pass first.
+	struct timeval now;
+	while (::gettimeofday(&now, NULL) == 0 && now.tv_sec == newestSource)
+		::usleep(useconds_t(std::min(999999L, 1000000L - long(now.tv_usec))));
+
+	// write it beside the target and rename it into place, so a reader
+	// never maps a partial bundle
+	std::string tmpPath = std::string(path) + ".new";
+	int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		UnixError::throwMe();
+	size_t done = 0;
+	while (done < image.size()) {
+		ssize_t wrote = ::write(fd, &image[done], image.size() - done);
+		if (wrote < 0) {
+			int error = errno;
+			::close(fd);
+			::unlink(tmpPath.c_str());
+			UnixError::throwMe(error);
+		}
+		done += wrote;
+	}
+	int error = ::fsync(fd) ? errno : 0;
+	if (::close(fd) && !error)
+		error = errno;
+	if (!error && ::rename(tmpPath.c_str(), path))
+		error = errno;
+	if (error) {
+		::unlink(tmpPath.c_str());
+		UnixError::throwMe(error);
+	}
+	secdebug("anchors", "wrote anchor bundle %s: %u roots, %u EV policies",
+		path, header.certCount, header.evCount);
+}
+
+
+} // end namespace KeychainCore
+} // end namespace Security
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+//
+// AnchorBundle.h - precompiled, memory-mapped image of the system roots
+//
+#ifndef _SECURITY_ANCHORBUNDLE_H_
+#define _SECURITY_ANCHORBUNDLE_H_
+
+#include <security_cdsa_utilities/cssmdata.h>
+#include <security_utilities/globalizer.h>
+#include <CoreFoundation/CoreFoundation.h>
+
+
+namespace Security {
+namespace KeychainCore {
+
+
+//
+// An AnchorBundle is a single read-only file holding the DER of every
+// certificate in SystemRootCertificates.keychain back to back, sorted
+// indexes over them by SHA-1, subject key identifier and (self-issued)
+// subject plus public key, and the EV policy map from EVRoots.plist.
+// It is written with SecTrustWriteAnchorBundle() when the system roots are
+// installed, and mapped on first use, so that anchor lookups don't have to
+// open the system roots keychain through the DL.
+//
+// The bundle records the size, inode and nanosecond modification date of
+// the files it was built from; if any has changed, if a source was modified
+// no earlier than the second the bundle was written, or the bundle is missing
+// or damaged, valid() is false and callers fall back to the keychain and plist.
+//
+class AnchorBundle {
+	NOCOPY(AnchorBundle)
+public:
+	AnchorBundle();			// maps the system bundle
+	~AnchorBundle();
+
+	static const char * const defaultPath;
+
+	bool valid() const		{ return mHeader != NULL; }
+	uint32 count() const;
+	CssmData certificate(uint32 index) const;	// points into the mapping
+
+	// the key digest is the SHA-1 of the public key's CSSM KeyData
+	bool findBySHA1(const CssmData &digest, CssmData &cert) const;
+	bool findBySubjectKeyID(const CssmData &subjectKeyID, CssmData &cert) const;
+	bool findBySubjectAndKey(const CssmData &normalizedSubject,
+		const CssmData &keyDigest, CssmData &cert) const;
+
+	// EV OID string -> CFArray of root SHA-1 hashes, as in EVRoots.plist;
+	// the arrays are mutable. Caller must release.
+	CFDictionaryRef copyEVPolicies() const;
+
+	// build a bundle from the installed system roots and EV plist
+	static void write(const char *path);
+
+	// file layout; see AnchorBundle.cpp
+	struct Header;
+	struct IndexEntry;
+
+private:
+	bool map(const char *path);
+	bool find(uint32 indexOffset, uint32 indexCount, const uint8 *key,
+		CssmData &cert) const;
+
+	void *mMap;
+	size_t mMapSize;
+	const Header *mHeader;
+};
+
+extern ModuleNexus<AnchorBundle> gAnchorBundle;
+
+
+} // end namespace KeychainCore
+} // end namespace Security
+
+#endif // !_SECURITY_ANCHORBUNDLE_H_
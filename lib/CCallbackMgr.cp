@@ -37,6 +37,8 @@
 
 #include <CoreServices/../Frameworks/CarbonCore.framework/Headers/MacTypes.h>
 #include "Globals.h"
+#include "TrustKeychains.h"
+#include "TrustStore.h"
 #include <security_keychain/SecCFTypes.h>
 #include <securityd_client/SharedMemoryCommon.h>
 #include <securityd_client/ssnotify.h>
@@ -205,6 +207,8 @@ void CCallbackMgr::consume (SecurityServer::NotificationDomain domain, SecurityS
 
 	Keychain thisKeychain;
     Item thisItem;
+	bool userTrustRecord = true;	// unless we know otherwise
+	bool certRecord = true;			// ditto
 	list<CallbackInfo> eventCallbacks;
 	{
 		// Lock the global API lock before doing stuff with StorageManager.
@@ -220,14 +224,32 @@ void CCallbackMgr::consume (SecurityServer::NotificationDomain domain, SecurityS
 		if (item && thisKeychain)
 		{
 			PrimaryKey pk(item->Value());
+			userTrustRecord = (pk->recordType() == CSSM_DL_DB_RECORD_USER_TRUST);
+			certRecord = (pk->recordType() == CSSM_DL_DB_RECORD_X509_CERTIFICATE);
 			thisItem = thisKeychain->item(pk);
 		}
 
 		// Deal with events that we care about ourselves first.
+		if ((thisEvent == kSecUpdateEvent || thisEvent == kSecDeleteEvent) && thisItem.get())
+			thisItem->forgetCachedContent();
+
 		if (thisEvent == kSecDeleteEvent && thisKeychain.get() && thisItem.get())
 			thisKeychain->didDeleteItem(thisItem.get());
 		else if (thisEvent == kSecKeychainListChangedEvent)
+		{
 			globals().storageManager.forceUserSearchListReread();
+			SecTrustKeychainsSearchListChanged();
+			SecTrustKeychainsCertificatesChanged();
+			TrustStore::userTrustChanged();
+		}
+
+		if ((thisEvent == kSecAddEvent || thisEvent == kSecUpdateEvent || thisEvent == kSecDeleteEvent)
+				&& userTrustRecord)
+			TrustStore::userTrustChanged();
+
+		if ((thisEvent == kSecAddEvent || thisEvent == kSecUpdateEvent || thisEvent == kSecDeleteEvent)
+				&& certRecord)
+			SecTrustKeychainsCertificatesChanged();
 
 		eventCallbacks = CCallbackMgr::Instance().mEventCallbacks;
 		// We can safely release the global API lock now since thisKeychain and thisItem
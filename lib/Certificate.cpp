@@ -33,13 +33,179 @@
 #include <security_cdsa_client/cspclient.h>
 #include <security_keychain/KeyItem.h>
 #include <security_keychain/KCCursor.h>
+#include <security_utilities/globalizer.h>
+#include "CertificateValues.h"
 #include <vector>
+#include <list>
+#include <map>
+#include <string>
 #include <CoreServices/../Frameworks/CarbonCore.framework/Headers/MacErrors.h>
 //#include "CLFieldsCommon.h"
 
 
 using namespace KeychainCore;
 
+//
+// CertificateValueCache
+//
+// Values derived from a certificate -- its inferred label, subject name
+// components, email addresses and normalized names -- cost a CL field query
+// or a parse to produce, and UI lists, logging and SecItem filtering ask for
+// them over and over.  They are kept in a process-wide cache with a memory
+// budget; when it is exceeded the values of the least recently used
+// certificates are dropped, to be derived again when next asked for.
+//
+// Lock order is certificate mMutex, then the cache's.
+//
+#define CERTIFICATE_VALUE_CACHE_DEFAULT_BUDGET		(256 * 1024)
+
+class CertificateValueCache
+{
+public:
+	CertificateValueCache() : mBudget(CERTIFICATE_VALUE_CACHE_DEFAULT_BUDGET), mBytes(0) {}
+
+	// returns a retained value, or NULL
+	CFTypeRef copyValue(const Certificate &cert, const std::string &key);
+	void addValue(const Certificate &cert, const std::string &key, CFTypeRef value);
+	void forget(const Certificate &cert);
+
+	void setBudget(UInt64 budget);
+
+private:
+	typedef std::map<std::string, CFRef<CFTypeRef> > ValueMap;
+	struct Entry
+	{
+		Entry(const Certificate *inCert) : cert(inCert), bytes(0) {}
+		const Certificate *cert;
+		size_t bytes;
+		ValueMap values;
+	};
+	typedef std::list<Entry> EntryList;				// most recently used first
+	typedef std::map<const Certificate *, EntryList::iterator> EntryMap;
+
+	static size_t sizeOf(CFTypeRef value);
+	void evict();
+
+	EntryList mEntries;
+	EntryMap mEntryMap;
+	UInt64 mBudget;
+	UInt64 mBytes;
+	Mutex mMutex;
+};
+
+static ModuleNexus<CertificateValueCache> gCertificateValueCache;
+
+CFTypeRef
+CertificateValueCache::copyValue(const Certificate &cert, const std::string &key)
+{
+	StLock<Mutex>_(mMutex);
+	EntryMap::iterator eit = mEntryMap.find(&cert);
+	if (eit == mEntryMap.end())
+		return NULL;
+	ValueMap::iterator vit = eit->second->values.find(key);
+	if (vit == eit->second->values.end())
+		return NULL;
+	mEntries.splice(mEntries.begin(), mEntries, eit->second);
+	return CFRetain(vit->second);
+}
+
+void
+CertificateValueCache::addValue(const Certificate &cert, const std::string &key, CFTypeRef value)
+{
+	StLock<Mutex>_(mMutex);
+	if (mBudget == 0 || value == NULL)
+		return;
+
+	EntryMap::iterator eit = mEntryMap.find(&cert);
+	if (eit == mEntryMap.end())
+	{
+		mEntries.push_front(Entry(&cert));
+		eit = mEntryMap.insert(EntryMap::value_type(&cert, mEntries.begin())).first;
+	}
+	else
+		mEntries.splice(mEntries.begin(), mEntries, eit->second);
+
+	Entry &entry = *eit->second;
+	if (entry.values.find(key) != entry.values.end())
+		return;
+	entry.values[key] = value;
+
+	size_t bytes = key.size() + sizeOf(value);
+	entry.bytes += bytes;
+	mBytes += bytes;
+	evict();
+}
+
+void
+CertificateValueCache::forget(const Certificate &cert)
+{
+	StLock<Mutex>_(mMutex);
+	EntryMap::iterator eit = mEntryMap.find(&cert);
+	if (eit != mEntryMap.end())
+	{
+		mBytes -= eit->second->bytes;
+		mEntries.erase(eit->second);
+		mEntryMap.erase(eit);
+	}
+}
+
+// a rough figure, good enough for a budget
+size_t
+CertificateValueCache::sizeOf(CFTypeRef value)
+{
+	size_t bytes = 64;
+	CFTypeID type = CFGetTypeID(value);
+	if (type == CFStringGetTypeID())
+		bytes += CFStringGetLength((CFStringRef)value) * sizeof(UniChar);
+	else if (type == CFDataGetTypeID())
+		bytes += CFDataGetLength((CFDataRef)value);
+	else if (type == CFArrayGetTypeID())
+	{
+		CFIndex count = CFArrayGetCount((CFArrayRef)value);
+		for (CFIndex ix = 0; ix < count; ix++)
+			bytes += sizeof(void *) + sizeOf(CFArrayGetValueAtIndex((CFArrayRef)value, ix));
+	}
+	return bytes;
+}
+
+// drop least recently used certificates' values until we're within budget
+void
+CertificateValueCache::evict()
+{
+	while (mBytes > mBudget && !mEntries.empty())
+	{
+		Entry &victim = mEntries.back();
+		mBytes -= victim.bytes;
+		mEntryMap.erase(victim.cert);
+		mEntries.pop_back();
+	}
+}
+
+void
+CertificateValueCache::setBudget(UInt64 budget)
+{
+	StLock<Mutex>_(mMutex);
+	mBudget = budget;
+	evict();
+}
+
+// key for a value derived from the given fields
+static std::string
+valueKey(const char *name, const CSSM_OID *oid1, const CSSM_OID *oid2 = NULL)
+{
+	std::string key(name);
+	const CSSM_OID *oids[] = { oid1, oid2 };
+	for (unsigned n = 0; n < sizeof(oids) / sizeof(oids[0]); n++)
+	{
+		uint32 length = (oids[n] && oids[n]->Data) ? uint32(oids[n]->Length) : 0;
+		key.append(reinterpret_cast<const char *>(&length), sizeof(length));
+		if (length)
+			key.append(reinterpret_cast<const char *>(oids[n]->Data), length);
+	}
+	return key;
+}
+
+
 CL
 Certificate::clForType(CSSM_CERT_TYPE type)
 {
@@ -126,6 +292,8 @@ Certificate::Certificate(Certificate &certificate) :
 
 Certificate::~Certificate() throw()
 {
+	gCertificateValueCache().forget(*this);
+
 	if (mV1SubjectPublicKeyCStructValue)
 		releaseFieldValue(CSSMOID_X509V1SubjectPublicKeyCStruct, mV1SubjectPublicKeyCStructValue);
 
@@ -505,6 +673,11 @@ void
 Certificate::inferLabel(bool addLabel, CFStringRef *rtnString)
 {
 	StLock<Mutex>_(mMutex);
+	// If all we want is the label, we may have inferred it before.
+	if (!addLabel && rtnString &&
+		(*rtnString = (CFStringRef)gCertificateValueCache().copyValue(*this, "label")) != NULL)
+		return;
+
 	// Set PrintName and optionally the Alias attribute for this certificate, based on the 
 	// X509 SubjectAltName and SubjectName.
 	const CSSM_DATA *printName = NULL;
@@ -633,6 +806,7 @@ Certificate::inferLabel(bool addLabel, CFStringRef *rtnString)
 			*rtnString = CFStringCreateWithBytes(NULL, printName->Data,
 				(CFIndex)printName->Length, printEncoding, true);
 		}
+		gCertificateValueCache().addValue(*this, "label", *rtnString);
 	}
 
 	// Clean up
@@ -757,7 +931,11 @@ CFStringRef
 Certificate::distinguishedName(const CSSM_OID *sourceOid, const CSSM_OID *componentOid)
 {
 	StLock<Mutex>_(mMutex);
-	CFStringRef rtnString = NULL;
+	std::string key = valueKey("dn", sourceOid, componentOid);
+	CFStringRef rtnString = (CFStringRef)gCertificateValueCache().copyValue(*this, key);
+	if (rtnString)
+		return rtnString;
+
 	CSSM_DATA_PTR fieldValue = copyFirstFieldValue(*sourceOid);
 	CSSM_X509_NAME_PTR x509Name = (CSSM_X509_NAME_PTR)fieldValue->Data;
 	const CSSM_DATA	*printValue = NULL;
@@ -772,6 +950,7 @@ Certificate::distinguishedName(const CSSM_OID *sourceOid, const CSSM_OID *compon
 
 	releaseFieldValue(*sourceOid, fieldValue);
 
+	gCertificateValueCache().addValue(*this, key, rtnString);
 	return rtnString;
 }
 
@@ -784,31 +963,12 @@ CFStringRef
 Certificate::copyFirstEmailAddress()
 {
 	StLock<Mutex>_(mMutex);
-	CFStringRef rtnString;
-
-	const CSSM_OID &sanOid = CSSMOID_SubjectAltName;
-	CSSM_DATA_PTR *sanValues = copyFieldValues(sanOid);
-	const CSSM_OID &snOid = CSSMOID_X509V1SubjectNameCStruct;
-	CSSM_DATA_PTR snValue = copyFirstFieldValue(snOid);
-	std::vector<CssmData> emailAddresses;
-
-	getEmailAddresses(sanValues, snValue, emailAddresses);
-	if (emailAddresses.empty())
-		rtnString = NULL;
-	else
-	{
-		/* Encoding is kCFStringEncodingUTF8 since the string is either
-		   PRINTABLE_STRING, IA5_STRING, T61_STRING or PKIX_UTF8_STRING. */
-		rtnString = CFStringCreateWithBytes(NULL, emailAddresses[0].Data,
-			(CFIndex)emailAddresses[0].Length, kCFStringEncodingUTF8, true);
-	}
-
-	// Clean up
-	if (snValue)
-		releaseFieldValue(snOid, snValue);
-	if (sanValues)
-		releaseFieldValues(sanOid, sanValues);
+	CFRef<CFArrayRef> emailAddresses(copyEmailAddresses());
+	if (CFArrayGetCount(emailAddresses) == 0)
+		return NULL;
 
+	CFStringRef rtnString = (CFStringRef)CFArrayGetValueAtIndex(emailAddresses, 0);
+	CFRetain(rtnString);
 	return rtnString;
 }
 
@@ -820,7 +980,11 @@ CFArrayRef
 Certificate::copyEmailAddresses()
 {
 	StLock<Mutex>_(mMutex);
-	CFMutableArrayRef array = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
+	CFArrayRef cached = (CFArrayRef)gCertificateValueCache().copyValue(*this, "email");
+	if (cached)
+		return cached;
+
+	CFRef<CFMutableArrayRef> array(CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks));
 	std::vector<CssmData> emailAddresses;
 
 	// Find the SubjectAltName fields, if any, and extract all the GNT_RFC822Name entries from all of them
@@ -847,7 +1011,41 @@ Certificate::copyEmailAddresses()
 	if (sanValues)
 		releaseFieldValues(sanOid, sanValues);
 
-	return array;
+	CFArrayRef result = CFArrayCreateCopy(NULL, array);
+	gCertificateValueCache().addValue(*this, "email", result);
+	return result;
+}
+
+/*
+ * Return the normalized issuer or subject name content, as SecItemCopyMatching
+ * compares them.
+ */
+CFDataRef
+Certificate::copyNormalizedIssuerContent(CFErrorRef *error)
+{
+	StLock<Mutex>_(mMutex);
+	CFDataRef result = (CFDataRef)gCertificateValueCache().copyValue(*this, "nissuer");
+	if (result)
+		return result;
+
+	CertificateValues cv(handle(false));
+	result = cv.getNormalizedIssuerContent(error);
+	gCertificateValueCache().addValue(*this, "nissuer", result);
+	return result;
+}
+
+CFDataRef
+Certificate::copyNormalizedSubjectContent(CFErrorRef *error)
+{
+	StLock<Mutex>_(mMutex);
+	CFDataRef result = (CFDataRef)gCertificateValueCache().copyValue(*this, "nsubject");
+	if (result)
+		return result;
+
+	CertificateValues cv(handle(false));
+	result = cv.getNormalizedSubjectContent(error);
+	gCertificateValueCache().addValue(*this, "nsubject", result);
+	return result;
 }
 
 const CSSM_X509_NAME_PTR
@@ -926,6 +1124,14 @@ Certificate::copyTo(const Keychain &keychain, Access *newAccess)
 void
 Certificate::didModify()
 {
+	ItemImpl::didModify();
+	gCertificateValueCache().forget(*this);
+}
+
+void
+Certificate::setValueCacheBudget(UInt64 budget)
+{
+	gCertificateValueCache().setBudget(budget);
 }
 
 PrimaryKey
@@ -958,7 +1164,7 @@ Certificate::add(Keychain &keychain)
 			Schema::X509CertificateSchemaAttributeList,
 			Schema::X509CertificateSchemaIndexCount,
 			Schema::X509CertificateSchemaIndexList);
-		keychain->keychainSchema()->didCreateRelation(
+		keychain->didCreateRelation(
 			CSSM_DL_DB_RECORD_X509_CERTIFICATE,
 			"CSSM_DL_DB_RECORD_X509_CERTIFICATE",
 			Schema::X509CertificateSchemaAttributeCount,
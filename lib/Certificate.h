@@ -78,6 +78,8 @@ public:
 	CFStringRef distinguishedName(const CSSM_OID *sourceOid, const CSSM_OID *componentOid);
 	CFStringRef copyFirstEmailAddress();
 	CFArrayRef copyEmailAddresses();
+	CFDataRef copyNormalizedIssuerContent(CFErrorRef *error);
+	CFDataRef copyNormalizedSubjectContent(CFErrorRef *error);
     const CSSM_X509_NAME_PTR subjectName();
     const CSSM_X509_NAME_PTR issuerName();
 	const CSSM_X509_ALGORITHM_IDENTIFIER_PTR algorithmID();
@@ -100,6 +102,9 @@ public:
 	static void normalizeEmailAddress(CSSM_DATA &emailAddress);
 	static void getEmailAddresses(CSSM_DATA_PTR *sanValues, CSSM_DATA_PTR snValue, std::vector<CssmData> &emailAddresses);
 
+	// memory for values derived from certificates (labels, names, email addresses); 0 disables
+	static void setValueCacheBudget(UInt64 budget);
+
 	bool operator < (Certificate &other);
 	bool operator == (Certificate &other);
 
@@ -375,7 +375,9 @@ CFDataRef CertificateValues::getNormalizedIssuerContent(CFErrorRef *error)
 	SecCertificateRefP certificateP = getSecCertificateRefP(error);
     if (certificateP)
     {
-        result = SecCertificateGetNormalizedIssuer(certificateP);
+        CFDataRef content = SecCertificateGetNormalizedIssuer(certificateP);
+        if (content)
+            result = CFDataCreateCopy(NULL, content);	// certificateP owns content
         CFRelease(certificateP);
     }
     return result;
@@ -388,7 +390,9 @@ CFDataRef CertificateValues::getNormalizedSubjectContent(CFErrorRef *error)
 	SecCertificateRefP certificateP = getSecCertificateRefP(error);
     if (certificateP)
     {
-        result = SecCertificateGetNormalizedSubject(certificateP);
+        CFDataRef content = SecCertificateGetNormalizedSubject(certificateP);
+        if (content)
+            result = CFDataCreateCopy(NULL, content);	// certificateP owns content
         CFRelease(certificateP);
     }
     return result;
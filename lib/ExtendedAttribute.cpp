@@ -156,7 +156,7 @@ ExtendedAttribute::add(Keychain &keychain)
 			Schema::ExtendedAttributeSchemaAttributeList,
 			Schema::ExtendedAttributeSchemaIndexCount,
 			Schema::ExtendedAttributeSchemaIndexList);
-		keychain->keychainSchema()->didCreateRelation(
+		keychain->didCreateRelation(
 			CSSM_DL_DB_RECORD_EXTENDED_ATTRIBUTE,
 			"CSSM_DL_DB_RECORD_EXTENDED_ATTRIBUTE",
 			Schema::ExtendedAttributeSchemaAttributeCount,
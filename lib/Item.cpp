@@ -33,6 +33,7 @@
 #include "ExtendedAttribute.h"
 
 #include "Globals.h"
+#include "CCallbackMgr.h"
 #include <security_cdsa_utilities/Schema.h>
 #include "KCEventNotifier.h"
 #include "cssmdatetime.h"
@@ -41,6 +42,7 @@
 #include <security_utilities/trackingallocator.h>
 #include <Security/SecKeychainItemPriv.h>
 #include <Security/cssmapple.h>
+#include <list>
 
 #define SENDACCESSNOTIFICATIONS 1
 
@@ -54,6 +56,295 @@
 using namespace KeychainCore;
 using namespace CSSMDateTimeUtils;
 
+//
+// ItemAttributes
+//
+// Copies of attribute values read from the database, keyed by attribute ID.
+//
+namespace Security {
+namespace KeychainCore {
+
+class ItemAttributes
+{
+public:
+	ItemAttributes() : mBytes(0) {}
+
+	void add(const CssmDbAttributeData &data);
+	void add(const DbAttributes &attributes);
+	// hand attributeId to ItemImpl::getAttributeFrom, if we have it
+	bool get(ItemImpl &item, UInt32 attributeId, SecKeychainAttribute &attr, UInt32 *actualLength) const;
+	// malloc copies of the values of attributeIds, if we have them all
+	bool copy(UInt32 count, const UInt32 *attributeIds, SecKeychainAttribute *attrs) const;
+	size_t bytes() const { return mBytes; }
+
+private:
+	struct Attribute
+	{
+		CSSM_DB_ATTRIBUTE_INFO info;
+		bool hasValue;
+		vector<uint8> value;
+	};
+	typedef map<UInt32, Attribute> AttributeMap;
+
+	AttributeMap mAttributes;
+	size_t mBytes;
+};
+
+} // end namespace KeychainCore
+} // end namespace Security
+
+void
+ItemAttributes::add(const CssmDbAttributeData &data)
+{
+	// a value just read from the database replaces whatever we had
+	UInt32 tag = data.info().Label.AttributeID;
+	AttributeMap::iterator it = mAttributes.find(tag);
+	if (it != mAttributes.end())
+		mBytes -= sizeof(Attribute) + it->second.value.size();
+
+	Attribute &attribute = mAttributes[tag];
+	attribute.info = data.info();
+	attribute.hasValue = data.size() > 0;
+	if (attribute.hasValue)
+		attribute.value.assign(data.Value[0].Data, data.Value[0].Data + data.Value[0].Length);
+	else
+		attribute.value.clear();
+	mBytes += sizeof(Attribute) + attribute.value.size();
+}
+
+void
+ItemAttributes::add(const DbAttributes &attributes)
+{
+	for (uint32 ix = 0; ix < attributes.size(); ++ix)
+		add(attributes.at(ix));
+}
+
+bool
+ItemAttributes::get(ItemImpl &item, UInt32 attributeId, SecKeychainAttribute &attr, UInt32 *actualLength) const
+{
+	AttributeMap::const_iterator it = mAttributes.find(attributeId);
+	if (it == mAttributes.end())
+		return false;
+
+	const Attribute &attribute = it->second;
+	CSSM_DATA value = { attribute.value.size(), attribute.value.empty() ? NULL : const_cast<uint8 *>(&attribute.value[0]) };
+	CSSM_DB_ATTRIBUTE_DATA data = { attribute.info, attribute.hasValue ? 1 : 0, &value };
+	item.getAttributeFrom(&CssmDbAttributeData::overlay(data), attr, actualLength);
+	return true;
+}
+
+bool
+ItemAttributes::copy(UInt32 count, const UInt32 *attributeIds, SecKeychainAttribute *attrs) const
+{
+	for (UInt32 ix = 0; ix < count; ++ix)
+		if (mAttributes.find(attributeIds[ix]) == mAttributes.end())
+			return false;
+
+	for (UInt32 ix = 0; ix < count; ++ix)
+	{
+		const Attribute &attribute = mAttributes.find(attributeIds[ix])->second;
+		attrs[ix].length = attribute.value.size();
+		attrs[ix].data = NULL;
+		if (attribute.hasValue && !attribute.value.empty())
+		{
+			attrs[ix].data = malloc(attribute.value.size());
+			if (!attrs[ix].data)
+			{
+				while (ix--)
+					free(attrs[ix].data);
+				UnixError::throwMe(ENOMEM);
+			}
+			memcpy(attrs[ix].data, &attribute.value[0], attribute.value.size());
+		}
+	}
+	return true;
+}
+
+
+//
+// ItemAttributeCache
+//
+// Attributes of persistent items, as read from the database, are kept in
+// a process-wide cache with a memory budget, so that reading the same
+// attribute again doesn't cost another trip to the database.  When the
+// budget is exceeded the attributes of the least recently used items are
+// dropped; they are simply re-read through the item's DbUniqueRecord the
+// next time they are asked for.  Item data is never cached, since reading
+// it is subject to the item's access control.
+//
+// Items modified or deleted through this process forget their attributes
+// directly.  Changes made by other processes only reach us as keychain
+// events, so the cache is off until a budget is set, and setting one
+// starts the CCallbackMgr listener that delivers those events.
+//
+// Lock order is item mMutex, then the cache's.
+//
+#define ITEM_ATTRIBUTE_CACHE_DEFAULT_BUDGET		0
+
+class ItemAttributeCache
+{
+public:
+	ItemAttributeCache() : mBudget(ITEM_ATTRIBUTE_CACHE_DEFAULT_BUDGET), mBytes(0),
+		mHits(0), mMisses(0), mEvictions(0), mEvictedBytes(0) {}
+
+	// hand a cached attribute of item to ItemImpl::getAttributeFrom
+	bool getAttribute(ItemImpl &item, UInt32 attributeId, SecKeychainAttribute &attr, UInt32 *actualLength);
+	// malloc copies of the values of attributes of item, if they are all cached
+	bool copyAttributes(const ItemImpl &item, UInt32 count, const UInt32 *attributeIds, SecKeychainAttribute *attrs);
+	void addAttribute(const ItemImpl &item, const CssmDbAttributeData &data);
+	void addAttributes(const ItemImpl &item, const DbAttributes &attributes);
+	void forget(const ItemImpl &item);
+
+	void setBudget(UInt64 budget);
+	void getStatistics(SecKeychainItemCacheStatistics &stats);
+
+private:
+	struct Entry
+	{
+		Entry(const ItemImpl *inItem) : item(inItem) {}
+		const ItemImpl *item;
+		ItemAttributes attributes;
+	};
+	typedef list<Entry> EntryList;				// most recently used first
+	typedef map<const ItemImpl *, EntryList::iterator> EntryMap;
+
+	void evict();
+
+	EntryList mEntries;
+	EntryMap mEntryMap;
+	UInt64 mBudget;
+	UInt64 mBytes;
+	UInt64 mHits;
+	UInt64 mMisses;
+	UInt64 mEvictions;
+	UInt64 mEvictedBytes;
+	Mutex mMutex;
+};
+
+static ModuleNexus<ItemAttributeCache> gItemAttributeCache;
+
+bool
+ItemAttributeCache::getAttribute(ItemImpl &item, UInt32 attributeId, SecKeychainAttribute &attr, UInt32 *actualLength)
+{
+	StLock<Mutex>_(mMutex);
+	EntryMap::iterator eit = mEntryMap.find(&item);
+	if (eit != mEntryMap.end() && eit->second->attributes.get(item, attributeId, attr, actualLength))
+	{
+		mHits++;
+		mEntries.splice(mEntries.begin(), mEntries, eit->second);
+		return true;
+	}
+
+	mMisses++;
+	return false;
+}
+
+bool
+ItemAttributeCache::copyAttributes(const ItemImpl &item, UInt32 count, const UInt32 *attributeIds, SecKeychainAttribute *attrs)
+{
+	StLock<Mutex>_(mMutex);
+	EntryMap::iterator eit = mEntryMap.find(&item);
+	if (eit == mEntryMap.end())
+	{
+		mMisses++;
+		return false;
+	}
+
+	if (!eit->second->attributes.copy(count, attributeIds, attrs))
+	{
+		mMisses++;
+		return false;
+	}
+
+	mHits++;
+	mEntries.splice(mEntries.begin(), mEntries, eit->second);
+	return true;
+}
+
+void
+ItemAttributeCache::addAttributes(const ItemImpl &item, const DbAttributes &attributes)
+{
+	for (uint32 ix = 0; ix < attributes.size(); ++ix)
+		addAttribute(item, attributes.at(ix));
+}
+
+void
+ItemAttributeCache::addAttribute(const ItemImpl &item, const CssmDbAttributeData &data)
+{
+	StLock<Mutex>_(mMutex);
+	if (mBudget == 0)
+		return;
+
+	EntryMap::iterator eit = mEntryMap.find(&item);
+	if (eit == mEntryMap.end())
+	{
+		mEntries.push_front(Entry(&item));
+		eit = mEntryMap.insert(EntryMap::value_type(&item, mEntries.begin())).first;
+	}
+	else
+		mEntries.splice(mEntries.begin(), mEntries, eit->second);
+
+	Entry &entry = *eit->second;
+	mBytes -= entry.attributes.bytes();
+	entry.attributes.add(data);
+	mBytes += entry.attributes.bytes();
+	evict();
+}
+
+void
+ItemAttributeCache::forget(const ItemImpl &item)
+{
+	StLock<Mutex>_(mMutex);
+	EntryMap::iterator eit = mEntryMap.find(&item);
+	if (eit != mEntryMap.end())
+	{
+		mBytes -= eit->second->attributes.bytes();
+		mEntries.erase(eit->second);
+		mEntryMap.erase(eit);
+	}
+}
+
+// drop least recently used items until we're within budget
+void
+ItemAttributeCache::evict()
+{
+	while (mBytes > mBudget && !mEntries.empty())
+	{
+		Entry &victim = mEntries.back();
+		size_t bytes = victim.attributes.bytes();
+		mBytes -= bytes;
+		mEvictions++;
+		mEvictedBytes += bytes;
+		mEntryMap.erase(victim.item);
+		mEntries.pop_back();
+	}
+}
+
+void
+ItemAttributeCache::setBudget(UInt64 budget)
+{
+	// other processes' changes are only noticed through keychain events
+	if (budget)
+		CCallbackMgr::Instance();
+
+	StLock<Mutex>_(mMutex);
+	mBudget = budget;
+	evict();
+}
+
+void
+ItemAttributeCache::getStatistics(SecKeychainItemCacheStatistics &stats)
+{
+	StLock<Mutex>_(mMutex);
+	stats.hits = mHits;
+	stats.misses = mMisses;
+	stats.evictions = mEvictions;
+	stats.evictedBytes = mEvictedBytes;
+	stats.bytes = mBytes;
+	stats.budget = mBudget;
+}
+
+
 //
 // ItemImpl
 //
@@ -174,6 +465,7 @@ ItemImpl::ItemImpl(ItemImpl &item) :
 
 ItemImpl::~ItemImpl()
 {
+	gItemAttributeCache().forget(*this);
 }
 
 
@@ -208,6 +500,47 @@ ItemImpl::didModify()
 	StLock<Mutex>_(mMutex);
 	mData = NULL;
 	mDbAttributes.reset(NULL);
+	mFetchedAttributes.reset(NULL);
+	gItemAttributeCache().forget(*this);
+}
+
+void
+ItemImpl::forgetCachedContent()
+{
+	StLock<Mutex>_(mMutex);
+	mFetchedAttributes.reset(NULL);
+	gItemAttributeCache().forget(*this);
+}
+
+void
+ItemImpl::didFetchAttributes(const DbAttributes &attributes)
+{
+	// kept with the item, whatever the cache's budget
+	auto_ptr<ItemAttributes> fetched(new ItemAttributes());
+	fetched->add(attributes);
+	StLock<Mutex>_(mMutex);
+	mFetchedAttributes = fetched;
+}
+
+UInt32
+ItemImpl::dbAttributeIdFor(SecItemClass itemClass, UInt32 tag)
+{
+	// must remap a caller-supplied label attribute tag for password items, since it isn't in the schema
+	if (tag == kSecLabelItemAttr && IS_PASSWORD_ITEM_CLASS(itemClass))
+		return APPLEDB_GENERIC_PRINTNAME_ATTRIBUTE;
+	return tag;
+}
+
+void
+ItemImpl::setContentCacheBudget(UInt64 budget)
+{
+	gItemAttributeCache().setBudget(budget);
+}
+
+void
+ItemImpl::getContentCacheStatistics(SecKeychainItemCacheStatistics &stats)
+{
+	gItemAttributeCache().getStatistics(stats);
 }
 
 const CSSM_DATA &
@@ -545,6 +878,10 @@ ItemImpl::update()
 						  CSSM_DB_MODIFY_ATTRIBUTE_REPLACE);
 	}
 
+	// Whatever attributes we had cached are now out of date.
+	mFetchedAttributes.reset(NULL);
+	gItemAttributeCache().forget(*this);
+
 	if (!mDoNotEncrypt)
 	{
 		PrimaryKey oldPK = mPrimaryKey;
@@ -742,6 +1079,8 @@ ItemImpl::modifyContent(const SecKeychainAttributeList *attrList, UInt32 dataLen
 		mData = new CssmDataContainer(inData, dataLength);
 	}
 	
+	mFetchedAttributes.reset(NULL);
+	gItemAttributeCache().forget(*this);
 	update();
 }
 
@@ -763,12 +1102,21 @@ ItemImpl::getContent(SecItemClass *itemClass, SecKeychainAttributeList *attrList
 		*itemClass = Schema::itemClassFor(recordType());
     
     bool getDataFromDatabase = mKeychain && mPrimaryKey;
+	UInt32 attrCount = attrList ? attrList->count : 0;
+	if (getDataFromDatabase && !outData && attrCount)
+	{
+		// the attributes may all have been read already
+		vector<UInt32> attributeIds(attrCount);
+		for (UInt32 ix = 0; ix < attrCount; ++ix)
+			attributeIds[ix] = Schema::attributeInfo(attrList->attr[ix].tag).Label.AttributeID;
+		if ((mFetchedAttributes.get() && mFetchedAttributes->copy(attrCount, &attributeIds[0], attrList->attr))
+			|| gItemAttributeCache().copyAttributes(*this, attrCount, &attributeIds[0], attrList->attr))
+			return;
+	}
+
     if (getDataFromDatabase) // are we attached to a database?
     {
         dbUniqueRecord();
-
-		// get the number of attributes requested by the caller
-		UInt32 attrCount = attrList ? attrList->count : 0;
     
         // make a DBAttributes structure and populate it
         DbAttributes dbAttributes(mUniqueId->database(), attrCount);
@@ -780,6 +1128,7 @@ ItemImpl::getContent(SecItemClass *itemClass, SecKeychainAttributeList *attrList
         // request the data from the database (since we are a reference "item" and the data is really stored there)
         CssmDataContainer itemData;
 		getContent(&dbAttributes, outData ? &itemData : NULL);
+		gItemAttributeCache().addAttributes(*this, dbAttributes);
 
         // retrieve the data from result
         for (UInt32 ix = 0; ix < attrCount; ++ix)
@@ -888,6 +1237,8 @@ ItemImpl::modifyAttributesAndData(const SecKeychainAttributeList *attrList, UInt
 		mData = new CssmDataContainer(inData, dataLength);
 	}
 	
+	mFetchedAttributes.reset(NULL);
+	gItemAttributeCache().forget(*this);
 	update();
 }
 
@@ -909,27 +1260,52 @@ ItemImpl::getAttributesAndData(SecKeychainAttributeInfo *info, SecItemClass *ite
 	if (itemClass)
 		*itemClass = myItemClass;
 
+    UInt32 attrCount = info ? info->count : 0;
+	if (mKeychain && !outData && attrCount && attrList)
+	{
+		// the attributes may all have been read already
+		vector<UInt32> attributeIds(attrCount);
+		for (UInt32 ix = 0; ix < attrCount; ix++)
+			attributeIds[ix] = dbAttributeIdFor(myItemClass, info->tag[ix]);
+
+		SecKeychainAttribute *attr=reinterpret_cast<SecKeychainAttribute *>(malloc(sizeof(SecKeychainAttribute)*attrCount));
+		if (!attr)
+			MacOSError::throwMe(errSecAllocate);
+		if ((mFetchedAttributes.get() && mFetchedAttributes->copy(attrCount, &attributeIds[0], attr))
+			|| gItemAttributeCache().copyAttributes(*this, attrCount, &attributeIds[0], attr))
+		{
+			SecKeychainAttributeList *theList=reinterpret_cast<SecKeychainAttributeList *>(malloc(sizeof(SecKeychainAttributeList)));
+			if (!theList)
+			{
+				for (UInt32 ix = 0; ix < attrCount; ++ix)
+					free(attr[ix].data);
+				free(attr);
+				MacOSError::throwMe(errSecAllocate);
+			}
+			theList->count=attrCount;
+			theList->attr=attr;
+			for (UInt32 ix = 0; ix < attrCount; ++ix)
+				attr[ix].tag=info->tag[ix];
+			*attrList=theList;
+			return;
+		}
+		free(attr);
+	}
+
 	// @@@ This call won't work for floating items (like certificates).
 	dbUniqueRecord();
 
-    UInt32 attrCount = info ? info->count : 0;
 	DbAttributes dbAttributes(mUniqueId->database(), attrCount);
     for (UInt32 ix = 0; ix < attrCount; ix++)
 	{
 		CssmDbAttributeData &record = dbAttributes.add();
 		record.Info.AttributeNameFormat=CSSM_DB_ATTRIBUTE_NAME_AS_INTEGER;
-		record.Info.Label.AttributeID=info->tag[ix];
-    
-        if (record.Info.Label.AttributeID == kSecLabelItemAttr)
-        {
-            // must remap a caller-supplied label attribute tag for password items, since it isn't in the schema
-            if (IS_PASSWORD_ITEM_CLASS( myItemClass ))
-                record.Info.Label.AttributeID = APPLEDB_GENERIC_PRINTNAME_ATTRIBUTE;
-        }
+		record.Info.Label.AttributeID=dbAttributeIdFor(myItemClass, info->tag[ix]);
 	}
 
 	CssmDataContainer itemData;
     getContent(&dbAttributes, outData ? &itemData : NULL);
+	gItemAttributeCache().addAttributes(*this, dbAttributes);
 
 	if (info && attrList)
 	{
@@ -1016,11 +1392,17 @@ ItemImpl::getAttribute(SecKeychainAttribute& attr, UInt32 *actualLength)
 
 	if (!mKeychain)
 		MacOSError::throwMe(errSecNoSuchAttr);
+
+	const CssmDbAttributeInfo &info = Schema::attributeInfo(attr.tag);
+	if ((mFetchedAttributes.get() && mFetchedAttributes->get(*this, info.Label.AttributeID, attr, actualLength))
+		|| gItemAttributeCache().getAttribute(*this, info.Label.AttributeID, attr, actualLength))
+		return;
 		
 	dbUniqueRecord();
 	DbAttributes dbAttributes(mUniqueId->database(), 1);
-	dbAttributes.add(Schema::attributeInfo(attr.tag));
+	dbAttributes.add(info);
 	mUniqueId->get(&dbAttributes, NULL);
+	gItemAttributeCache().addAttribute(*this, dbAttributes.at(0));
 	getAttributeFrom(&dbAttributes.at(0), attr, actualLength);
 }
 
@@ -32,6 +32,7 @@
 #include <security_keychain/PrimaryKey.h>
 #include <security_cdsa_client/securestorage.h>
 #include <security_keychain/Access.h>
+#include <Security/SecKeychainItemPriv.h>
 
 namespace Security
 {
@@ -41,6 +42,7 @@ using namespace CssmClient;
 namespace KeychainCore
 {
 class Keychain;
+class ItemAttributes;
 
 class ItemImpl : public SecCFObject
 {
@@ -149,6 +151,18 @@ public:
 
 	/* For binding to extended attributes. */
 	virtual const CssmData &itemID();
+
+	// Drop any attributes of ours held in the process-wide attribute cache,
+	// or fetched with our record, e.g. because another process changed the item.
+	void forgetCachedContent();
+	// Keep attributes read along with our record, e.g. by a KCCursor. These
+	// are held by the item itself, outside the cache's budget, until it is
+	// modified or forgetCachedContent() is called.
+	void didFetchAttributes(const CssmClient::DbAttributes &attributes);
+	// The schema attribute ID for a SecKeychainAttribute tag.
+	static UInt32 dbAttributeIdFor(SecItemClass itemClass, UInt32 tag);
+	static void setContentCacheBudget(UInt64 budget);
+	static void getContentCacheStatistics(SecKeychainItemCacheStatistics &stats);
 	
 protected:
 	// new item members
@@ -169,6 +183,9 @@ private:
 	// True iff we are in the cache of items in mKeychain
 	bool mInCache;
 
+	// attributes read along with our record; protected by mMutex
+	auto_ptr<ItemAttributes> mFetchedAttributes;
+
 protected:
 	Mutex mMutex;
 };
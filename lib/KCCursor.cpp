@@ -34,6 +34,7 @@
 #include "cssmdatetime.h"
 #include "Globals.h"
 #include "StorageManager.h"
+#include "CCallbackMgr.h"
 #include <CoreServices/../Frameworks/CarbonCore.framework/Headers/MacErrors.h>
 #include <Security/SecKeychainItemPriv.h>
 
@@ -58,6 +59,11 @@ KCCursorImpl::KCCursorImpl(const StorageManager::KeychainList &searchList, SecIt
 	mSearchList(searchList),
 	mCurrent(mSearchList.begin()),
 	mAllFailed(true),
+	mFetchAttributes(false),
+	mFetchAllAttributes(false),
+	mProjectsLabel(false),
+	mLimit(0),
+	mReturned(0),
 	mMutex(Mutex::recursive)
 {
     recordType(Schema::recordTypeFor(itemClass));
@@ -113,6 +119,11 @@ KCCursorImpl::KCCursorImpl(const StorageManager::KeychainList &searchList, const
 	mSearchList(searchList),
 	mCurrent(mSearchList.begin()),
 	mAllFailed(true),
+	mFetchAttributes(false),
+	mFetchAllAttributes(false),
+	mProjectsLabel(false),
+	mLimit(0),
+	mReturned(0),
 	mMutex(Mutex::recursive)
 {
 	if (!attrList) // No additional selectionPredicates: we are done
@@ -171,6 +182,124 @@ KCCursorImpl::~KCCursorImpl() throw()
 
 static ModuleNexus<Mutex> gActivationMutex;
 
+// DL calls made on behalf of search cursors, for SecKeychainSearchGetStatistics
+class CursorStatistics
+{
+public:
+	CursorStatistics() { memset(&counts, 0, sizeof(counts)); }
+
+	Mutex mutex;
+	SecKeychainSearchStatistics counts;
+};
+
+static ModuleNexus<CursorStatistics> gCursorStatistics;
+
+static void
+countCall(UInt64 SecKeychainSearchStatistics::*counter)
+{
+	CursorStatistics &statistics = gCursorStatistics();
+	StLock<Mutex>_(statistics.mutex);
+	statistics.counts.*counter += 1;
+}
+
+void
+KCCursorImpl::getStatistics(SecKeychainSearchStatistics &stats)
+{
+	CursorStatistics &statistics = gCursorStatistics();
+	StLock<Mutex>_(statistics.mutex);
+	stats = statistics.counts;
+}
+
+void
+KCCursorImpl::activateDatabase(const Keychain &keychain)
+{
+	// see the warning in next()
+	StLock<Mutex> _(gActivationMutex());
+	keychain->database()->activate();
+	countCall(&SecKeychainSearchStatistics::activations);
+}
+
+void
+KCCursorImpl::limit(UInt32 maxItems)
+{
+	StLock<Mutex>_(mMutex);
+	mLimit = maxItems;
+}
+
+void
+KCCursorImpl::fetchAttributes(const SecKeychainAttributeInfo *info)
+{
+	// items keep what we fetch until another process's change reaches them
+	// as a keychain event, so make sure someone is listening for those
+	CCallbackMgr::Instance();
+
+	StLock<Mutex>_(mMutex);
+	mFetchAttributes = true;
+	mFetchAllAttributes = (info == NULL);
+	mFetchTags.clear();
+	if (info)
+		mFetchTags.assign(info->tag, info->tag + info->count);
+}
+
+// Work out which attributes to ask for with each record of this keychain.
+void
+KCCursorImpl::projectAttributes(const Keychain &keychain)
+{
+	mProjection.clear();
+	mProjectsLabel = false;
+
+	CSSM_DB_RECORDTYPE rt = recordType();
+	if (rt == CSSM_DL_DB_RECORD_ANY)
+		return;
+	// the label of a symmetric key is needed anyway, to filter out group keys
+	if (!mFetchAttributes && rt != CSSM_DL_DB_RECORD_SYMMETRIC_KEY)
+		return;
+
+	try
+	{
+		KeychainSchema schema = keychain->keychainSchema();
+		if (!schema->hasRecordType(rt))
+			return;
+
+		if (mFetchAttributes)
+		{
+			if (mFetchAllAttributes)
+			{
+				SecKeychainAttributeInfo *info;
+				schema->getAttributeInfoForRecordType(rt, &info);
+				for (UInt32 ix = 0; ix < info->count; ++ix)
+					mProjection.push_back(schema->attributeInfoFor(rt, info->tag[ix]));
+				KeychainImpl::freeAttributeInfo(info);
+			}
+			else
+			{
+				SecItemClass itemClass = Schema::itemClassFor(rt);
+				for (std::vector<UInt32>::const_iterator it = mFetchTags.begin(); it != mFetchTags.end(); ++it)
+				{
+					UInt32 attributeId = ItemImpl::dbAttributeIdFor(itemClass, *it);
+					if (schema->hasAttribute(rt, attributeId))
+						mProjection.push_back(schema->attributeInfoFor(rt, attributeId));
+				}
+			}
+		}
+
+		for (std::vector<CssmDbAttributeInfo>::const_iterator it = mProjection.begin(); it != mProjection.end(); ++it)
+			if (it->nameFormat() == CSSM_DB_ATTRIBUTE_NAME_AS_INTEGER && it->intName() == KeySchema::Label.intName())
+				mProjectsLabel = true;
+		if (rt == CSSM_DL_DB_RECORD_SYMMETRIC_KEY && !mProjectsLabel)
+		{
+			mProjection.push_back(KeySchema::Label);
+			mProjectsLabel = true;
+		}
+	}
+	catch (...)
+	{
+		// fall back to fetching attributes as they're asked for
+		mProjection.clear();
+		mProjectsLabel = false;
+	}
+}
+
 bool
 KCCursorImpl::next(Item &item)
 {
@@ -179,6 +308,9 @@ KCCursorImpl::next(Item &item)
 	DbUniqueRecord uniqueId;
 	OSStatus status = 0;
 
+	if (mLimit && mReturned >= mLimit)
+		return false;
+
 	for (;;)
 	{
 		while (!mDbCursor)
@@ -213,7 +345,10 @@ KCCursorImpl::next(Item &item)
             
                 StLock<Mutex> _(gActivationMutex()); // force serialization of cursor creation
 				(*mCurrent)->database()->activate();
+				countCall(&SecKeychainSearchStatistics::activations);
 				mDbCursor = DbCursor((*mCurrent)->database(), *this);
+				countCall(&SecKeychainSearchStatistics::queries);
+				projectAttributes(*mCurrent);
 			}
 			catch(const CommonError &err)
 			{
@@ -227,7 +362,10 @@ KCCursorImpl::next(Item &item)
 			// Clear out existing attributes first!
 			// (the previous iteration may have left attributes from a different schema)
 			dbAttributes.clear();
+			for (std::vector<CssmDbAttributeInfo>::const_iterator it = mProjection.begin(); it != mProjection.end(); ++it)
+				dbAttributes.add(*it);
 
+			countCall(&SecKeychainSearchStatistics::recordRequests);
 			gotRecord = mDbCursor->next(&dbAttributes, NULL, uniqueId);
 			mAllFailed = false;
 		}
@@ -265,11 +403,22 @@ KCCursorImpl::next(Item &item)
         if (dbAttributes.recordType() == CSSM_DL_DB_RECORD_SYMMETRIC_KEY)
         {
 			bool groupKey = false;
-			try
+			if (mProjectsLabel)
+			{
+				// the label came back with the record
+				CssmDbAttributeData *label = dbAttributes.find(KeySchema::Label);
+				CssmData attrData;
+				if (label && label->size())
+					attrData = *label;
+				if (attrData.length() > 4 && !memcmp(attrData.data(), "ssgp", 4))
+					groupKey = true;
+			}
+			else try
 			{
 				// fetch the key label attribute, if it exists
 				dbAttributes.add(KeySchema::Label);
 				Db db((*mCurrent)->database());
+				countCall(&SecKeychainSearchStatistics::recordReads);
 				CSSM_RETURN getattr_result = CSSM_DL_DataGetFromUniqueRecordId(db->handle(), uniqueId, &dbAttributes, NULL);
 				if (getattr_result == CSSM_OK)
 				{
@@ -296,5 +445,14 @@ KCCursorImpl::next(Item &item)
 
 	// Go though Keychain since item might already exist.
 	item = (*mCurrent)->item(dbAttributes.recordType(), uniqueId);
+	if (mFetchAttributes && !mProjection.empty())
+		item->didFetchAttributes(dbAttributes);
+
+	if (mLimit && ++mReturned >= mLimit)
+	{
+		// done: end the query now rather than when the cursor is released
+		mDbCursor = DbCursor();
+		mCurrent = mSearchList.end();
+	}
 	return true;
 }
@@ -28,6 +28,7 @@
 #define _SECURITY_KCCURSOR_H_
 
 #include <security_keychain/StorageManager.h>
+#include <Security/SecKeychainSearchPriv.h>
 
 namespace Security
 {
@@ -50,11 +51,37 @@ public:
 	virtual ~KCCursorImpl() throw();
 	bool next(Item &item);
 
+	// activate keychain's database, serialized with cursor creation
+	static void activateDatabase(const Keychain &keychain);
+
+	// Fetch these attributes with each record and hand them to the items
+	// returned, so reading them afterwards needn't go back to the database.
+	// A NULL info means every attribute of the record type.  The items keep
+	// them regardless of the attribute cache's budget; this starts the
+	// keychain event listener so other processes' changes still reach them.
+	void fetchAttributes(const SecKeychainAttributeInfo *info);
+
+	// Return no more than maxItems items; once that many have been returned
+	// the query is dropped and later keychains are never activated or
+	// searched.  0 means no limit.
+	void limit(UInt32 maxItems);
+
+	static void getStatistics(SecKeychainSearchStatistics &stats);
+
 private:
+	void projectAttributes(const Keychain &keychain);
+
 	StorageManager::KeychainList mSearchList;
 	StorageManager::KeychainList::iterator mCurrent;
 	CssmClient::DbCursor mDbCursor;
 	bool mAllFailed;
+	bool mFetchAttributes;
+	bool mFetchAllAttributes;
+	std::vector<UInt32> mFetchTags;
+	std::vector<CssmDbAttributeInfo> mProjection;	// for the current keychain
+	bool mProjectsLabel;
+	UInt32 mLimit;
+	UInt32 mReturned;
 
 protected:
 	Mutex mMutex;
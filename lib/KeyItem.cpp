@@ -367,6 +367,7 @@ KeyItem::importTo(const Keychain &keychain, Access *newAccess, SecKeychainAttrib
 void
 KeyItem::didModify()
 {
+	ItemImpl::didModify();
 }
 
 PrimaryKey
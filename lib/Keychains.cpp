@@ -53,6 +53,8 @@
 #include <sys/un.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#include <pwd.h>
+#include <unistd.h>
 
 static dispatch_once_t SecKeychainSystemKeychainChecked;
 
@@ -90,7 +92,43 @@ EventBuffer::~EventBuffer ()
 //
 // KeychainSchemaImpl
 //
-KeychainSchemaImpl::KeychainSchemaImpl(const Db &db) : mMutex(Mutex::recursive)
+KeychainSchemaImpl::KeychainSchemaImpl() : mFingerprint(0)
+{
+}
+
+KeychainSchemaImpl::KeychainSchemaImpl(const Db &db) : mFingerprint(0)
+{
+	readAttributes(db, mDatabaseInfoMap);
+
+	for (DatabaseInfoMap::iterator dit = mDatabaseInfoMap.begin(); dit != mDatabaseInfoMap.end(); ++dit)
+	{
+		DbUniqueRecord uniqueId(db);
+		uint32 relationID = dit->first;
+
+		// Create a cursor on the CSSM_DL_DB_SCHEMA_INDEXES table for records
+		// with RelationID == relationID
+		DbCursor indexes(db);
+		indexes->recordType(CSSM_DL_DB_SCHEMA_INDEXES);
+		indexes->conjunctive(CSSM_DB_AND);
+		indexes->add(CSSM_DB_EQUAL, Schema::RelationID, relationID);
+		indexes->add(CSSM_DB_EQUAL, Schema::IndexType,
+			uint32(CSSM_DB_INDEX_UNIQUE));
+
+		// Set up a record for retriving the SCHEMA_INDEXES
+		DbAttributes indexRecord(db, 1);
+		indexRecord.add(Schema::AttributeID);
+
+		CssmAutoDbRecordAttributeInfo &infos = newPrimaryKeyInfos(relationID);
+		while (indexes->next(&indexRecord, NULL, uniqueId))
+			addPrimaryKeyAttribute(infos, dit->second, indexRecord.at(0));
+	}
+
+	freeze();
+}
+
+// The attributes of each relation of db, from its schema relations.
+void
+KeychainSchemaImpl::readAttributes(const Db &db, DatabaseInfoMap &databaseInfo)
 {
 	DbCursor relations(db);
 	relations->recordType(CSSM_DL_DB_SCHEMA_INFO);
@@ -118,36 +156,9 @@ KeychainSchemaImpl::KeychainSchemaImpl(const Db &db) : mMutex(Mutex::recursive)
 		attributeRecord.add(Schema::AttributeFormat);
 		attributeRecord.add(Schema::AttributeID);	
 
-		RelationInfoMap &rim = mDatabaseInfoMap[relationID];
+		RelationInfoMap &rim = databaseInfo[relationID];
 		while (attributes->next(&attributeRecord, NULL, uniqueId))
 			rim[attributeRecord.at(1)] = attributeRecord.at(0);
-		
-		// Create a cursor on the CSSM_DL_DB_SCHEMA_INDEXES table for records
-		// with RelationID == relationID
-		DbCursor indexes(db);
-		indexes->recordType(CSSM_DL_DB_SCHEMA_INDEXES);
-		indexes->conjunctive(CSSM_DB_AND);
-		indexes->add(CSSM_DB_EQUAL, Schema::RelationID, relationID);
-		indexes->add(CSSM_DB_EQUAL, Schema::IndexType,
-			uint32(CSSM_DB_INDEX_UNIQUE));
-
-		// Set up a record for retriving the SCHEMA_INDEXES
-		DbAttributes indexRecord(db, 1);
-		indexRecord.add(Schema::AttributeID);
-
-		CssmAutoDbRecordAttributeInfo &infos =
-			*new CssmAutoDbRecordAttributeInfo();
-		mPrimaryKeyInfoMap.
-			insert(PrimaryKeyInfoMap::value_type(relationID, &infos));
-		infos.DataRecordType = relationID;
-		while (indexes->next(&indexRecord, NULL, uniqueId))
-		{
-			CssmDbAttributeInfo &info = infos.add();
-			info.AttributeNameFormat = CSSM_DB_ATTRIBUTE_NAME_AS_INTEGER;
-			info.Label.AttributeID = indexRecord.at(0);
-			// @@@ Might insert bogus value if DB is corrupt
-			info.AttributeFormat = rim[info.Label.AttributeID];
-		}
 	}
 }
 
@@ -162,52 +173,445 @@ KeychainSchemaImpl::~KeychainSchemaImpl()
 	}
 }
 
-const KeychainSchemaImpl::RelationInfoMap &
-KeychainSchemaImpl::relationInfoMapFor(CSSM_DB_RECORDTYPE recordType) const
+CssmAutoDbRecordAttributeInfo &
+KeychainSchemaImpl::newPrimaryKeyInfos(CSSM_DB_RECORDTYPE relationID)
 {
-	DatabaseInfoMap::const_iterator dit = mDatabaseInfoMap.find(recordType);
-	if (dit == mDatabaseInfoMap.end())
-		MacOSError::throwMe(errSecNoSuchClass);
-	return dit->second;
+	CssmAutoDbRecordAttributeInfo *infos = new CssmAutoDbRecordAttributeInfo();
+	infos->DataRecordType = relationID;
+
+	PrimaryKeyInfoMap::iterator it = mPrimaryKeyInfoMap.find(relationID);
+	if (it == mPrimaryKeyInfoMap.end())
+		mPrimaryKeyInfoMap.insert(PrimaryKeyInfoMap::value_type(relationID, infos));
+	else
+	{
+		delete it->second;
+		it->second = infos;
+	}
+
+	return *infos;
 }
 
-bool KeychainSchemaImpl::hasRecordType (CSSM_DB_RECORDTYPE recordType) const
+void
+KeychainSchemaImpl::addPrimaryKeyAttribute(CssmAutoDbRecordAttributeInfo &infos,
+	RelationInfoMap &rim, uint32 attributeID)
 {
-	DatabaseInfoMap::const_iterator it = mDatabaseInfoMap.find(recordType);
-	return it != mDatabaseInfoMap.end();
+	CssmDbAttributeInfo &info = infos.add();
+	info.AttributeNameFormat = CSSM_DB_ATTRIBUTE_NAME_AS_INTEGER;
+	info.Label.AttributeID = attributeID;
+	// @@@ Might insert bogus value if DB is corrupt
+	info.AttributeFormat = rim[attributeID];
 }
-	
-bool
-KeychainSchemaImpl::hasAttribute(CSSM_DB_RECORDTYPE recordType, uint32 attributeId) const
+
+//
+// The encoding is a sequence of words: the number of relations, then for
+// each relation its ID, the number of attributes, an (ID, format) pair for
+// each attribute, the number of primary key attributes and their IDs.
+//
+void
+KeychainSchemaImpl::encode(Encoding &encoding) const
 {
-	try
+	encoding.clear();
+	encoding.push_back(mDatabaseInfoMap.size());
+	for (DatabaseInfoMap::const_iterator dit = mDatabaseInfoMap.begin(); dit != mDatabaseInfoMap.end(); ++dit)
 	{
-		const RelationInfoMap &rmap = relationInfoMapFor(recordType);
-		RelationInfoMap::const_iterator rit = rmap.find(attributeId);
-		return rit != rmap.end();
+		encoding.push_back(dit->first);
+		encoding.push_back(dit->second.size());
+		for (RelationInfoMap::const_iterator rit = dit->second.begin(); rit != dit->second.end(); ++rit)
+		{
+			encoding.push_back(rit->first);
+			encoding.push_back(rit->second);
+		}
+
+		PrimaryKeyInfoMap::const_iterator pit = mPrimaryKeyInfoMap.find(dit->first);
+		if (pit == mPrimaryKeyInfoMap.end())
+			encoding.push_back(0);
+		else
+		{
+			const CssmAutoDbRecordAttributeInfo &infos = *pit->second;
+			encoding.push_back(infos.size());
+			for (uint32 ix = 0; ix < infos.size(); ++ix)
+				encoding.push_back(infos.at(ix).Label.AttributeID);
+		}
 	}
-	catch (MacOSError result)
+}
+
+KeychainSchemaImpl *
+KeychainSchemaImpl::decode(const uint32 *words, size_t count)
+{
+	const uint32 *end = words + count;
+	auto_ptr<KeychainSchemaImpl> schema(new KeychainSchemaImpl());
+
+	if (words == end)
+		return NULL;
+	uint32 relationCount = *words++;
+	while (relationCount--)
 	{
-		if (result.osStatus () == errSecNoSuchClass)
+		if (end - words < 2)
+			return NULL;
+		uint32 relationID = *words++;
+		uint32 attributeCount = *words++;
+		if (uint32(end - words) / 2 < attributeCount)
+			return NULL;
+
+		RelationInfoMap &rim = schema->mDatabaseInfoMap[relationID];
+		for (; attributeCount; --attributeCount, words += 2)
+			rim[words[0]] = words[1];
+
+		if (words == end)
+			return NULL;
+		uint32 keyCount = *words++;
+		if (uint32(end - words) < keyCount)
+			return NULL;
+
+		CssmAutoDbRecordAttributeInfo &infos = schema->newPrimaryKeyInfos(relationID);
+		for (; keyCount; --keyCount)
+			addPrimaryKeyAttribute(infos, rim, *words++);
+	}
+	if (words != end)
+		return NULL;
+
+	schema->freeze();
+	return schema.release();
+}
+
+// called once a schema is complete; it must not change after this
+void
+KeychainSchemaImpl::freeze()
+{
+	Encoding encoding;
+	encode(encoding);
+
+	// 64 bit FNV-1a
+	uint64 hash = 14695981039346656037ULL;
+	const uint8 *bytes = reinterpret_cast<const uint8 *>(&encoding[0]);
+	for (size_t ix = 0; ix < encoding.size() * sizeof(uint32); ++ix)
+		hash = (hash ^ bytes[ix]) * 1099511628211ULL;
+	mFingerprint = hash;
+
+	// std::map iterates in key order, so both tables come out sorted
+	mRelations.clear();
+	mAttributes.clear();
+	mRelations.reserve(mDatabaseInfoMap.size());
+	for (DatabaseInfoMap::const_iterator dit = mDatabaseInfoMap.begin(); dit != mDatabaseInfoMap.end(); ++dit)
+	{
+		RelationEntry relation;
+		relation.recordType = dit->first;
+		relation.firstAttribute = mAttributes.size();
+		relation.attributeCount = dit->second.size();
+		PrimaryKeyInfoMap::const_iterator pit = mPrimaryKeyInfoMap.find(dit->first);
+		relation.primaryKeyInfos = pit == mPrimaryKeyInfoMap.end() ? NULL : pit->second;
+		mRelations.push_back(relation);
+
+		for (RelationInfoMap::const_iterator rit = dit->second.begin(); rit != dit->second.end(); ++rit)
 		{
-			return false;
+			AttributeEntry attribute;
+			attribute.attributeId = rit->first;
+			attribute.format = rit->second;
+			mAttributes.push_back(attribute);
 		}
+	}
+}
+
+const KeychainSchemaImpl::RelationEntry *
+KeychainSchemaImpl::relationFor(CSSM_DB_RECORDTYPE recordType) const
+{
+	size_t low = 0, high = mRelations.size();
+	while (low < high)
+	{
+		size_t mid = (low + high) / 2;
+		if (mRelations[mid].recordType < recordType)
+			low = mid + 1;
 		else
+			high = mid;
+	}
+
+	if (low < mRelations.size() && mRelations[low].recordType == recordType)
+		return &mRelations[low];
+	return NULL;
+}
+
+const KeychainSchemaImpl::AttributeEntry *
+KeychainSchemaImpl::attributeFor(const RelationEntry &relation, uint32 attributeId) const
+{
+	const AttributeEntry *attributes = relation.attributeCount ? &mAttributes[relation.firstAttribute] : NULL;
+	size_t low = 0, high = relation.attributeCount;
+	while (low < high)
+	{
+		size_t mid = (low + high) / 2;
+		if (attributes[mid].attributeId < attributeId)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	if (low < relation.attributeCount && attributes[low].attributeId == attributeId)
+		return &attributes[low];
+	return NULL;
+}
+
+bool
+KeychainSchemaImpl::sameAs(const KeychainSchemaImpl &other) const
+{
+	if (mFingerprint != other.mFingerprint)
+		return false;
+
+	Encoding mine, theirs;
+	encode(mine);
+	other.encode(theirs);
+	return mine == theirs;
+}
+
+
+//
+// Schemas are interned in a process-wide table, and never removed from it:
+// there are only ever a handful of distinct schemas.
+//
+class KeychainSchemaTable
+{
+public:
+	KeychainSchema intern(const KeychainSchema &schema);
+
+private:
+	typedef multimap<uint64, KeychainSchema> SchemaMap;
+	SchemaMap mSchemas;
+	Mutex mMutex;
+};
+
+KeychainSchema
+KeychainSchemaTable::intern(const KeychainSchema &schema)
+{
+	StLock<Mutex>_(mMutex);
+	pair<SchemaMap::iterator, SchemaMap::iterator> range = mSchemas.equal_range(schema->fingerprint());
+	for (SchemaMap::iterator it = range.first; it != range.second; ++it)
+		if (it->second->sameAs(*schema))
+			return it->second;
+
+	mSchemas.insert(SchemaMap::value_type(schema->fingerprint(), schema));
+	return schema;
+}
+
+static ModuleNexus<KeychainSchemaTable> gKeychainSchemas;
+
+
+//
+// The on-disk schema cache holds one file per keychain, named for a hash of
+// the keychain's path, under the effective user's ~/Library/Caches.  A cache
+// file records the device, inode, size and modification time (to the
+// nanosecond) of the keychain file it was read from, and while the keychain
+// file is unchanged it is used as is, without reading anything from the
+// keychain.  Writing an item replaces the keychain file, so once it has
+// changed the cache is only used if the keychain's relations and their
+// attributes are still exactly those cached; that walk is cheaper than
+// reading the indexes and building the schema, and a relation's indexes
+// are fixed when it is created.  The cache is then rewritten for the new
+// file.  Any problem with the cache just means we read the schema from the
+// keychain.
+//
+#define SCHEMA_CACHE_DIRECTORY	"/Library/Caches/com.apple.security.KeychainSchemas"
+#define SCHEMA_CACHE_MAGIC		0x6b637363	/* 'kcsc' */
+#define SCHEMA_CACHE_VERSION	3
+#define SCHEMA_CACHE_MAX_WORDS	0x10000
+
+struct SchemaCacheKeychain
+{
+	uint64 device;
+	uint64 inode;
+	uint64 size;
+	int64 modified;			// nanoseconds
+};
+
+struct SchemaCacheHeader
+{
+	uint32 magic;
+	uint32 version;
+	SchemaCacheKeychain keychain;	// the file the schema was read from
+	uint64 fingerprint;
+	uint32 count;			// of encoding words which follow
+	uint32 reserved;
+};
+
+static bool schemaCacheKeychain(const char *dbName, SchemaCacheKeychain &keychain)
+{
+	struct stat st;
+	if (stat(dbName, &st) || !S_ISREG(st.st_mode))
+		return false;
+	memset(&keychain, 0, sizeof(keychain));
+	keychain.device = st.st_dev;
+	keychain.inode = st.st_ino;
+	keychain.size = st.st_size;
+	keychain.modified = int64(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+	return true;
+}
+
+// the effective user's own, and nobody else's to write
+static bool schemaCacheOwned(const struct stat &st)
+{
+	return st.st_uid == geteuid() && !(st.st_mode & (S_IWGRP | S_IWOTH));
+}
+
+static bool schemaCachePath(const char *dbName, string &path)
+{
+	if (dbName == NULL || dbName[0] != '/')
+		return false;
+
+	// not $HOME: that's whoever ran us, which matters if we're privileged
+	struct passwd pwbuf, *pw = NULL;
+	char buf[4096];
+	if (getpwuid_r(geteuid(), &pwbuf, buf, sizeof(buf), &pw) || pw == NULL || pw->pw_dir == NULL)
+		return false;
+
+	uint64 hash = 14695981039346656037ULL;
+	for (const char *p = dbName; *p; ++p)
+		hash = (hash ^ uint8(*p)) * 1099511628211ULL;
+
+	char name[32];
+	snprintf(name, sizeof(name), "/%016llx", (unsigned long long)hash);
+	path = string(pw->pw_dir) + SCHEMA_CACHE_DIRECTORY + name;
+	return true;
+}
+
+static KeychainSchemaImpl *readSchemaCache(const string &path, const SchemaCacheKeychain &keychain,
+	bool &sameKeychain)
+{
+	struct stat st;
+	string dir = path.substr(0, path.rfind('/'));
+	if (stat(dir.c_str(), &st) || !S_ISDIR(st.st_mode) || !schemaCacheOwned(st))
+		return NULL;
+
+	int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW);
+	if (fd < 0)
+		return NULL;
+
+	KeychainSchemaImpl *schema = NULL;
+	SchemaCacheHeader header;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && schemaCacheOwned(st)
+		&& read(fd, &header, sizeof(header)) == sizeof(header)
+		&& header.magic == SCHEMA_CACHE_MAGIC && header.version == SCHEMA_CACHE_VERSION
+		&& header.count > 0 && header.count <= SCHEMA_CACHE_MAX_WORDS)
+	{
+		KeychainSchemaImpl::Encoding words(header.count);
+		ssize_t length = header.count * sizeof(uint32);
+		if (read(fd, &words[0], length) == length)
 		{
-			throw;
+			schema = KeychainSchemaImpl::decode(&words[0], words.size());
+			if (schema && schema->fingerprint() != header.fingerprint)
+			{
+				delete schema;
+				schema = NULL;
+			}
 		}
 	}
+	close(fd);
+
+	if (schema == NULL)
+		secdebug("kcschema", "schema cache %s is damaged or not ours", path.c_str());
+	else
+		sameKeychain = !memcmp(&header.keychain, &keychain, sizeof(keychain));
+	return schema;
+}
+
+static void writeSchemaCache(const string &path, const SchemaCacheKeychain &keychain, const KeychainSchemaImpl &schema)
+{
+	KeychainSchemaImpl::Encoding words;
+	schema.encode(words);
+	if (words.size() > SCHEMA_CACHE_MAX_WORDS)
+		return;
+
+	SchemaCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = SCHEMA_CACHE_MAGIC;
+	header.version = SCHEMA_CACHE_VERSION;
+	header.keychain = keychain;
+	header.fingerprint = schema.fingerprint();
+	header.count = words.size();
+
+	// write a temporary file and rename it, so readers never see a partial cache
+	string dir = path.substr(0, path.rfind('/'));
+	mkdir(dir.c_str(), 0700);
+	struct stat st;
+	if (stat(dir.c_str(), &st) || !S_ISDIR(st.st_mode) || !schemaCacheOwned(st))
+		return;
+	string tmpPath = path + ".XXXXXX";
+	vector<char> tmpName(tmpPath.begin(), tmpPath.end());
+	tmpName.push_back(0);
+	int fd = mkstemp(&tmpName[0]);
+	if (fd < 0)
+	{
+		secdebug("kcschema", "can't create schema cache in %s: %s", dir.c_str(), strerror(errno));
+		return;
+	}
+
+	ssize_t length = words.size() * sizeof(uint32);
+	bool ok = write(fd, &header, sizeof(header)) == sizeof(header)
+		&& write(fd, &words[0], length) == length;
+	if (close(fd))
+		ok = false;
+	if (!ok || rename(&tmpName[0], path.c_str()))
+		unlink(&tmpName[0]);
+}
+
+KeychainSchema
+KeychainSchemaImpl::schemaFor(const Db &db)
+{
+	string cachePath;
+	SchemaCacheKeychain keychain;
+	bool cacheable = schemaCachePath(db->name(), cachePath)
+		&& schemaCacheKeychain(db->name(), keychain);
+
+	bool sameKeychain = false;
+	if (cacheable)
+		if (KeychainSchemaImpl *cached = readSchemaCache(cachePath, keychain, sameKeychain))
+		{
+			KeychainSchema schema(cached);
+			if (sameKeychain)
+				return gKeychainSchemas().intern(schema);
+
+			// the keychain has been written since; is its schema the same?
+			try
+			{
+				DatabaseInfoMap attributes;
+				readAttributes(db, attributes);
+				if (attributes == cached->mDatabaseInfoMap)
+				{
+					writeSchemaCache(cachePath, keychain, *schema);
+					return gKeychainSchemas().intern(schema);
+				}
+			}
+			catch (...)
+			{
+			}
+			secdebug("kcschema", "schema cache %s is stale", cachePath.c_str());
+		}
+
+	KeychainSchema schema(new KeychainSchemaImpl(db));
+	if (cacheable)
+		writeSchemaCache(cachePath, keychain, *schema);
+	return gKeychainSchemas().intern(schema);
+}
+
+bool KeychainSchemaImpl::hasRecordType (CSSM_DB_RECORDTYPE recordType) const
+{
+	return relationFor(recordType) != NULL;
+}
+	
+bool
+KeychainSchemaImpl::hasAttribute(CSSM_DB_RECORDTYPE recordType, uint32 attributeId) const
+{
+	const RelationEntry *relation = relationFor(recordType);
+	return relation && attributeFor(*relation, attributeId);
 }
 
 CSSM_DB_ATTRIBUTE_FORMAT 
 KeychainSchemaImpl::attributeFormatFor(CSSM_DB_RECORDTYPE recordType, uint32 attributeId) const
 {
-	const RelationInfoMap &rmap = relationInfoMapFor(recordType);
-	RelationInfoMap::const_iterator rit = rmap.find(attributeId);
-	if (rit == rmap.end())
+	const RelationEntry *relation = relationFor(recordType);
+	if (!relation)
+		MacOSError::throwMe(errSecNoSuchClass);
+	const AttributeEntry *attribute = attributeFor(*relation, attributeId);
+	if (!attribute)
 		MacOSError::throwMe(errSecNoSuchAttr);
 
-	return rit->second;
+	return attribute->format;
 }
 
 CssmDbAttributeInfo
@@ -224,30 +628,24 @@ KeychainSchemaImpl::attributeInfoFor(CSSM_DB_RECORDTYPE recordType, uint32 attri
 void
 KeychainSchemaImpl::getAttributeInfoForRecordType(CSSM_DB_RECORDTYPE recordType, SecKeychainAttributeInfo **Info) const
 {
-	const RelationInfoMap &rmap = relationInfoMapFor(recordType);
+	const RelationEntry *relation = relationFor(recordType);
+	if (!relation)
+		MacOSError::throwMe(errSecNoSuchClass);
 
 	SecKeychainAttributeInfo *theList=reinterpret_cast<SecKeychainAttributeInfo *>(malloc(sizeof(SecKeychainAttributeInfo)));
 	
-	UInt32 capacity=rmap.size();
-	UInt32 *tagBuf=reinterpret_cast<UInt32 *>(malloc(capacity*sizeof(UInt32)));
-	UInt32 *formatBuf=reinterpret_cast<UInt32 *>(malloc(capacity*sizeof(UInt32)));
-	UInt32 i=0;
-	
+	UInt32 count=relation->attributeCount;
+	UInt32 *tagBuf=reinterpret_cast<UInt32 *>(malloc(count*sizeof(UInt32)));
+	UInt32 *formatBuf=reinterpret_cast<UInt32 *>(malloc(count*sizeof(UInt32)));
 	
-	for (RelationInfoMap::const_iterator rit = rmap.begin(); rit != rmap.end(); ++rit)
+	for (UInt32 i=0; i<count; i++)
 	{
-		if (i>=capacity)
-		{
-			capacity *= 2;
-			if (capacity <= i) capacity = i + 1;
-			tagBuf=reinterpret_cast<UInt32 *>(realloc(tagBuf, (capacity*sizeof(UInt32))));
-			formatBuf=reinterpret_cast<UInt32 *>(realloc(tagBuf, (capacity*sizeof(UInt32))));
-		}
-		tagBuf[i]=rit->first;
-		formatBuf[i++]=rit->second;
+		const AttributeEntry &attribute = mAttributes[relation->firstAttribute + i];
+		tagBuf[i]=attribute.attributeId;
+		formatBuf[i]=attribute.format;
 	}
 	
-	theList->count=i;
+	theList->count=count;
 	theList->tag=tagBuf;
 	theList->format=formatBuf;
 	*Info=theList;		
@@ -257,13 +655,11 @@ KeychainSchemaImpl::getAttributeInfoForRecordType(CSSM_DB_RECORDTYPE recordType,
 const CssmAutoDbRecordAttributeInfo &
 KeychainSchemaImpl::primaryKeyInfosFor(CSSM_DB_RECORDTYPE recordType) const
 {
-	PrimaryKeyInfoMap::const_iterator it;
-	it = mPrimaryKeyInfoMap.find(recordType);
-	
-	if (it == mPrimaryKeyInfoMap.end())
+	const RelationEntry *relation = relationFor(recordType);
+	if (!relation || !relation->primaryKeyInfos)
 		MacOSError::throwMe(errSecNoSuchClass); // @@@ Not really but whatever.
 
-	return *it->second;
+	return *relation->primaryKeyInfos;
 }
 
 bool
@@ -278,37 +674,179 @@ KeychainSchemaImpl::operator ==(const KeychainSchemaImpl &other) const
 	return mDatabaseInfoMap == other.mDatabaseInfoMap;
 }
 
-void
-KeychainSchemaImpl::didCreateRelation(CSSM_DB_RECORDTYPE relationID,
+KeychainSchema
+KeychainSchemaImpl::withRelation(CSSM_DB_RECORDTYPE relationID,
 	const char *inRelationName,
 	uint32 inNumberOfAttributes,
 	const CSSM_DB_SCHEMA_ATTRIBUTE_INFO *pAttributeInfo,
 	uint32 inNumberOfIndexes,
-	const CSSM_DB_SCHEMA_INDEX_INFO *pIndexInfo)
+	const CSSM_DB_SCHEMA_INDEX_INFO *pIndexInfo) const
 {
-	StLock<Mutex>_(mMutex);
-	
 	if (CSSM_DB_RECORDTYPE_SCHEMA_START <= relationID
 		&& relationID < CSSM_DB_RECORDTYPE_SCHEMA_END)
-		return;
+		return const_cast<KeychainSchemaImpl *>(this);
 
-	RelationInfoMap &rim = mDatabaseInfoMap[relationID];
+	// this schema is shared, so make a new one
+	KeychainSchema schema(new KeychainSchemaImpl());
+	schema->mDatabaseInfoMap = mDatabaseInfoMap;
+	for (PrimaryKeyInfoMap::const_iterator it = mPrimaryKeyInfoMap.begin(); it != mPrimaryKeyInfoMap.end(); ++it)
+	{
+		CssmAutoDbRecordAttributeInfo &infos = schema->newPrimaryKeyInfos(it->first);
+		for (uint32 ix = 0; ix < it->second->size(); ++ix)
+			infos.add(it->second->at(ix));
+	}
+
+	RelationInfoMap &rim = schema->mDatabaseInfoMap[relationID];
 	for (uint32 ix = 0; ix < inNumberOfAttributes; ++ix)
 		rim[pAttributeInfo[ix].AttributeId] = pAttributeInfo[ix].DataType;
 
-	CssmAutoDbRecordAttributeInfo &infos =
-		*new CssmAutoDbRecordAttributeInfo();
-	mPrimaryKeyInfoMap.
-		insert(PrimaryKeyInfoMap::value_type(relationID, &infos));
-	infos.DataRecordType = relationID;
+	CssmAutoDbRecordAttributeInfo &infos = schema->newPrimaryKeyInfos(relationID);
 	for (uint32 ix = 0; ix < inNumberOfIndexes; ++ix)
 		if (pIndexInfo[ix].IndexType == CSSM_DB_INDEX_UNIQUE)
+			addPrimaryKeyAttribute(infos, rim, pIndexInfo[ix].AttributeId);
+
+	schema->freeze();
+	return gKeychainSchemas().intern(schema);
+}
+
+
+//
+// DbItemMap
+//
+struct DbItemMap::Slot
+{
+	Slot() : item(NULL) {}
+
+	PrimaryKey key;			// NULL if the slot is empty
+	__weak ItemImpl *item;
+};
+
+DbItemMap::DbItemMap() : mSlots(NULL), mCapacity(0), mCount(0)
+{
+}
+
+DbItemMap::~DbItemMap()
+{
+	delete [] mSlots;
+}
+
+// the slot holding key, or the empty slot where it belongs
+DbItemMap::Slot *
+DbItemMap::slotFor(const PrimaryKey &key) const
+{
+	size_t mask = mCapacity - 1;
+	for (size_t ix = key->hash() & mask;; ix = (ix + 1) & mask)
+	{
+		Slot &slot = mSlots[ix];
+		if (!slot.key || slot.key->sameKey(*key))
+			return &slot;
+	}
+}
+
+// make room for another entry by rehashing, dropping entries whose items
+// have gone away.  The table only doubles if the live entries would still
+// fill more than half of it; otherwise it is compacted at the same size, so
+// churn through short-lived items doesn't keep growing it.
+void
+DbItemMap::rehash()
+{
+	Slot *oldSlots = mSlots;
+	size_t oldCapacity = mCapacity;
+
+	size_t live = 0;
+	for (size_t ix = 0; ix < oldCapacity; ++ix)
+		if (oldSlots[ix].key && oldSlots[ix].item)
+			live++;
+
+	if (oldCapacity == 0)
+		mCapacity = 16;
+	else if ((live + 1) * 2 > oldCapacity)
+		mCapacity = oldCapacity * 2;
+	mSlots = new Slot[mCapacity];
+	mCount = 0;
+	for (size_t ix = 0; ix < oldCapacity; ++ix)
+		if (oldSlots[ix].key && oldSlots[ix].item)
 		{
-			CssmDbAttributeInfo &info = infos.add();
-			info.AttributeNameFormat = CSSM_DB_ATTRIBUTE_NAME_AS_INTEGER;
-			info.Label.AttributeID = pIndexInfo[ix].AttributeId;
-			info.AttributeFormat = rim[info.Label.AttributeID];
+			*slotFor(oldSlots[ix].key) = oldSlots[ix];
+			mCount++;
 		}
+
+	delete [] oldSlots;
+}
+
+ItemImpl *
+DbItemMap::find(const PrimaryKey &key) const
+{
+	if (mCount == 0)
+		return NULL;
+
+	Slot *slot = slotFor(key);
+	return slot->key ? slot->item : NULL;
+}
+
+ItemImpl *
+DbItemMap::insert(const PrimaryKey &key, ItemImpl *item)
+{
+	if ((mCount + 1) * 4 > mCapacity * 3)
+		rehash();
+
+	Slot *slot = slotFor(key);
+	if (slot->key && slot->item)
+		return slot->item;
+
+	if (!slot->key)
+	{
+		slot->key = key;
+		mCount++;
+	}
+	slot->item = item;
+	return NULL;
+}
+
+ItemImpl *
+DbItemMap::replace(const PrimaryKey &key, ItemImpl *item)
+{
+	if ((mCount + 1) * 4 > mCapacity * 3)
+		rehash();
+
+	Slot *slot = slotFor(key);
+	if (!slot->key)
+	{
+		slot->key = key;
+		mCount++;
+	}
+	ItemImpl *oldItem = slot->item;
+	slot->item = item;
+	return oldItem;
+}
+
+void
+DbItemMap::erase(const PrimaryKey &key, ItemImpl *item)
+{
+	if (mCount == 0)
+		return;
+
+	Slot *slot = slotFor(key);
+	if (!slot->key || slot->item != item)
+		return;
+
+	// Shift later entries of the probe sequence back into the hole, so
+	// no tombstone is needed.  An entry can fill the hole if the hole lies
+	// between its home slot and where it is now.
+	size_t mask = mCapacity - 1;
+	size_t hole = slot - mSlots;
+	for (size_t ix = (hole + 1) & mask; mSlots[ix].key; ix = (ix + 1) & mask)
+	{
+		size_t home = mSlots[ix].key->hash() & mask;
+		if (((ix - home) & mask) >= ((ix - hole) & mask))
+		{
+			mSlots[hole] = mSlots[ix];
+			hole = ix;
+		}
+	}
+	mSlots[hole].key = NULL;
+	mSlots[hole].item = NULL;
+	mCount--;
 }
 
 
@@ -812,18 +1350,11 @@ void KeychainImpl::completeAdd(Item &inItem, PrimaryKey &primaryKey)
 	// The inItem shouldn't be in the cache yet
 	assert(!inItem->inCache());
 
-	// Insert inItem into mDbItemMap with key primaryKey.  p.second will be
-	// true if it got inserted. If not p.second will be false and p.first
-	// will point to the current entry with key primaryKey.
-	pair<DbItemMap::iterator, bool> p =
-		mDbItemMap.insert(DbItemMap::value_type(primaryKey, inItem.get()));
-	if (!p.second)
+	// Insert inItem into mDbItemMap with key primaryKey, replacing any
+	// ItemImpl * already there.
+	ItemImpl *oldItem = mDbItemMap.replace(primaryKey, inItem.get());
+	if (oldItem)
 	{
-		// There was already an ItemImpl * in mDbItemMap with key
-		// primaryKey.  Get a ref to the pointer to it so we can assign a
-		// new value to it below.
-		ItemImpl *oldItem = p.first->second;
-
 		// @@@ If this happens we are breaking our API contract of 
 		// uniquifying items.  We really need to insert the item into the
 		// map before we start the add.  And have the item be in an
@@ -832,7 +1363,6 @@ void KeychainImpl::completeAdd(Item &inItem, PrimaryKey &primaryKey)
 		secdebug("keychain", "add of new item %p somehow replaced %p",
 			inItem.get(), oldItem);
 		oldItem->inCache(false);
-		oldItem = inItem.get();
 	}
 
 	inItem->inCache(true);
@@ -868,22 +1398,13 @@ KeychainImpl::didUpdate(const Item &inItem, PrimaryKey &oldPK,
 		if (inItem->inCache())
 		{
 			// First remove the entry for inItem in mDbItemMap with key oldPK.
-			DbItemMap::iterator it = mDbItemMap.find(oldPK);
-			if (it != mDbItemMap.end() && (ItemImpl*) it->second == inItem.get())
-				mDbItemMap.erase(it);
-
-			// Insert inItem into mDbItemMap with key newPK.  p.second will be
-			// true if it got inserted. If not p.second will be false and
-			// p.first will point to the current entry with key newPK.
-			pair<DbItemMap::iterator, bool> p =
-				mDbItemMap.insert(DbItemMap::value_type(newPK, inItem.get()));
-			if (!p.second)
-			{
-				// There was already an ItemImpl * in mDbItemMap with key
-				// primaryKey.  Get a ref to the pointer to it so we can assign
-				// a new value to it below.
-				ItemImpl *oldItem = p.first->second;
+			mDbItemMap.erase(oldPK, inItem.get());
 
+			// Insert inItem into mDbItemMap with key newPK, replacing any
+			// ItemImpl * already there.
+			ItemImpl *oldItem = mDbItemMap.replace(newPK, inItem.get());
+			if (oldItem)
+			{
 				// @@@ If this happens we are breaking our API contract of 
 				// uniquifying items.  We really need to insert the item into
 				// the map with the new primary key before we start the update.
@@ -892,7 +1413,6 @@ KeychainImpl::didUpdate(const Item &inItem, PrimaryKey &oldPK,
 				secdebug("keychain", "update of item %p somehow replaced %p",
 					inItem.get(), oldItem);
 				oldItem->inCache(false);
-				oldItem = inItem.get();
 			}
 		}
 	}
@@ -915,6 +1435,7 @@ KeychainImpl::deleteItem(Item &inoutItem)
 		DbUniqueRecord uniqueId = inoutItem->dbUniqueRecord();
 		PrimaryKey primaryKey = inoutItem->primaryKey();
 		uniqueId->deleteRecord();
+		inoutItem->forgetCachedContent();
 
 		// Don't remove the item from the mDbItemMap here since this would cause
 		// us to report a new item to our caller when we receive the
@@ -1007,21 +1528,8 @@ void KeychainImpl::gatherPrimaryKeyAttributes(DbAttributes& primaryKeyAttrs)
 ItemImpl *
 KeychainImpl::_lookupItem(const PrimaryKey &primaryKey)
 {
-	DbItemMap::iterator it = mDbItemMap.find(primaryKey);
-	if (it != mDbItemMap.end())
-	{
-		if (it->second == NULL)
-		{
-			// we've been weak released...
-			mDbItemMap.erase(it);
-		}
-		else
-		{
-			return it->second;
-		}
-	}
-	
-	return NULL;
+	// entries whose items have been weak released read as NULL
+	return mDbItemMap.find(primaryKey);
 }
 
 Item
@@ -1104,7 +1612,7 @@ KeychainImpl::keychainSchema()
 {
 	StLock<Mutex>_(mMutex);
 	if (!mKeychainSchema)
-		mKeychainSchema = KeychainSchema(mDb);
+		mKeychainSchema = KeychainSchemaImpl::schemaFor(mDb);
 
 	return mKeychainSchema;
 }
@@ -1114,6 +1622,18 @@ void KeychainImpl::resetSchema()
 	mKeychainSchema = NULL;	// re-fetch it from db next time
 }
 
+void KeychainImpl::didCreateRelation(CSSM_DB_RECORDTYPE inRelationID,
+	const char *inRelationName,
+	uint32 inNumberOfAttributes,
+	const CSSM_DB_SCHEMA_ATTRIBUTE_INFO *pAttributeInfo,
+	uint32 inNumberOfIndexes,
+	const CSSM_DB_SCHEMA_INDEX_INFO *pIndexInfo)
+{
+	StLock<Mutex>_(mMutex);
+	mKeychainSchema = keychainSchema()->withRelation(inRelationID, inRelationName,
+		inNumberOfAttributes, pAttributeInfo, inNumberOfIndexes, pIndexInfo);
+}
+
 
 // Called from DbItemImpl's constructor (so it is only partially constructed),
 // add it to the map. 
@@ -1125,13 +1645,9 @@ KeychainImpl::addItem(const PrimaryKey &primaryKey, ItemImpl *dbItemImpl)
 	// The dbItemImpl shouldn't be in the cache yet
 	assert(!dbItemImpl->inCache());
 
-	// Insert dbItemImpl into mDbItemMap with key primaryKey.  p.second will
-	// be true if it got inserted. If not p.second will be false and p.first
-	// will point to the current entry with key primaryKey.
-	pair<DbItemMap::iterator, bool> p =
-		mDbItemMap.insert(DbItemMap::value_type(primaryKey, dbItemImpl));
-	
-	if (!p.second)
+	// Insert dbItemImpl into mDbItemMap with key primaryKey, unless there
+	// is already a live entry with that key.
+	if (mDbItemMap.insert(primaryKey, dbItemImpl))
 	{
 		// There was already an ItemImpl * in mDbItemMap with key primaryKey.
 		// There is a race condition here when being called in multiple threads
@@ -1162,9 +1678,7 @@ KeychainImpl::removeItem(const PrimaryKey &primaryKey, ItemImpl *inItemImpl)
 	if (!inItemImpl->inCache())
 		return;
 
-	DbItemMap::iterator it = mDbItemMap.find(primaryKey);
-	if (it != mDbItemMap.end() && (ItemImpl*) it->second == inItemImpl)
-		mDbItemMap.erase(it);
+	mDbItemMap.erase(primaryKey, inItemImpl);
 
 	inItemImpl->inCache(false);
 }
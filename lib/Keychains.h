@@ -34,6 +34,7 @@
 #include <Security/SecKeychain.h>
 #include <Security/SecKeychainItem.h>
 #include <memory>
+#include <vector>
 #include "SecCFTypes.h"
 #include "defaultcreds.h"
 
@@ -50,6 +51,22 @@ class Item;
 class PrimaryKey;
 class StorageManager;
 
+class KeychainSchema;
+
+//
+// The schema of a keychain: the attributes of each relation and the
+// attributes making up each relation's primary key.  Schemas are interned;
+// keychains whose schemas are the same share one KeychainSchemaImpl, which
+// is never modified once it has been built.  A schema read from a keychain
+// is also cached on disk, keyed by the identity and modification time of
+// the keychain file, so that opening the keychain again doesn't have to
+// walk its schema relations.  After the file has changed, the cache is
+// only used if the keychain's relations and their attributes still match.
+//
+// Lookups go through flat tables built when the schema is frozen: the
+// relations sorted by record type, each with a contiguous run of attributes
+// sorted by ID, searched without taking any lock.
+//
 class KeychainSchemaImpl : public RefCount
 {
 	NOCOPY(KeychainSchemaImpl)
@@ -60,6 +77,9 @@ protected:
 public:
     virtual ~KeychainSchemaImpl();
 
+	// the (shared) schema of db
+	static KeychainSchema schemaFor(const CssmClient::Db &db);
+
 	CSSM_DB_ATTRIBUTE_FORMAT attributeFormatFor(CSSM_DB_RECORDTYPE recordType, uint32 attributeId) const;
 	const CssmAutoDbRecordAttributeInfo &primaryKeyInfosFor(CSSM_DB_RECORDTYPE recordType) const;
 	
@@ -71,24 +91,59 @@ public:
 	bool hasAttribute(CSSM_DB_RECORDTYPE recordType, uint32 attributeId) const;
 	bool hasRecordType(CSSM_DB_RECORDTYPE recordType) const;
 
-	void didCreateRelation(CSSM_DB_RECORDTYPE inRelationID,
+	// this schema plus a newly created relation
+	KeychainSchema withRelation(CSSM_DB_RECORDTYPE inRelationID,
 		const char *inRelationName,
 		uint32 inNumberOfAttributes,
 		const CSSM_DB_SCHEMA_ATTRIBUTE_INFO *pAttributeInfo,
 		uint32 inNumberOfIndexes,
-		const CSSM_DB_SCHEMA_INDEX_INFO *pIndexInfo);
+		const CSSM_DB_SCHEMA_INDEX_INFO *pIndexInfo) const;
+
+	// hash of the schema's contents; equal schemas have equal fingerprints
+	uint64 fingerprint() const { return mFingerprint; }
+
+	// flat form of the schema, as fingerprinted and cached on disk
+	typedef std::vector<uint32> Encoding;
+	void encode(Encoding &encoding) const;
+	static KeychainSchemaImpl *decode(const uint32 *words, size_t count);
+	bool sameAs(const KeychainSchemaImpl &other) const;
 
 private:
+	KeychainSchemaImpl();
+	void freeze();
+
 	typedef map<CSSM_DB_RECORDTYPE, CssmAutoDbRecordAttributeInfo *> PrimaryKeyInfoMap;
 	PrimaryKeyInfoMap mPrimaryKeyInfoMap;
 
 	typedef map<uint32, CSSM_DB_ATTRIBUTE_FORMAT> RelationInfoMap;
 	typedef map<CSSM_DB_RECORDTYPE, RelationInfoMap> DatabaseInfoMap;
 	DatabaseInfoMap mDatabaseInfoMap;
-	Mutex mMutex;
+	uint64 mFingerprint;
+
+	static void readAttributes(const CssmClient::Db &db, DatabaseInfoMap &databaseInfo);
+
+	// frozen lookup tables
+	struct AttributeEntry
+	{
+		uint32 attributeId;
+		CSSM_DB_ATTRIBUTE_FORMAT format;
+	};
+	struct RelationEntry
+	{
+		CSSM_DB_RECORDTYPE recordType;
+		uint32 firstAttribute;		// index into mAttributes
+		uint32 attributeCount;
+		const CssmAutoDbRecordAttributeInfo *primaryKeyInfos;	// may be NULL
+	};
+	std::vector<RelationEntry> mRelations;
+	std::vector<AttributeEntry> mAttributes;
 
 private:
-	const RelationInfoMap &relationInfoMapFor(CSSM_DB_RECORDTYPE recordType) const;
+	const RelationEntry *relationFor(CSSM_DB_RECORDTYPE recordType) const;
+	const AttributeEntry *attributeFor(const RelationEntry &relation, uint32 attributeId) const;
+	CssmAutoDbRecordAttributeInfo &newPrimaryKeyInfos(CSSM_DB_RECORDTYPE relationID);
+	static void addPrimaryKeyAttribute(CssmAutoDbRecordAttributeInfo &infos,
+		RelationInfoMap &rim, uint32 attributeID);
 };
 
 
@@ -97,7 +152,6 @@ class KeychainSchema : public RefPointer<KeychainSchemaImpl>
 public:
     KeychainSchema() {}
     KeychainSchema(KeychainSchemaImpl *impl) : RefPointer<KeychainSchemaImpl>(impl) {}
-    KeychainSchema(const CssmClient::Db &db) : RefPointer<KeychainSchemaImpl>(new KeychainSchemaImpl(db)) {}
 
 	bool operator <(const KeychainSchema &other) const
 	{ return ptr && other.ptr ? *ptr < *other.ptr : ptr < other.ptr; }
@@ -111,6 +165,40 @@ private:
 
 class ItemImpl;
 
+//
+// The items of a keychain that have a primary key, by primary key: an
+// open-addressing hash table with linear probing, on the hash each
+// PrimaryKey carries.  Item pointers are weak references.
+//
+class DbItemMap
+{
+	NOCOPY(DbItemMap)
+public:
+	DbItemMap();
+	~DbItemMap();
+
+	// the item with key, or NULL
+	ItemImpl *find(const PrimaryKey &key) const;
+
+	// add key, unless it has a live item already; returns that item, or NULL
+	ItemImpl *insert(const PrimaryKey &key, ItemImpl *item);
+
+	// add key, replacing any current item; returns what was replaced, or NULL
+	ItemImpl *replace(const PrimaryKey &key, ItemImpl *item);
+
+	// remove key if its item is item
+	void erase(const PrimaryKey &key, ItemImpl *item);
+
+private:
+	struct Slot;
+	Slot *slotFor(const PrimaryKey &key) const;
+	void rehash();
+
+	Slot *mSlots;
+	size_t mCapacity;		// a power of 2
+	size_t mCount;
+};
+
 class KeychainImpl : public SecCFObject, private CssmClient::Db::DefaultCredentialsMaker
 {
     NOCOPY(KeychainImpl)
@@ -195,6 +283,12 @@ public:
 	static void freeAttributeInfo(SecKeychainAttributeInfo *Info);
 	KeychainSchema keychainSchema();
 	void resetSchema();
+	void didCreateRelation(CSSM_DB_RECORDTYPE inRelationID,
+		const char *inRelationName,
+		uint32 inNumberOfAttributes,
+		const CSSM_DB_SCHEMA_ATTRIBUTE_INFO *pAttributeInfo,
+		uint32 inNumberOfIndexes,
+		const CSSM_DB_SCHEMA_INDEX_INFO *pIndexInfo);
 	void didDeleteItem(ItemImpl *inItemImpl);
 	
 	void recode(const CssmData &data, const CssmData &extraData);
@@ -219,7 +313,6 @@ private:
 
 	const AccessCredentials *makeCredentials();
 
-    typedef map<PrimaryKey, __weak ItemImpl *> DbItemMap;
 	// Weak reference map of all items we know about that have a primaryKey
     DbItemMap mDbItemMap;
 	// True iff we are in the cache of keychains in StorageManager
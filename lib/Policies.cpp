@@ -26,8 +26,11 @@
 //
 #include <security_keychain/Policies.h>
 #include <security_utilities/debugging.h>
+#include <security_utilities/globalizer.h>
 #include <Security/oidsalg.h>
 #include <sys/param.h>
+#include <map>
+#include <string>
 
 /* Oids longer than this are considered invalid. */
 #define MAX_OID_SIZE				32
@@ -74,32 +77,97 @@ CFStringRef SecDERItemCopyOIDDecimalRepresentation(uint8 *oid, size_t oidLen)
 
 using namespace KeychainCore;
 
-Policy::Policy(TP supportingTp, const CssmOid &policyOid)
-    : mTp(supportingTp),
-      mOid(Allocator::standard(), policyOid),
-      mValue(Allocator::standard()),
-      mAuxValue(Allocator::standard())
+
+//
+// Policies whose values are CSSM_APPLE_TP_SSL_OPTIONS or CSSM_APPLE_TP_SMIME_OPTIONS
+//
+static bool hasSSLOptions(const CssmData &oid)
 {
-    // value is as yet unimplemented
-	secdebug("policy", "Policy() this %p", this);
+	return oid == CssmOid::overlay(CSSMOID_APPLE_TP_SSL) ||
+		oid == CssmOid::overlay(CSSMOID_APPLE_TP_EAP) ||
+		oid == CssmOid::overlay(CSSMOID_APPLE_TP_IP_SEC) ||
+		oid == CssmOid::overlay(CSSMOID_APPLE_TP_APPLEID_SHARING);
 }
 
-Policy::~Policy() throw()
+static bool hasSMIMEOptions(const CssmData &oid)
 {
-	secdebug("policy", "~Policy() this %p", this);
+	return oid == CssmOid::overlay(CSSMOID_APPLE_TP_SMIME) ||
+		oid == CssmOid::overlay(CSSMOID_APPLE_TP_ICHAT);
 }
 
-void Policy::setValue(const CssmData &value)
+
+//
+// The interned PolicyValues, by OID and content. Policies made for many
+// different hosts would grow this without end, so when it gets big it is
+// emptied; Policies keep the values they have.
+//
+struct InternedPolicyValues {
+	static const size_t maxValues = 256;
+
+	Mutex mutex;
+	std::map<std::string, RefPointer<PolicyValue> > values;
+};
+
+static ModuleNexus<InternedPolicyValues> internedPolicyValues;
+
+template <class T>
+static void appendKey(std::string &key, const T &field)
 {
-	StLock<Mutex>_(mMutex);
-    mValue = value;
-    mAuxValue.reset();
+	key.append(reinterpret_cast<const char *>(&field), sizeof(field));
+}
 
+RefPointer<PolicyValue> PolicyValue::make(const CssmOid &oid, const CssmData &value)
+{
+	// the key is what the value means: its fields and what it points to, not its bytes
+	std::string key;
+	appendKey(key, uint32(oid.length()));
+	key.append(reinterpret_cast<const char *>(oid.data()), oid.length());
+	if (value.length() == 0)
+		key += 'E';
+	else if (hasSSLOptions(oid) && value.length() >= sizeof(CSSM_APPLE_TP_SSL_OPTIONS) &&
+		((const CSSM_APPLE_TP_SSL_OPTIONS *)value.data())->Version == CSSM_APPLE_TP_SSL_OPTS_VERSION)
+	{
+		const CSSM_APPLE_TP_SSL_OPTIONS *opts = (const CSSM_APPLE_TP_SSL_OPTIONS *)value.data();
+		key += 'S';
+		appendKey(key, opts->Flags);
+		appendKey(key, opts->ServerNameLen);
+		if (opts->ServerNameLen > 0)
+			key.append(opts->ServerName, opts->ServerNameLen);
+	}
+	else if (hasSMIMEOptions(oid) && value.length() >= sizeof(CSSM_APPLE_TP_SMIME_OPTIONS) &&
+		((const CSSM_APPLE_TP_SMIME_OPTIONS *)value.data())->Version == CSSM_APPLE_TP_SMIME_OPTS_VERSION)
+	{
+		const CSSM_APPLE_TP_SMIME_OPTIONS *opts = (const CSSM_APPLE_TP_SMIME_OPTIONS *)value.data();
+		key += 'M';
+		appendKey(key, opts->IntendedUsage);
+		appendKey(key, opts->SenderEmailLen);
+		if (opts->SenderEmailLen > 0)
+			key.append(opts->SenderEmail, opts->SenderEmailLen);
+	}
+	else
+		return new PolicyValue(oid, value);		// opaque to us; not shared
+
+	InternedPolicyValues &interned = internedPolicyValues();
+	StLock<Mutex>_(interned.mutex);
+	std::map<std::string, RefPointer<PolicyValue> >::const_iterator it = interned.values.find(key);
+	if (it != interned.values.end())
+		return it->second;
+	if (interned.values.size() >= InternedPolicyValues::maxValues) {
+		secdebug("policy", "emptying %ld interned policy values", interned.values.size());
+		interned.values.clear();
+	}
+	RefPointer<PolicyValue> result = new PolicyValue(oid, value);
+	interned.values[key] = result;
+	return result;
+}
+
+PolicyValue::PolicyValue(const CssmOid &oid, const CssmData &value)
+    : mOid(Allocator::standard(), oid),
+      mValue(Allocator::standard(), value),
+      mAuxValue(Allocator::standard())
+{
     // Certain policy values may contain an embedded pointer. Ask me how I feel about that.
-    if (mOid == CSSMOID_APPLE_TP_SSL ||
-        mOid == CSSMOID_APPLE_TP_EAP ||
-        mOid == CSSMOID_APPLE_TP_IP_SEC ||
-        mOid == CSSMOID_APPLE_TP_APPLEID_SHARING)
+    if (hasSSLOptions(oid) && value.length() >= sizeof(CSSM_APPLE_TP_SSL_OPTIONS))
     {
         CSSM_APPLE_TP_SSL_OPTIONS *opts = (CSSM_APPLE_TP_SSL_OPTIONS *)value.data();
         if (opts->Version == CSSM_APPLE_TP_SSL_OPTS_VERSION)
@@ -119,8 +187,7 @@ void Policy::setValue(const CssmData &value)
 			}
 		}
     }
-    else if (mOid == CSSMOID_APPLE_TP_SMIME ||
-             mOid == CSSMOID_APPLE_TP_ICHAT)
+    else if (hasSMIMEOptions(oid) && value.length() >= sizeof(CSSM_APPLE_TP_SMIME_OPTIONS))
     {
         CSSM_APPLE_TP_SMIME_OPTIONS *opts = (CSSM_APPLE_TP_SMIME_OPTIONS *)value.data();
         if (opts->Version == CSSM_APPLE_TP_SMIME_OPTS_VERSION)
@@ -140,15 +207,34 @@ void Policy::setValue(const CssmData &value)
 			}
 		}
     }
+	mField = CssmField(mOid.get(), mValue.get());
+}
+
+
+Policy::Policy(TP supportingTp, const CssmOid &policyOid)
+    : mTp(supportingTp),
+      mValue(PolicyValue::make(policyOid, CssmData()))
+{
+    // value is as yet unimplemented
+	secdebug("policy", "Policy() this %p", this);
+}
+
+Policy::~Policy() throw()
+{
+	secdebug("policy", "~Policy() this %p", this);
+}
+
+void Policy::setValue(const CssmData &value)
+{
+	RefPointer<PolicyValue> newValue = PolicyValue::make(oid(), value);
+	StLock<Mutex>_(mMutex);
+	mValue = newValue;
 }
 
 void Policy::setProperties(CFDictionaryRef properties)
 {
 	// Set the policy value based on the provided dictionary keys.
-	if (mOid == CSSMOID_APPLE_TP_SSL ||
-        mOid == CSSMOID_APPLE_TP_EAP ||
-        mOid == CSSMOID_APPLE_TP_IP_SEC ||
-		mOid == CSSMOID_APPLE_TP_APPLEID_SHARING)
+	if (hasSSLOptions(oid()))
     {
 		CSSM_APPLE_TP_SSL_OPTIONS options = { CSSM_APPLE_TP_SSL_OPTS_VERSION, 0, NULL, 0 };
 		char *buf = NULL;
@@ -172,8 +258,7 @@ void Policy::setProperties(CFDictionaryRef properties)
 
 		if (buf) free(buf);
 	}
-    else if (mOid == CSSMOID_APPLE_TP_SMIME ||
-             mOid == CSSMOID_APPLE_TP_ICHAT)
+    else if (hasSMIMEOptions(oid()))
     {
 		CSSM_APPLE_TP_SMIME_OPTIONS options = { CSSM_APPLE_TP_SMIME_OPTS_VERSION, 0, 0, NULL };
 		char *buf = NULL;
@@ -227,23 +312,30 @@ void Policy::setProperties(CFDictionaryRef properties)
 CFDictionaryRef Policy::properties()
 {
 	// Builds and returns a dictionary which the caller must release.
-	CSSM_DATA value = this->value();
+	RefPointer<PolicyValue> current;
+	{
+		StLock<Mutex>_(mMutex);
+		current = mValue;
+	}
+	const CssmData &oid = current->oid();
+	const CssmData &value = current->value();
+	const CssmData &auxValue = current->auxValue();
 	CFMutableDictionaryRef properties = CFDictionaryCreateMutable(NULL, 0,
 		&kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
 	if (!properties) return NULL;
 	
 	// kSecPolicyOid
-	CFStringRef oidStr = SecDERItemCopyOIDDecimalRepresentation((uint8*)mOid.data(), mOid.length());
+	CFStringRef oidStr = SecDERItemCopyOIDDecimalRepresentation((uint8*)oid.data(), oid.length());
 	if (oidStr) {
 		CFDictionarySetValue(properties, (const void *)kSecPolicyOid, (const void *)oidStr);
 		CFRelease(oidStr);
 	}
 	
 	// kSecPolicyName
-    if (mAuxValue) {
+    if (auxValue.length()) {
 		CFStringRef nameStr = CFStringCreateWithBytes(NULL,
-			(const UInt8 *)reinterpret_cast<char*>(mAuxValue.data()),
-			(CFIndex)mAuxValue.length(), kCFStringEncodingUTF8, false);
+			(const UInt8 *)reinterpret_cast<char*>(auxValue.data()),
+			(CFIndex)auxValue.length(), kCFStringEncodingUTF8, false);
 		if (nameStr) {
 			CFDictionarySetValue(properties, (const void *)kSecPolicyName, (const void *)nameStr);
 			CFRelease(nameStr);
@@ -251,13 +343,10 @@ CFDictionaryRef Policy::properties()
 	}
 	
 	// kSecPolicyClient
-	if (mValue) {
-		if (mOid == CSSMOID_APPLE_TP_SSL ||
-			mOid == CSSMOID_APPLE_TP_EAP ||
-			mOid == CSSMOID_APPLE_TP_IP_SEC ||
-			mOid == CSSMOID_APPLE_TP_APPLEID_SHARING)
+	if (value.length() >= sizeof(CSSM_APPLE_TP_SSL_OPTIONS)) {
+		if (hasSSLOptions(oid))
 		{
-			CSSM_APPLE_TP_SSL_OPTIONS *opts = (CSSM_APPLE_TP_SSL_OPTIONS *)mValue.data();
+			CSSM_APPLE_TP_SSL_OPTIONS *opts = (CSSM_APPLE_TP_SSL_OPTIONS *)value.data();
 			if (opts->Flags & CSSM_APPLE_TP_SSL_CLIENT) {
 				CFDictionarySetValue(properties, (const void *)kSecPolicyClient, (const void *)kCFBooleanTrue);
 			}
@@ -265,11 +354,10 @@ CFDictionaryRef Policy::properties()
 	}
 	
 	// key usage flags (currently only for S/MIME and iChat policies)
-	if (mValue) {
-		if (mOid == CSSMOID_APPLE_TP_SMIME ||
-			mOid == CSSMOID_APPLE_TP_ICHAT)
+	if (value.length() >= sizeof(CSSM_APPLE_TP_SMIME_OPTIONS)) {
+		if (hasSMIMEOptions(oid))
 		{
-			CSSM_APPLE_TP_SMIME_OPTIONS *opts = (CSSM_APPLE_TP_SMIME_OPTIONS *)mValue.data();
+			CSSM_APPLE_TP_SMIME_OPTIONS *opts = (CSSM_APPLE_TP_SMIME_OPTIONS *)value.data();
 			CE_KeyUsage usage = opts->IntendedUsage;
 			if (usage & CE_KU_DigitalSignature)
 				CFDictionarySetValue(properties, (const void *)kSecPolicyKU_DigitalSignature, (const void *)kCFBooleanTrue);
@@ -30,8 +30,10 @@
 
 #include <Security/SecPolicy.h>
 #include <security_cdsa_utilities/cssmdata.h>
+#include <security_cdsa_utilities/cssmcert.h>
 #include <security_cdsa_client/tpclient.h>
 #include <security_utilities/seccfobject.h>
+#include <security_utilities/refcount.h>
 #include "SecCFTypes.h"
 
 namespace Security
@@ -42,6 +44,35 @@ namespace KeychainCore
 
 using namespace CssmClient;
 
+//
+// The immutable part of a Policy: its OID and value, a copy of whatever
+// the value points to, and the CssmField form of the two handed to the TP.
+// Values of the option structures we know (SSL, S/MIME, and none) are
+// interned by OID and content, so that all the policies made alike -- one
+// per SSL connection to the same host, say -- share one PolicyValue.
+// Setting a Policy's value just switches it to another.
+//
+class PolicyValue : public RefCount
+{
+	NOCOPY(PolicyValue)
+public:
+	static RefPointer<PolicyValue> make(const CssmOid &oid, const CssmData &value);
+
+    const CssmOid &oid() const			{ return mOid; }
+    const CssmData &value() const		{ return mValue; }
+    const CssmData &auxValue() const	{ return mAuxValue; }
+	const CssmField &field() const		{ return mField; }
+
+private:
+	PolicyValue(const CssmOid &oid, const CssmData &value);
+
+    CssmAutoData		mOid;			// OID for this policy
+    CssmAutoData		mValue;			// value for this policy
+    CssmAutoData		mAuxValue;		// variable-length value data for this policy
+	CssmField			mField;			// mOid and mValue
+};
+
+
 //
 // A Policy[Impl] represents a particular
 // CSSM "policy" managed by a particular TP.
@@ -59,9 +90,9 @@ public:
     
     TP &tp()							{ return mTp; }
     const TP &tp() const				{ return mTp; }
-    const CssmOid &oid() const			{ return mOid; }
-    const CssmData &value() const		{ return mValue; }
-	CssmOwnedData &value()				{ return mValue; }
+    const CssmOid &oid() const			{ return mValue->oid(); }
+    const CssmData &value() const		{ return mValue->value(); }
+	const CssmField &field() const		{ return mValue->field(); }
 	
     void setValue(const CssmData &value);
 	void setProperties(CFDictionaryRef properties);
@@ -74,9 +105,7 @@ public:
 
 private:
     TP					mTp;			// TP module for this Policy
-    CssmAutoData		mOid;			// OID for this policy
-    CssmAutoData		mValue;			// value for this policy
-    CssmAutoData		mAuxValue;		// variable-length value data for this policy
+	RefPointer<PolicyValue> mValue;		// OID and value for this policy
 	Mutex				mMutex;
 };
 
@@ -28,6 +28,7 @@
 #include <security_keychain/Policies.h>
 #include <Security/oidsalg.h>
 #include <security_cdsa_client/tpclient.h>
+#include <security_utilities/errors.h>
 
 using namespace KeychainCore;
 using namespace CssmClient;
@@ -106,3 +107,16 @@ bool PolicyCursor::next(SecPointer<Policy> &policy)
     }
     return false;	// end of table, no more matches
 }
+
+
+//
+// Make the policy with the given OID directly, as the first next() of a
+// cursor searching for it would, without creating the cursor
+//
+SecPointer<Policy> PolicyCursor::policy(const CssmOid &oid)
+{
+    for (int pos = 0; theOidList[pos]; pos++)
+        if (oid == *theOidList[pos])
+            return new Policy(theOneTP(), *theOidList[pos]);
+    MacOSError::throwMe(errSecPolicyNotFound);
+}
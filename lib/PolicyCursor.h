@@ -52,6 +52,9 @@ public:
 	virtual ~PolicyCursor() throw();
 	bool next(SecPointer<Policy> &policy);
 
+	// the supported policy with the given OID, made without a search
+	static SecPointer<Policy> policy(const CssmOid &oid);
+
 private:
     //CFArrayRef	 mKeychainSearchList;
     //SecKeyUsage  mKeyUsage;
@@ -27,32 +27,76 @@
 //
 
 #include "PrimaryKey.h"
+#include <new>
 
 using namespace KeychainCore;
 using namespace CssmClient;
 
 
+PrimaryKeyImpl *
+PrimaryKeyImpl::make(const CSSM_DATA &data)
+{
+	void *p = ::operator new(sizeof(PrimaryKeyImpl) + data.Length);
+	try
+	{
+		return new (p) PrimaryKeyImpl(data);
+	}
+	catch (...)
+	{
+		::operator delete(p);
+		throw;
+	}
+}
+
+PrimaryKeyImpl *
+PrimaryKeyImpl::make(const DbAttributes &primaryKeyAttrs)
+{
+	size_t length = lengthFor(primaryKeyAttrs);
+	void *p = ::operator new(sizeof(PrimaryKeyImpl) + length);
+	try
+	{
+		return new (p) PrimaryKeyImpl(primaryKeyAttrs, length);
+	}
+	catch (...)
+	{
+		::operator delete(p);
+		throw;
+	}
+}
+
 PrimaryKeyImpl::PrimaryKeyImpl(const CSSM_DATA &data)
-: CssmDataContainer(data.Data, data.Length), mMutex(Mutex::recursive)
 {
 
 //@@@ do bounds checking here, throw if invalid
 
+	Length = data.Length;
+	Data = NULL;			// as for an item that isn't in a keychain
+	if (Length)
+	{
+		Data = reinterpret_cast<uint8 *>(this + 1);
+		memcpy(Data, data.Data, Length);
+	}
+	computeHash();
 }
 
-PrimaryKeyImpl::PrimaryKeyImpl(const DbAttributes &primaryKeyAttrs) : mMutex(Mutex::recursive)
+size_t
+PrimaryKeyImpl::lengthFor(const DbAttributes &primaryKeyAttrs)
 {
-	Length = sizeof(uint32);
+	size_t length = sizeof(uint32);
 	for (uint32 ix = 0; ix < primaryKeyAttrs.size(); ++ix)
 	{
 		if (primaryKeyAttrs.at(ix).size() == 0)
 			MacOSError::throwMe(errSecInvalidKeychain);
 
-		Length += sizeof(uint32) + primaryKeyAttrs.at(ix).Value[0].Length;
+		length += sizeof(uint32) + primaryKeyAttrs.at(ix).Value[0].Length;
 	}
+	return length;
+}
 
-	// Careful with exceptions
-	Data = mAllocator.alloc<uint8>(Length);
+PrimaryKeyImpl::PrimaryKeyImpl(const DbAttributes &primaryKeyAttrs, size_t length)
+{
+	Length = length;
+	Data = reinterpret_cast<uint8 *>(this + 1);
 	uint8 *p = Data;
 
 	putUInt32(p, primaryKeyAttrs.recordType());
@@ -63,12 +107,26 @@ PrimaryKeyImpl::PrimaryKeyImpl(const DbAttributes &primaryKeyAttrs) : mMutex(Mut
 		memcpy(p, primaryKeyAttrs.at(ix).Value[0].Data, len);
 		p += len;
 	}
+	computeHash();
+}
+
+PrimaryKeyImpl::~PrimaryKeyImpl()
+{
+}
+
+// 64 bit FNV-1a
+void
+PrimaryKeyImpl::computeHash()
+{
+	uint64 hash = 14695981039346656037ULL;
+	for (size_t ix = 0; ix < Length; ++ix)
+		hash = (hash ^ Data[ix]) * 1099511628211ULL;
+	mHash = hash;
 }
 
 CssmClient::DbCursor
 PrimaryKeyImpl::createCursor(const Keychain &keychain) 
 {
-	StLock<Mutex>_(mMutex);
 	DbCursor cursor(keychain->database());
 
 	// @@@ Set up cursor to find item with this.
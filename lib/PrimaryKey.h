@@ -37,12 +37,23 @@ namespace Security
 namespace KeychainCore
 {
 
-class PrimaryKeyImpl : public CssmDataContainer
+//
+// A primary key is the record type followed by the length and value of each
+// primary key attribute, as one blob.  Keys are immutable, so they need no
+// lock; they carry a hash of their contents for DbItemMap.  The blob follows
+// the object in the same allocation, sized for it, so make() is the only
+// way to create one.
+//
+class PrimaryKeyImpl : public CssmData, public RefCount
 {
+	NOCOPY(PrimaryKeyImpl)
 public:
-    PrimaryKeyImpl(const CSSM_DATA &data);
-    PrimaryKeyImpl(const CssmClient::DbAttributes &primaryKeyAttrs);
-    ~PrimaryKeyImpl() {}
+	static PrimaryKeyImpl *make(const CSSM_DATA &data);
+	static PrimaryKeyImpl *make(const CssmClient::DbAttributes &primaryKeyAttrs);
+    ~PrimaryKeyImpl();
+
+	// pairs with the ::operator new in make()
+	static void operator delete(void *p) { ::operator delete(p); }
 
 	void putUInt32(uint8 *&p, uint32 value);
 	uint32 getUInt32(uint8 *&p, uint32 &left) const;
@@ -50,10 +61,19 @@ public:
 	CssmClient::DbCursor createCursor(const Keychain &keychain);
 
 	CSSM_DB_RECORDTYPE recordType() const;
+
+	uint64 hash() const { return mHash; }
+	bool sameKey(const PrimaryKeyImpl &other) const
+	{ return mHash == other.mHash && Length == other.Length && !memcmp(Data, other.Data, Length); }
+
 private:
+    PrimaryKeyImpl(const CSSM_DATA &data);
+    PrimaryKeyImpl(const CssmClient::DbAttributes &primaryKeyAttrs, size_t length);
+
+	static size_t lengthFor(const CssmClient::DbAttributes &primaryKeyAttrs);
+	void computeHash();
 
-protected:
-	Mutex mMutex;
+	uint64 mHash;
 };
 
 
@@ -63,9 +83,9 @@ public:
     PrimaryKey() {}
     PrimaryKey(PrimaryKeyImpl *impl) : RefPointer<PrimaryKeyImpl>(impl) {}
     PrimaryKey(const CSSM_DATA &data)
-	: RefPointer<PrimaryKeyImpl>(new PrimaryKeyImpl(data)) {}
+	: RefPointer<PrimaryKeyImpl>(PrimaryKeyImpl::make(data)) {}
     PrimaryKey(const CssmClient::DbAttributes &primaryKeyAttrs)
-	: RefPointer<PrimaryKeyImpl>(new PrimaryKeyImpl(primaryKeyAttrs)) {}
+	: RefPointer<PrimaryKeyImpl>(PrimaryKeyImpl::make(primaryKeyAttrs)) {}
 };
 
 } // end namespace KeychainCore
@@ -749,6 +749,13 @@ CFDictionaryRef SecCertificateCopyValues(SecCertificateRef certificate, CFArrayR
     return result;
 }
 
+OSStatus SecCertificateCacheSetBudget(UInt64 bytes)
+{
+	BEGIN_SECAPI
+		Certificate::setValueCacheBudget(bytes);
+	END_SECAPI
+}
+
 CFStringRef SecCertificateCopyLongDescription(CFAllocatorRef alloc, SecCertificateRef certificate, CFErrorRef *error)
 {
 	return SecCertificateCopyShortDescription(alloc, certificate, error);
@@ -797,8 +804,7 @@ CFDataRef SecCertificateCopyNormalizedIssuerContent(SecCertificateRef certificat
     OSStatus __secapiresult;
 	try
 	{
-		CertificateValues cv(certificate);
-		result = cv.getNormalizedIssuerContent(error);
+		result = Certificate::required(certificate)->copyNormalizedIssuerContent(error);
 		__secapiresult=0;
 	} 
 	catch (const MacOSError &err) { __secapiresult=err.osStatus(); }
@@ -814,8 +820,7 @@ CFDataRef SecCertificateCopyNormalizedSubjectContent(SecCertificateRef certifica
     OSStatus __secapiresult;
 	try
 	{
-		CertificateValues cv(certificate);
-		result = cv.getNormalizedSubjectContent(error);
+		result = Certificate::required(certificate)->copyNormalizedSubjectContent(error);
 		__secapiresult=0;
 	} 
 	catch (const MacOSError &err) { __secapiresult=err.osStatus(); }
@@ -42,6 +42,8 @@
 #include <libDER/libDER.h>
 #include <libDER/DER_CertCrl.h>
 #include <libDER/DER_Encode.h>
+#include <libDER/DER_Generated.h>
+#include <libDER/DER_OidTable.h>
 #include <libDER/DER_Keys.h>
 #include <libDER/asn1Types.h>
 #include <libDER/oids.h>
@@ -56,6 +58,7 @@
 #include "debuggingP.h"
 #include <stdlib.h>
 #include <libkern/OSByteOrder.h>
+#include <libkern/OSAtomic.h>
 #include <ctype.h>
 #include "SecInternalP.h"
 #include "SecBase64P.h"
@@ -211,9 +214,14 @@ typedef void (*SecCertificateExtensionParser)(SecCertificateRefP certificate,
 static pthread_once_t kSecCertificateRegisterClass = PTHREAD_ONCE_INIT;
 static CFTypeID kSecCertificateTypeID = _kCFRuntimeNotATypeID;
 
-/* Mapping from extension OIDs (as a DERItem *) to
-   SecCertificateExtensionParser extension parsing routines. */
-static CFDictionaryRef gExtensionParsers;
+/* Mapping from extension OIDs (as a DEROidID) to
+   SecCertificateExtensionParser extension parsing routines; filled in
+   by SecCertificateRegisterClass(). */
+static SecCertificateExtensionParser gExtensionParsers[DOID_Count];
+
+/* Interned decimal representations of the OIDs in DER_OidTable.h, created
+   on demand by SecDERItemCopyOIDDecimalRepresentation(). */
+static CFStringRef gOidDecimalStrings[DOID_Count];
 
 /* Forward declartions of static functions. */
 static CFStringRef SecCertificateDescribe(CFTypeRef cf);
@@ -1025,33 +1033,6 @@ static void SecCEPEntrustVersInfo(SecCertificateRefP certificate,
 	secdebug("cert", "critical: %s", extn->critical ? "yes" : "no");
 }
 
-/* Dictionary key callback for comparing to DERItems. */
-static Boolean SecDERItemEqual(const void *value1, const void *value2) {
-	return DEROidCompare((const DERItem *)value1, (const DERItem *)value2);
-}
-
-/* Dictionary key callback calculating the hash of a DERItem. */
-static CFHashCode SecDERItemHash(const void *value) {
-	const DERItem *derItem = (const DERItem *)value;
-	CFHashCode hash = derItem->length;
-	DERSize ix = derItem->length > 8 ? derItem->length - 8 : 0;
-	for (; ix < derItem->length; ++ix) {
-		hash = (hash << 9) + (hash >> 23) + derItem->data[ix];
-	}
-
-	return hash;
-}
-
-/* Dictionary key callbacks using the above 2 functions. */
-static const CFDictionaryKeyCallBacks SecDERItemKeyCallBacks = {
-	0,					/* version */
-	NULL,				/* retain */
-	NULL,				/* release */
-	NULL,				/* copyDescription */
-	SecDERItemEqual,	/* equal */
-	SecDERItemHash		/* hash */
-};
-
 static void SecCertificateRegisterClass(void) {
 	static const CFRuntimeClass kSecCertificateClass = {
 		0,												/* version */
@@ -1067,28 +1048,28 @@ static void SecCertificateRegisterClass(void) {
 
     kSecCertificateTypeID = _CFRuntimeRegisterClass(&kSecCertificateClass);
 
-	/* Build a dictionary that maps from extension OIDs to callback functions
+	/* Build a table that maps from extension OIDs to callback functions
 	   which can parse the extension of the type given. */
-	static const void *extnOIDs[] = {
-		&oidSubjectKeyIdentifier,
-		&oidKeyUsage,
-		&oidPrivateKeyUsagePeriod,
-		&oidSubjectAltName,
-		&oidIssuerAltName,
-		&oidBasicConstraints,
-		&oidCrlDistributionPoints,
-		&oidCertificatePolicies,
-		&oidPolicyMappings,
-		&oidAuthorityKeyIdentifier,
-		&oidPolicyConstraints,
-		&oidExtendedKeyUsage,
-		&oidInhibitAnyPolicy,
-		&oidAuthorityInfoAccess,
-		&oidSubjectInfoAccess,
-		&oidNetscapeCertType,
-		&oidEntrustVersInfo
+	static const DEROidID extnOIDs[] = {
+		DOID_SubjectKeyIdentifier,
+		DOID_KeyUsage,
+		DOID_PrivateKeyUsagePeriod,
+		DOID_SubjectAltName,
+		DOID_IssuerAltName,
+		DOID_BasicConstraints,
+		DOID_CrlDistributionPoints,
+		DOID_CertificatePolicies,
+		DOID_PolicyMappings,
+		DOID_AuthorityKeyIdentifier,
+		DOID_PolicyConstraints,
+		DOID_ExtendedKeyUsage,
+		DOID_InhibitAnyPolicy,
+		DOID_AuthorityInfoAccess,
+		DOID_SubjectInfoAccess,
+		DOID_NetscapeCertType,
+		DOID_EntrustVersInfo
 	};
-	static const void *extnParsers[] = {
+	static const SecCertificateExtensionParser extnParsers[] = {
 		SecCEPSubjectKeyIdentifier,
 		SecCEPKeyUsage,
 		SecCEPPrivateKeyUsagePeriod,
@@ -1107,9 +1088,9 @@ static void SecCertificateRegisterClass(void) {
 		SecCEPNetscapeCertType,
 		SecCEPEntrustVersInfo
 	};
-	gExtensionParsers = CFDictionaryCreate(kCFAllocatorDefault, extnOIDs,
-		extnParsers, sizeof(extnOIDs) / sizeof(*extnOIDs),
-		&SecDERItemKeyCallBacks, NULL);
+	size_t ix;
+	for (ix = 0; ix < sizeof(extnOIDs) / sizeof(*extnOIDs); ++ix)
+		gExtensionParsers[extnOIDs[ix]] = extnParsers[ix];
 }
 
 /* Given the contents of an X.501 Name return the contents of a normalized
@@ -1323,8 +1304,7 @@ static bool SecCertificateParse(SecCertificateRefP certificate)
 
 	/* top level decode */
 	DERSignedCertCrl signedCert;
-	drtn = DERParseSequence(&certificate->_der, DERNumSignedCertCrlItemSpecs,
-		DERSignedCertCrlItemSpecs, &signedCert,
+	drtn = DERParseSignedCertCrl(&certificate->_der, &signedCert,
 		sizeof(signedCert));
 	require_noerr_quiet(drtn, badCert);
 	/* Store tbs since we need to digest it for verification later on. */
@@ -1332,16 +1312,13 @@ static bool SecCertificateParse(SecCertificateRefP certificate)
 
 	/* decode the TBSCert - it was saved in full DER form */
     DERTBSCert tbsCert;
-	drtn = DERParseSequence(&signedCert.tbs,
-		DERNumTBSCertItemSpecs, DERTBSCertItemSpecs,
-		&tbsCert, sizeof(tbsCert));
+	drtn = DERParseTBSCert(&signedCert.tbs, &tbsCert, sizeof(tbsCert));
 	require_noerr_quiet(drtn, badCert);
 
 	/* sequence we're given: decode the signedCerts Signature Algorithm. */
 	/* This MUST be the same as the certificate->_tbsSigAlg with the exception
 	   of the params field. */
-	drtn = DERParseSequenceContent(&signedCert.sigAlg,
-		DERNumAlgorithmIdItemSpecs, DERAlgorithmIdItemSpecs,
+	drtn = DERParseAlgorithmIdContent(&signedCert.sigAlg,
 		&certificate->_sigAlg, sizeof(certificate->_sigAlg));
 	require_noerr_quiet(drtn, badCert);
 
@@ -1375,8 +1352,7 @@ static bool SecCertificateParse(SecCertificateRefP certificate)
 		tbsCert.serialNum.data, tbsCert.serialNum.length);
 
 	/* sequence we're given: decode the tbsCerts TBS Signature Algorithm. */
-	drtn = DERParseSequenceContent(&tbsCert.tbsSigAlg,
-		DERNumAlgorithmIdItemSpecs, DERAlgorithmIdItemSpecs,
+	drtn = DERParseAlgorithmIdContent(&tbsCert.tbsSigAlg,
 		&certificate->_tbsSigAlg, sizeof(certificate->_tbsSigAlg));
 	require_noerr_quiet(drtn, badCert);
 
@@ -1388,8 +1364,7 @@ static bool SecCertificateParse(SecCertificateRefP certificate)
 
 	/* sequence we're given: decode the tbsCerts Validity sequence. */
     DERValidity validity;
-	drtn = DERParseSequenceContent(&tbsCert.validity,
-		DERNumValidityItemSpecs, DERValidityItemSpecs,
+	drtn = DERParseValidityContent(&tbsCert.validity,
 		&validity, sizeof(validity));
 	require_noerr_quiet(drtn, badCert);
     require_quiet(derDateGetAbsoluteTime(&validity.notBefore,
@@ -1405,14 +1380,12 @@ static bool SecCertificateParse(SecCertificateRefP certificate)
 
 	/* sequence we're given: encoded DERSubjPubKeyInfo */
 	DERSubjPubKeyInfo pubKeyInfo;
-	drtn = DERParseSequenceContent(&tbsCert.subjectPubKey,
-		DERNumSubjPubKeyInfoItemSpecs, DERSubjPubKeyInfoItemSpecs,
+	drtn = DERParseSubjPubKeyInfoContent(&tbsCert.subjectPubKey,
 		&pubKeyInfo, sizeof(pubKeyInfo));
 	require_noerr_quiet(drtn, badCert);
 
 	/* sequence we're given: decode the pubKeyInfos DERAlgorithmId */
-	drtn = DERParseSequenceContent(&pubKeyInfo.algId,
-		DERNumAlgorithmIdItemSpecs, DERAlgorithmIdItemSpecs,
+	drtn = DERParseAlgorithmIdContent(&pubKeyInfo.algId,
 		&certificate->_algId, sizeof(certificate->_algId));
 	require_noerr_quiet(drtn, badCert);
 
@@ -1487,8 +1460,7 @@ static bool SecCertificateParse(SecCertificateRefP certificate)
                 (ix == extensionCount - 1 && drtn == DR_EndOfSequence), badCert);
             require_quiet(currDecoded.tag == ASN1_CONSTR_SEQUENCE, badCert);
             DERExtension extn;
-            drtn = DERParseSequenceContent(&currDecoded.content,
-                DERNumExtensionItemSpecs, DERExtensionItemSpecs,
+            drtn = DERParseExtensionContent(&currDecoded.content,
                 &extn, sizeof(extn));
             require_noerr_quiet(drtn, badCert);
             /* Copy stuff into certificate->extensions[ix]. */
@@ -1497,9 +1469,8 @@ static bool SecCertificateParse(SecCertificateRefP certificate)
                 &certificate->_extensions[ix].critical), badCert);
             certificate->_extensions[ix].extnValue = extn.extnValue;
 
-			SecCertificateExtensionParser parser =
-				(SecCertificateExtensionParser)CFDictionaryGetValue(
-				gExtensionParsers, &certificate->_extensions[ix].extnID);
+			SecCertificateExtensionParser parser = gExtensionParsers[
+				DEROidLookup(&certificate->_extensions[ix].extnID)];
 			if (parser) {
 				/* Invoke the parser. */
 				parser(certificate, &certificate->_extensions[ix]);
@@ -1641,6 +1612,23 @@ CFStringRef SecDERItemCopyOIDDecimalRepresentation(CFAllocatorRef allocator,
             CFSTR("SecCertificate"));
     }
 
+    /* Known OIDs have a precomputed representation; intern it. */
+    DEROidID oidID = DEROidLookup(oid);
+    if (oidID != DOID_Unknown) {
+        CFStringRef str = gOidDecimalStrings[oidID];
+        if (!str) {
+            str = CFStringCreateWithCStringNoCopy(kCFAllocatorDefault,
+                DEROidStrings[oidID], kCFStringEncodingASCII, kCFAllocatorNull);
+            if (!OSAtomicCompareAndSwapPtrBarrier(NULL, (void *)str,
+                (void * volatile *)&gOidDecimalStrings[oidID])) {
+                /* Another thread beat us to it. */
+                CFRelease(str);
+                str = gOidDecimalStrings[oidID];
+            }
+        }
+        return CFRetain(str);
+    }
+
     CFMutableStringRef result = CFStringCreateMutable(allocator, 0);
 
 	// The first two levels are encoded into one byte, since the root level
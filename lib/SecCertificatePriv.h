@@ -162,6 +162,17 @@ OSStatus SecCertificateIsSelfSigned(
 	SecCertificateRef certRef,
 	Boolean *isSelfSigned);		/* RETURNED */
 
+/*!
+	@function SecCertificateCacheSetBudget
+	@abstract Sets how much memory may be used to cache values derived from certificates in this
+			  process: inferred labels and subject summaries, subject name components, email
+			  addresses and normalized names. The values of the least recently used certificates
+			  are dropped, and derived again when needed, to stay within the budget.
+	@param bytes The budget in bytes; 0 disables the cache.
+    @result A result code.  See "Security Error Codes" (SecBase.h).
+*/
+OSStatus SecCertificateCacheSetBudget(UInt64 bytes);
+
 
 #if defined(__cplusplus)
 }
@@ -23,6 +23,7 @@
 
 #include "SecBridge.h"
 #include <security_utilities/cfutilities.h>
+#include <security_utilities/globalizer.h>
 #include <CoreFoundation/CoreFoundation.h>
 #include <Security/SecKeychainItem.h>
 #include <Security/SecCertificate.h>
@@ -31,15 +32,99 @@
 #include "SecItem.h"
 #include "SecItemPriv.h"
 #include "SecIdentitySearchPriv.h"
+#include "SecKeychainSearchPriv.h"
 #include "SecCertificatePriv.h"
 #include "SecCertificatePrivP.h"
 
 #include <AssertMacros.h>
+#include <vector>
 
 #define CFDataGetBytePtrVoid CFDataGetBytePtr
 
 #pragma mark SecItem private utility functions
 
+/******************************************************************************/
+
+/*
+ * AttributeLookup maps the kSecAttr constants in one of the tables below to
+ * their index in the table. Callers nearly always pass the constants
+ * themselves, so a key is first looked up by pointer; anything else, such as
+ * an equal string read from a property list, is then looked up by CFHash and
+ * compared with CFEqual.
+ */
+class AttributeLookup
+{
+public:
+	template <class Entry>
+	void build(const Entry *entries, int count, const CFTypeRef *Entry::*key);
+
+	// index of the entry whose key is equal to key, or -1
+	int find(CFTypeRef key) const;
+
+private:
+	struct Slot {
+		CFTypeRef key;			// NULL if empty
+		CFHashCode hash;
+		int index;
+	};
+
+	static size_t pointerHash(CFTypeRef key)
+	{ uintptr_t bits = (uintptr_t)key; return (bits >> 4) ^ (bits >> 13); }
+
+	std::vector<Slot> mByPointer;
+	std::vector<Slot> mByHash;
+	size_t mMask;
+};
+
+template <class Entry>
+void
+AttributeLookup::build(const Entry *entries, int count, const CFTypeRef *Entry::*key)
+{
+	size_t size = 8;
+	while (size < 2 * (size_t)count)
+		size *= 2;
+	mMask = size - 1;
+	Slot empty = { NULL, 0, -1 };
+	mByPointer.assign(size, empty);
+	mByHash.assign(size, empty);
+
+	for (int index = 0; index < count; ++index) {
+		CFTypeRef value = *(entries[index].*key);
+		if (value == NULL || find(value) >= 0)
+			continue;	// first entry wins, as in a linear scan
+		size_t ix;
+		for (ix = pointerHash(value) & mMask; mByPointer[ix].key; ix = (ix + 1) & mMask)
+			;
+		mByPointer[ix].key = value;
+		mByPointer[ix].index = index;
+		CFHashCode hash = CFHash(value);
+		for (ix = hash & mMask; mByHash[ix].key; ix = (ix + 1) & mMask)
+			;
+		mByHash[ix].key = value;
+		mByHash[ix].hash = hash;
+		mByHash[ix].index = index;
+	}
+}
+
+int
+AttributeLookup::find(CFTypeRef key) const
+{
+	if (key == NULL || mByPointer.empty())
+		return -1;
+
+	size_t ix;
+	for (ix = pointerHash(key) & mMask; mByPointer[ix].key; ix = (ix + 1) & mMask)
+		if (mByPointer[ix].key == key)
+			return mByPointer[ix].index;
+
+	CFHashCode hash = CFHash(key);
+	for (ix = hash & mMask; mByHash[ix].key; ix = (ix + 1) & mMask)
+		if (mByHash[ix].hash == hash && CFEqual(mByHash[ix].key, key))
+			return mByHash[ix].index;
+	return -1;
+}
+
+
 /******************************************************************************/
 
 struct ProtocolAttributeInfo {
@@ -83,6 +168,14 @@ static ProtocolAttributeInfo gProtocolTypes[] = {
 
 static const int kNumberOfProtocolTypes = sizeof(gProtocolTypes) / sizeof(ProtocolAttributeInfo);
 
+class ProtocolLookup : public AttributeLookup
+{
+public:
+	ProtocolLookup() { build(gProtocolTypes, kNumberOfProtocolTypes, &ProtocolAttributeInfo::protocolValue); }
+};
+
+static ModuleNexus<ProtocolLookup> gProtocolLookup;
+
 /*
  * _SecProtocolTypeForSecAttrProtocol converts a SecAttrProtocol to a SecProtocolType.
  */
@@ -93,13 +186,9 @@ _SecProtocolTypeForSecAttrProtocol(
 	SecProtocolType result = kSecProtocolTypeAny;
 
 	if (protocol != NULL) {
-		CFIndex count;
-		for (count=0; count<kNumberOfProtocolTypes; count++) {
-			if (CFEqual(protocol, *(gProtocolTypes[count].protocolValue))) {
-				result = gProtocolTypes[count].protocolType;
-				break;
-			}
-		}
+		int index = gProtocolLookup().find(protocol);
+		if (index >= 0)
+			result = gProtocolTypes[index].protocolType;
 	}
 
 	return result;
@@ -145,6 +234,14 @@ static AuthenticationAttributeInfo gAuthTypes[] = {
 
 static const int kNumberOfAuthenticationTypes = sizeof(gAuthTypes) / sizeof(AuthenticationAttributeInfo);
 
+class AuthenticationLookup : public AttributeLookup
+{
+public:
+	AuthenticationLookup() { build(gAuthTypes, kNumberOfAuthenticationTypes, &AuthenticationAttributeInfo::authValue); }
+};
+
+static ModuleNexus<AuthenticationLookup> gAuthenticationLookup;
+
 /*
  * _SecAuthenticationTypeForSecAttrAuthenticationType converts a
  * SecAttrAuthenticationType to a SecAuthenticationType.
@@ -156,13 +253,9 @@ _SecAuthenticationTypeForSecAttrAuthenticationType(
 	SecAuthenticationType result = kSecAuthenticationTypeAny;
 
 	if (authenticationType != NULL) {
-		CFIndex count;
-		for (count=0; count<kNumberOfAuthenticationTypes; count++) {
-			if (CFEqual(authenticationType, *(gAuthTypes[count].authValue))) {
-				result = gAuthTypes[count].authType;
-				break;
-			}
-		}
+		int index = gAuthenticationLookup().find(authenticationType);
+		if (index >= 0)
+			result = gAuthTypes[index].authType;
 	}
 
 	return result;
@@ -210,6 +303,14 @@ static KeyAlgorithmInfo gKeyTypes[] = {
 
 static const int kNumberOfKeyTypes = sizeof(gKeyTypes) / sizeof (KeyAlgorithmInfo);
 
+class KeyTypeLookup : public AttributeLookup
+{
+public:
+	KeyTypeLookup() { build(gKeyTypes, kNumberOfKeyTypes, &KeyAlgorithmInfo::keyType); }
+};
+
+static ModuleNexus<KeyTypeLookup> gKeyTypeLookup;
+
 
 static UInt32 _SecAlgorithmTypeFromSecAttrKeyType(
 	CFTypeRef keyTypeRef)
@@ -218,12 +319,10 @@ static UInt32 _SecAlgorithmTypeFromSecAttrKeyType(
 	if (CFStringGetTypeID() != CFGetTypeID(keyTypeRef))
 		return keyAlgValue;
 
-	int ix;
-	for (ix=0; ix<kNumberOfKeyTypes; ix++) {
-		if (CFEqual(keyTypeRef, *(gKeyTypes[ix].keyType))) {
-			keyAlgValue = gKeyTypes[ix].keyValue;
-			return keyAlgValue;
-		}
+	int ix = gKeyTypeLookup().find(keyTypeRef);
+	if (ix >= 0) {
+		keyAlgValue = gKeyTypes[ix].keyValue;
+		return keyAlgValue;
 	}
 
 	//%%%TODO try to convert the input string to a number here
@@ -339,6 +438,36 @@ static InternalAttributeListInfo gKeyAttributes[] =
 
 static const int kNumberOfKeyAttributes = sizeof(gKeyAttributes) / sizeof(InternalAttributeListInfo);
 
+class InternalAttributeLookups
+{
+public:
+	InternalAttributeLookups()
+	{
+		mGenericPassword.build(gGenericPasswordAttributes, kNumberOfGenericPasswordAttributes, &InternalAttributeListInfo::newItemType);
+		mInternetPassword.build(gInternetPasswordAttributes, kNumberOfInternetPasswordAttributes, &InternalAttributeListInfo::newItemType);
+		mCertificate.build(gCertificateAttributes, kNumberOfCertificateAttributes, &InternalAttributeListInfo::newItemType);
+		mKey.build(gKeyAttributes, kNumberOfKeyAttributes, &InternalAttributeListInfo::newItemType);
+	}
+
+	// the lookup for one of the tables above, or NULL
+	const AttributeLookup *forInfo(const InternalAttributeListInfo *info) const
+	{
+		if (info == gGenericPasswordAttributes) return &mGenericPassword;
+		if (info == gInternetPasswordAttributes) return &mInternetPassword;
+		if (info == gCertificateAttributes) return &mCertificate;
+		if (info == gKeyAttributes) return &mKey;
+		return NULL;
+	}
+
+private:
+	AttributeLookup mGenericPassword;
+	AttributeLookup mInternetPassword;
+	AttributeLookup mCertificate;
+	AttributeLookup mKey;
+};
+
+static ModuleNexus<InternalAttributeLookups> gInternalAttributeLookups;
+
 
 static void* CloneDataByType(ItemRepresentation type, CFTypeRef value, UInt32& length)
 {
@@ -459,28 +588,36 @@ _ConvertNewFormatToOldFormat(
 	int count = 0;
 	int i;
 
-	// since this is one of those nasty order n^2 loops, we cache as much stuff as possible so that
-	// we don't pay the price for this twice
+	// cache what we find so that we don't pay for the lookups twice
 	SecKeychainAttrType tags[itemsInDictionary];
 	ItemRepresentation types[itemsInDictionary];
+	const AttributeLookup *lookup = gInternalAttributeLookups().forInfo(info);
 
 	for (i = 0; i < itemsInDictionary; ++i)
 	{
 		CFTypeRef key = keysPtr[i];
 
 		int j;
-		for (j = 0; j < infoNumItems; ++j)
+		if (lookup)
 		{
-			if (CFEqual(*(info[j].newItemType), key))
-			{
-				tags[i] = info[j].oldItemType;
-				types[i] = info[j].itemRepresentation;
-				count += 1;
-				break;
-			}
+			j = lookup->find(key);
+			if (j < 0)
+				j = infoNumItems;
+		}
+		else
+		{
+			for (j = 0; j < infoNumItems; ++j)
+				if (CFEqual(*(info[j].newItemType), key))
+					break;
 		}
 
-		if (j >= infoNumItems)
+		if (j < infoNumItems)
+		{
+			tags[i] = info[j].oldItemType;
+			types[i] = info[j].itemRepresentation;
+			count += 1;
+		}
+		else
 		{
 			// if we got here, we aren't interested in this item.
 			valuesPtr[i] = NULL;
@@ -729,6 +866,26 @@ _CreateAttributesDictionaryFromCertificateItem(
 	return noErr;
 }
 
+/*
+ * _ItemIDForItemClass returns the item ID (record type) to pass to
+ * SecKeychainAttributeInfoForItemID for items of itemClass.
+ */
+static UInt32
+_ItemIDForItemClass(SecItemClass itemClass)
+{
+	switch (itemClass)
+	{
+    case kSecInternetPasswordItemClass:
+		return CSSM_DL_DB_RECORD_INTERNET_PASSWORD;
+    case kSecGenericPasswordItemClass:
+		return CSSM_DL_DB_RECORD_GENERIC_PASSWORD;
+    case kSecAppleSharePasswordItemClass:
+		return CSSM_DL_DB_RECORD_APPLESHARE_PASSWORD;
+	default:
+		return itemClass;
+	}
+}
+
 /*
  * _CreateAttributesDictionaryFromKeyItem creates a CFDictionaryRef using the
  * attributes of item.
@@ -776,21 +933,7 @@ _CreateAttributesDictionaryFromKeyItem(
 		goto error_exit; // item must have an itemClass
 	}
 
-	switch (itemClass)
-	{
-    case kSecInternetPasswordItemClass:
-		itemID = CSSM_DL_DB_RECORD_INTERNET_PASSWORD;
-		break;
-    case kSecGenericPasswordItemClass:
-		itemID = CSSM_DL_DB_RECORD_GENERIC_PASSWORD;
-		break;
-    case kSecAppleSharePasswordItemClass:
-		itemID = CSSM_DL_DB_RECORD_APPLESHARE_PASSWORD;
-		break;
-	default:
-		itemID = itemClass;
-		break;
-	}
+	itemID = _ItemIDForItemClass(itemClass);
 
 	status = SecKeychainItemCopyKeychain(item, &keychain);
 	if (status) {
@@ -2385,8 +2528,11 @@ struct SecItemParams {
 	CFDictionaryRef query;				// caller-supplied query
 	int numResultTypes;					// number of result types requested
 	int maxMatches;						// max number of matches to return
+	int searchLimit;					// maxMatches, if pushed down to the keychain search (else 0)
+	int candidateCount;					// items returned by keychain searches so far
 	uint32 keyUsage;					// key usage(s) requested
 	Boolean returningAttributes;		// true if returning attributes dictionary
+	const SecKeychainAttributeInfo *attributesToFetch;	// attributes to read with each match, NULL for all (not owned)
 	Boolean returningData;				// true if returning item's data
 	Boolean returningRef;				// true if returning item reference
 	Boolean returningPersistentRef;		// true if returing a persistent reference
@@ -2652,6 +2798,10 @@ _CreateSecItemParamsFromDictionary(CFDictionaryRef dict, OSStatus *error)
 				itemParams->itemClass,
 				(itemParams->attrList->count == 0) ? NULL : itemParams->attrList,
 				(SecKeychainSearchRef*)&itemParams->search);
+		if (!status && itemParams->returningAttributes) {
+			// read the attributes with each match rather than per item afterwards
+			SecKeychainSearchSetAttributesToFetch((SecKeychainSearchRef)itemParams->search, NULL);
+		}
 	}
 
 error_exit:
@@ -2853,6 +3003,12 @@ UpdateKeychainSearchAndCopyNext(SecItemParams *params, CFTypeRef *item)
 	if (!params || !params->assumedKeyClass || !params->query || !item)
 		return status;
 
+	// Don't search the remaining key classes if we already have all we need.
+	if (params->searchLimit && params->candidateCount >= params->searchLimit) {
+		params->assumedKeyClass = NULL;
+		return status;
+	}
+
 	// Free the previous search reference and attribute list.
 	if (params->search)
 		CFRelease(params->search);
@@ -2885,6 +3041,10 @@ UpdateKeychainSearchAndCopyNext(SecItemParams *params, CFTypeRef *item)
 			params->itemClass,
 			(params->attrList->count == 0) ? NULL : params->attrList,
 			(SecKeychainSearchRef*)&params->search) == noErr) {
+			if (params->returningAttributes)
+				SecKeychainSearchSetAttributesToFetch((SecKeychainSearchRef)params->search, params->attributesToFetch);
+			if (params->searchLimit)
+				SecKeychainSearchSetLimit((SecKeychainSearchRef)params->search, params->searchLimit - params->candidateCount);
 			// Return the first matching item from the new search.
 			// We won't come back here again until there are no more matching items for this search.
 			status = SecKeychainSearchCopyNext((SecKeychainSearchRef)params->search, (SecKeychainItemRef*)item);
@@ -2912,6 +3072,8 @@ SecItemSearchCopyNext(SecItemParams *params, CFTypeRef *item)
 		// Check if we need to refresh the search for the next key class
 		while (status == errSecItemNotFound && params->assumedKeyClass != NULL)
 			status = UpdateKeychainSearchAndCopyNext(params, item);
+		if (status == noErr)
+			params->candidateCount++;
 	}
 	else {
 		status = errSecItemNotFound;
@@ -3077,6 +3239,28 @@ filterOut:
 	return errSecItemNotFound;
 }
 
+static void
+_PushDownMatchLimit(SecItemParams *itemParams)
+{
+	// Only if FilterCandidateItem can't reject an item is every item the search
+	// returns a match, so that the search itself can stop at the match limit.
+	if (itemParams->returnAllMatches || itemParams->itemList)
+		return;
+	if (itemParams->itemClass == kSecCertificateItemClass) {
+		CFDictionaryRef query = itemParams->query;
+		if (itemParams->returnIdentity || itemParams->policy || itemParams->validOnDate || itemParams->trustedOnly ||
+			CFDictionaryContainsKey(query, kSecMatchSubjectContains) ||
+			CFDictionaryContainsKey(query, kSecMatchSubjectStartsWith) ||
+			CFDictionaryContainsKey(query, kSecMatchSubjectEndsWith) ||
+			CFDictionaryContainsKey(query, kSecMatchSubjectWholeString))
+			return;
+	}
+
+	itemParams->searchLimit = itemParams->maxMatches;
+	if (itemParams->search && CFGetTypeID(itemParams->search) == SecKeychainSearchGetTypeID())
+		SecKeychainSearchSetLimit((SecKeychainSearchRef)itemParams->search, itemParams->searchLimit);
+}
+
 OSStatus
 AddItemResults(SecKeychainItemRef item,
 	SecIdentityRef identity,
@@ -3250,6 +3434,7 @@ SecItemCopyMatching(
 	// validate input query parameters and create the search reference
 	SecItemParams *itemParams = _CreateSecItemParamsFromDictionary(query, &status);
 	require_action(itemParams != NULL, error_exit, itemParams = NULL);
+	_PushDownMatchLimit(itemParams);
 
 	// find the next match until we hit maxMatches, or no more matches found
 	while ( !(!itemParams->returnAllMatches && matchCount >= itemParams->maxMatches) &&
@@ -3287,6 +3472,365 @@ error_exit:
 	return status;
 }
 
+OSStatus
+SecItemEnumerateMatching(
+	CFDictionaryRef query,
+	CFIndex batchSize,
+	SecItemMatchHandler handler)
+{
+	if (!query || !handler)
+		return paramErr;
+	if (batchSize < 1)
+		batchSize = 1;
+
+	CFAllocatorRef allocator = CFGetAllocator(query);
+	CFIndex matchCount = 0;
+	CFMutableArrayRef batch = NULL;
+	SecKeychainItemRef item = NULL;
+	SecIdentityRef identity = NULL;
+	CFTypeRef batchResult = NULL;
+	Boolean stop = FALSE;
+	OSStatus tmpStatus, status = noErr;
+
+	// validate input query parameters and create the search reference
+	SecItemParams *itemParams = _CreateSecItemParamsFromDictionary(query, &status);
+	require_action(itemParams != NULL, error_exit, itemParams = NULL);
+	_PushDownMatchLimit(itemParams);
+
+	// as SecItemCopyMatching, but hand off the results every batchSize matches
+	while ( !stop && !(!itemParams->returnAllMatches && matchCount >= itemParams->maxMatches) &&
+			SecItemSearchCopyNext(itemParams, (CFTypeRef*)&item) == noErr) {
+
+		if (FilterCandidateItem((CFTypeRef*)&item, itemParams, &identity))
+			continue; // move on to next item
+
+		++matchCount; // we have a match
+
+		// with a batch array supplied, AddItemResults always appends to it
+		if (!batch)
+			batch = CFArrayCreateMutable(allocator, batchSize, &kCFTypeArrayCallBacks);
+		tmpStatus = AddItemResults(item, identity, itemParams, allocator, &batch, &batchResult);
+		if (tmpStatus && (status == noErr))
+			status = tmpStatus;
+
+		if (item) {
+			CFRelease(item);
+			item = NULL;
+		}
+		if (identity) {
+			CFRelease(identity);
+			identity = NULL;
+		}
+
+		if (CFArrayGetCount(batch) >= batchSize) {
+			handler(batch, &stop);
+			CFRelease(batch);
+			batch = NULL;
+		}
+	}
+	if (batch) {
+		if (CFArrayGetCount(batch) > 0)
+			handler(batch, &stop);
+		CFRelease(batch);
+	}
+
+	if (status == noErr)
+		status = (matchCount > 0) ? errSecSuccess : errSecItemNotFound;
+
+error_exit:
+	_FreeSecItemParams(itemParams);
+
+	return status;
+}
+
+/*
+ * An attribute table, as made by SecItemCopyAttributeTable, is a CFData holding
+ * a header, the tag of each attribute (column), the item class of each item
+ * (row), a cell for every value, column by column, and last the arena of
+ * value bytes which the cells point into.
+ */
+struct SecItemAttributeTableHeader {
+	UInt32 magic;
+	UInt32 rows;
+	UInt32 columns;
+	UInt32 reserved;
+};
+
+struct SecItemAttributeTableCell {
+	UInt32 offset;		// into the arena, or kSecItemAttributeTableNoValue
+	UInt32 length;
+};
+
+#define kSecItemAttributeTableMagic		'katt'
+#define kSecItemAttributeTableNoValue	0xFFFFFFFF
+
+/*
+ * The attribute schema of one item class in one keychain, as used for the rows
+ * of an attribute table made without an info.
+ */
+struct SecItemAttributeTableSchema {
+	SecKeychainRef keychain;
+	SecItemClass itemClass;
+	SecKeychainAttributeInfo *info;
+};
+
+/*
+ * _AttributeTableSchemaForItem returns the schema of item's class in its keychain,
+ * looking it up and adding it to schemas the first time it is needed.
+ */
+static OSStatus
+_AttributeTableSchemaForItem(SecKeychainItemRef item, std::vector<SecItemAttributeTableSchema> &schemas,
+	const SecKeychainAttributeInfo **info)
+{
+	SecItemClass itemClass;
+	SecKeychainRef keychain = NULL;
+	OSStatus status = SecKeychainItemCopyAttributesAndData(item, NULL, &itemClass, NULL, NULL, NULL);
+	if (!status)
+		status = SecKeychainItemCopyKeychain(item, &keychain);
+	if (status)
+		return status;
+
+	for (std::vector<SecItemAttributeTableSchema>::const_iterator it = schemas.begin(); it != schemas.end(); ++it) {
+		if (it->itemClass == itemClass && CFEqual(it->keychain, keychain)) {
+			CFRelease(keychain);
+			*info = it->info;
+			return noErr;
+		}
+	}
+
+	SecItemAttributeTableSchema schema = { keychain, itemClass, NULL };
+	status = SecKeychainAttributeInfoForItemID(keychain, _ItemIDForItemClass(itemClass), &schema.info);
+	if (status) {
+		CFRelease(keychain);
+		return status;
+	}
+	schemas.push_back(schema);
+	*info = schema.info;
+	return noErr;
+}
+
+OSStatus
+SecItemCopyAttributeTable(
+	CFDictionaryRef query,
+	const SecKeychainAttributeInfo *info,
+	CFDataRef *table)
+{
+	if (!query || !table)
+		return paramErr;
+	*table = NULL;
+
+	CFIndex matchCount = 0;
+	SecKeychainItemRef item = NULL;
+	SecIdentityRef identity = NULL;
+	std::vector<SecItemAttributeTableSchema> schemas;
+	std::vector<UInt32> tags;						// of each column
+	std::vector<SecItemClass> classes;
+	std::vector<SecItemAttributeTableCell> cells;	// row by row, until the end
+	std::vector<size_t> rowStarts;					// in cells; a short row lacks the later columns
+	std::vector<UInt8> arena;
+	OSStatus status = noErr;
+
+	if (info)
+		tags.assign(info->tag, info->tag + info->count);
+
+	// validate input query parameters and create the search reference
+	SecItemParams *itemParams = _CreateSecItemParamsFromDictionary(query, &status);
+	require_action(itemParams != NULL, error_exit, itemParams = NULL);
+	_PushDownMatchLimit(itemParams);
+
+	// have the attributes read along with each item, including by any later key class searches
+	itemParams->returningAttributes = TRUE;
+	itemParams->attributesToFetch = info;
+	if (itemParams->search && CFGetTypeID(itemParams->search) == SecKeychainSearchGetTypeID())
+		SecKeychainSearchSetAttributesToFetch((SecKeychainSearchRef)itemParams->search, info);
+
+	while ( !(!itemParams->returnAllMatches && matchCount >= itemParams->maxMatches) &&
+			SecItemSearchCopyNext(itemParams, (CFTypeRef*)&item) == noErr) {
+
+		if (FilterCandidateItem((CFTypeRef*)&item, itemParams, &identity))
+			continue; // move on to next item
+
+		++matchCount; // we have a match
+
+		// without an info, each item gets all the attributes of its own class and keychain
+		const SecKeychainAttributeInfo *rowInfo = info;
+		OSStatus tmpStatus = noErr;
+		if (!info)
+			tmpStatus = _AttributeTableSchemaForItem(item, schemas, &rowInfo);
+
+		SecItemClass itemClass;
+		SecKeychainAttributeList *attrList = NULL;
+		if (tmpStatus == noErr)
+			tmpStatus = SecKeychainItemCopyAttributesAndData(item, (SecKeychainAttributeInfo *)rowInfo, &itemClass, &attrList, NULL, NULL);
+		if (tmpStatus == noErr) {
+			classes.push_back(itemClass);
+			size_t rowStart = cells.size();
+			rowStarts.push_back(rowStart);
+			SecItemAttributeTableCell noValue = { kSecItemAttributeTableNoValue, 0 };
+			cells.resize(rowStart + tags.size(), noValue);
+			for (UInt32 ix = 0; ix < rowInfo->count; ++ix) {
+				const SecKeychainAttribute &attribute = attrList->attr[ix];
+				UInt32 col = ix;
+				if (!info) {
+					for (col = 0; col < tags.size() && tags[col] != attribute.tag; ++col)
+						;
+					if (col == tags.size()) {
+						tags.push_back(attribute.tag);
+						cells.push_back(noValue);
+					}
+				}
+				if (attribute.data) {
+					if (arena.size() + attribute.length >= kSecItemAttributeTableNoValue) {
+						tmpStatus = memFullErr;
+						break;
+					}
+					cells[rowStart + col].offset = (UInt32)arena.size();
+					cells[rowStart + col].length = attribute.length;
+					arena.insert(arena.end(), (const UInt8 *)attribute.data, (const UInt8 *)attribute.data + attribute.length);
+				}
+			}
+			SecKeychainItemFreeAttributesAndData(attrList, NULL);
+		}
+		if (tmpStatus && (status == noErr))
+			status = tmpStatus;
+
+		if (item) {
+			CFRelease(item);
+			item = NULL;
+		}
+		if (identity) {
+			CFRelease(identity);
+			identity = NULL;
+		}
+		if (tmpStatus == memFullErr)
+			break;
+	}
+
+	if (status == noErr && matchCount == 0)
+		status = errSecItemNotFound;
+	if (status == noErr) {
+		SecItemAttributeTableHeader header = { kSecItemAttributeTableMagic, (UInt32)classes.size(), (UInt32)tags.size(), 0 };
+		size_t cellsOffset = sizeof(header) + sizeof(UInt32) * (header.columns + header.rows);
+		size_t arenaOffset = cellsOffset + sizeof(SecItemAttributeTableCell) * header.columns * header.rows;
+		CFMutableDataRef data = CFDataCreateMutable(CFGetAllocator(query), 0);
+		require_action(data != NULL, error_exit, status = memFullErr);
+		CFDataSetLength(data, arenaOffset + arena.size());
+		UInt8 *bytes = CFDataGetMutableBytePtr(data);
+
+		memcpy(bytes, &header, sizeof(header));
+		UInt32 *columnTags = (UInt32 *)(bytes + sizeof(header));
+		for (UInt32 col = 0; col < header.columns; ++col)
+			columnTags[col] = tags[col];
+		UInt32 *rowClasses = columnTags + header.columns;
+		for (UInt32 row = 0; row < header.rows; ++row)
+			rowClasses[row] = classes[row];
+		// transpose the cells so each column's values are together
+		SecItemAttributeTableCell *columnCells = (SecItemAttributeTableCell *)(bytes + cellsOffset);
+		SecItemAttributeTableCell noValue = { kSecItemAttributeTableNoValue, 0 };
+		for (UInt32 row = 0; row < header.rows; ++row) {
+			size_t rowEnd = (row + 1 < header.rows) ? rowStarts[row + 1] : cells.size();
+			for (UInt32 col = 0; col < header.columns; ++col)
+				columnCells[col * header.rows + row] = (rowStarts[row] + col < rowEnd) ? cells[rowStarts[row] + col] : noValue;
+		}
+		if (!arena.empty())
+			memcpy(bytes + arenaOffset, &arena[0], arena.size());
+		*table = data;
+	}
+
+error_exit:
+	for (std::vector<SecItemAttributeTableSchema>::iterator it = schemas.begin(); it != schemas.end(); ++it) {
+		CFRelease(it->keychain);
+		SecKeychainFreeAttributeInfo(it->info);
+	}
+	_FreeSecItemParams(itemParams);
+
+	return status;
+}
+
+/*
+ * _AttributeTableHeader returns the header of table, if it is a well-formed
+ * attribute table, and the size of its arena.
+ */
+static const SecItemAttributeTableHeader *
+_AttributeTableHeader(CFDataRef table, size_t *arenaSize)
+{
+	if (!table || CFGetTypeID(table) != CFDataGetTypeID())
+		return NULL;
+	size_t length = CFDataGetLength(table);
+	if (length < sizeof(SecItemAttributeTableHeader))
+		return NULL;
+	const SecItemAttributeTableHeader *header = (const SecItemAttributeTableHeader *)CFDataGetBytePtr(table);
+	if (header->magic != kSecItemAttributeTableMagic)
+		return NULL;
+	uint64_t arenaOffset = sizeof(SecItemAttributeTableHeader) + sizeof(UInt32) * ((uint64_t)header->columns + header->rows)
+		+ sizeof(SecItemAttributeTableCell) * (uint64_t)header->columns * header->rows;
+	if (arenaOffset > length)
+		return NULL;
+	if (arenaSize)
+		*arenaSize = length - arenaOffset;
+	return header;
+}
+
+CFIndex
+SecItemAttributeTableGetItemCount(CFDataRef table)
+{
+	const SecItemAttributeTableHeader *header = _AttributeTableHeader(table, NULL);
+	return header ? header->rows : 0;
+}
+
+UInt32
+SecItemAttributeTableGetAttributeCount(CFDataRef table)
+{
+	const SecItemAttributeTableHeader *header = _AttributeTableHeader(table, NULL);
+	return header ? header->columns : 0;
+}
+
+SecKeychainAttrType
+SecItemAttributeTableGetTag(CFDataRef table, UInt32 attributeIndex)
+{
+	const SecItemAttributeTableHeader *header = _AttributeTableHeader(table, NULL);
+	if (!header || attributeIndex >= header->columns)
+		return 0;
+	const UInt32 *tags = (const UInt32 *)(header + 1);
+	return tags[attributeIndex];
+}
+
+SecItemClass
+SecItemAttributeTableGetItemClass(CFDataRef table, CFIndex itemIndex)
+{
+	const SecItemAttributeTableHeader *header = _AttributeTableHeader(table, NULL);
+	if (!header || itemIndex < 0 || itemIndex >= (CFIndex)header->rows)
+		return 0;
+	const UInt32 *rowClasses = (const UInt32 *)(header + 1) + header->columns;
+	return rowClasses[itemIndex];
+}
+
+Boolean
+SecItemAttributeTableGetValue(CFDataRef table, CFIndex itemIndex, UInt32 attributeIndex, const void **data, UInt32 *length)
+{
+	if (data)
+		*data = NULL;
+	if (length)
+		*length = 0;
+
+	size_t arenaSize;
+	const SecItemAttributeTableHeader *header = _AttributeTableHeader(table, &arenaSize);
+	if (!header || itemIndex < 0 || itemIndex >= (CFIndex)header->rows || attributeIndex >= header->columns)
+		return FALSE;
+	const SecItemAttributeTableCell *cells = (const SecItemAttributeTableCell *)
+		((const UInt32 *)(header + 1) + header->columns + header->rows);
+	const SecItemAttributeTableCell &cell = cells[attributeIndex * header->rows + itemIndex];
+	if (cell.offset == kSecItemAttributeTableNoValue || (uint64_t)cell.offset + cell.length > arenaSize)
+		return FALSE;
+
+	const UInt8 *arena = (const UInt8 *)(cells + (size_t)header->columns * header->rows);
+	if (data)
+		*data = arena + cell.offset;
+	if (length)
+		*length = cell.length;
+	return TRUE;
+}
+
 OSStatus
 SecItemCopyDisplayNames(
 	CFArrayRef items,
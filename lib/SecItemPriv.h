@@ -30,6 +30,8 @@
 #ifndef _SECURITY_SECITEMPRIV_H_
 #define _SECURITY_SECITEMPRIV_H_
 
+#include <CoreFoundation/CoreFoundation.h>
+#include <Security/SecKeychainItem.h>
 
 #if defined(__cplusplus)
 extern "C" {
@@ -285,6 +287,99 @@ extern "C" {
 	 */
 	OSStatus SecItemDeleteAll(void);
 	
+	/*!
+	 @function SecItemCopyAttributeTable
+	 @abstract Returns the attributes of all the items matching a search
+	 query in a single table.
+	 @param query A dictionary containing an item class specification and
+	 optional attributes for controlling the search, as for
+	 SecItemCopyMatching. Result type keys are ignored.
+	 @param info The attributes to return, by tag; the formats are ignored.
+	 Pass NULL for every attribute in the schema of each item's class: the
+	 columns are then all the attributes found in any of those schemas, in
+	 the order first found, and an item has no value for a column its own
+	 class or keychain lacks.
+	 @param table On return, a table of attribute values with a row for each
+	 matching item and a column for each attribute. Read it with the
+	 SecItemAttributeTable functions below. You are responsible for releasing
+	 it by calling the CFRelease function.
+	 @result A result code, errSecItemNotFound if nothing matched. See
+	 "Security Error Codes" (SecBase.h).
+	 @discussion The values are the raw attribute values, as
+	 SecKeychainItemCopyAttributesAndData returns them, stored column by
+	 column in one buffer. Reading every attribute of a large number of
+	 items this way takes a few allocations, rather than a dictionary and
+	 a CF object per attribute of each item as SecItemCopyMatching does.
+	 */
+	OSStatus SecItemCopyAttributeTable(CFDictionaryRef query, const SecKeychainAttributeInfo *info, CFDataRef *table);
+
+	/*!
+	 @function SecItemAttributeTableGetItemCount
+	 @abstract Returns the number of items (rows) in an attribute table.
+	 */
+	CFIndex SecItemAttributeTableGetItemCount(CFDataRef table);
+
+	/*!
+	 @function SecItemAttributeTableGetAttributeCount
+	 @abstract Returns the number of attributes (columns) in an attribute table.
+	 */
+	UInt32 SecItemAttributeTableGetAttributeCount(CFDataRef table);
+
+	/*!
+	 @function SecItemAttributeTableGetTag
+	 @abstract Returns the tag of an attribute (column) of an attribute table.
+	 */
+	SecKeychainAttrType SecItemAttributeTableGetTag(CFDataRef table, UInt32 attributeIndex);
+
+	/*!
+	 @function SecItemAttributeTableGetItemClass
+	 @abstract Returns the item class of an item (row) of an attribute table.
+	 */
+	SecItemClass SecItemAttributeTableGetItemClass(CFDataRef table, CFIndex itemIndex);
+
+	/*!
+	 @function SecItemAttributeTableGetValue
+	 @abstract Gets the value of one attribute of one item in an attribute table.
+	 @param data On return, a pointer to the value, which lies within the table
+	 and remains valid for as long as the table does.
+	 @param length On return, the length of the value in bytes.
+	 @result true if the item has a value for the attribute.
+	 */
+	Boolean SecItemAttributeTableGetValue(CFDataRef table, CFIndex itemIndex, UInt32 attributeIndex, const void **data, UInt32 *length);
+
+#ifdef __BLOCKS__
+	/*!
+	 @typedef SecItemMatchHandler
+	 @abstract Receives one batch of results from SecItemEnumerateMatching.
+	 @param results An array of up to batchSize results, each as it would
+	 appear in the array returned by SecItemCopyMatching. The array is
+	 released when the handler returns; retain it, or values in it, to keep
+	 them.
+	 @param stop Set to true to end the enumeration after this batch.
+	 */
+	typedef void (^SecItemMatchHandler)(CFArrayRef results, Boolean *stop);
+
+	/*!
+	 @function SecItemEnumerateMatching
+	 @abstract Hands the items matching a search query to a block, a batch at
+	 a time.
+	 @param query A dictionary containing an item class specification and
+	 optional attributes for controlling the search, as for
+	 SecItemCopyMatching. Pass kSecMatchLimitAll as the kSecMatchLimit to
+	 enumerate every match.
+	 @param batchSize The most results to pass to handler at once; 0 means 1.
+	 @param handler Called with each batch of results, on the calling thread,
+	 before the enumeration continues.
+	 @result A result code, errSecItemNotFound if nothing matched. See
+	 "Security Error Codes" (SecBase.h).
+	 @discussion Unlike SecItemCopyMatching, which builds all its results
+	 before returning, only one batch of results exists at a time, so
+	 enumerating a large keychain takes memory in proportion to batchSize
+	 rather than to the number of items.
+	 */
+	OSStatus SecItemEnumerateMatching(CFDictionaryRef query, CFIndex batchSize, SecItemMatchHandler handler);
+#endif /* __BLOCKS__ */
+
 #if defined(__cplusplus)
 }
 #endif
@@ -590,6 +590,7 @@ SecKeychainFindInternetPassword(CFTypeRef keychainOrArray, UInt32 serverNameLeng
 	}
 
 	Item item;
+	cursor->limit(1);
 	if (!cursor->next(item))
 		return errSecItemNotFound;
 
@@ -689,6 +690,7 @@ SecKeychainFindGenericPassword(CFTypeRef keychainOrArray, UInt32 serviceNameLeng
 	}
 
 	Item item;
+	cursor->limit(1);
 	if (!cursor->next(item))
 		return errSecItemNotFound;
 
@@ -1092,6 +1094,14 @@ OSStatus SecKeychainSetBatchMode (SecKeychainRef kcRef, Boolean mode, Boolean ro
 
 
 
+OSStatus SecKeychainPrewarmSearchList()
+{
+	BEGIN_SECAPI
+	globals().storageManager.prewarmSearchList();
+	END_SECAPI
+}
+
+
 OSStatus SecKeychainCleanupHandles()
 {
 	BEGIN_SECAPI
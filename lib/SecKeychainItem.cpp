@@ -556,7 +556,7 @@ OSStatus SecKeychainItemCreateFromEncryptedContent(SecItemClass itemClass,
 						Schema::X509CertificateSchemaAttributeList,
 						Schema::X509CertificateSchemaIndexCount,
 						Schema::X509CertificateSchemaIndexList);
-					keychain->keychainSchema()->didCreateRelation(
+					keychain->didCreateRelation(
 						CSSM_DL_DB_RECORD_X509_CERTIFICATE,
 						"CSSM_DL_DB_RECORD_X509_CERTIFICATE",
 						Schema::X509CertificateSchemaAttributeCount,
@@ -604,3 +604,18 @@ OSStatus SecKeychainItemModifyEncryptedData(SecKeychainItemRef itemRef, UInt32 l
 		item->modifyAttributesAndData(NULL, length, data);
 	END_SECAPI
 }
+
+OSStatus SecKeychainItemCacheSetBudget(UInt64 bytes)
+{
+	BEGIN_SECAPI
+		ItemImpl::setContentCacheBudget(bytes);
+	END_SECAPI
+}
+
+OSStatus SecKeychainItemCacheGetStatistics(SecKeychainItemCacheStatistics *stats)
+{
+	BEGIN_SECAPI
+		RequiredParam(stats);
+		ItemImpl::getContentCacheStatistics(*stats);
+	END_SECAPI
+}
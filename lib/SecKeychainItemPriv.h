@@ -157,6 +157,43 @@ OSStatus SecKeychainItemModifyEncryptedData(SecKeychainItemRef itemRef, UInt32 l
 OSStatus SecKeychainItemCreateFromEncryptedContent(SecItemClass itemClass, UInt32 length, const void *data,
 												   SecKeychainRef keychainRef, SecAccessRef initialAccess,
 												   SecKeychainItemRef *itemRef, CFDataRef *itemLocalID);
+/*!
+	@typedef SecKeychainItemCacheStatistics
+	@abstract Counters for the in-memory cache of keychain item attributes. Hits and misses count
+			  attribute reads; an eviction drops all the cached attributes of one item.
+*/
+typedef struct SecKeychainItemCacheStatistics
+{
+	UInt64 hits;
+	UInt64 misses;
+	UInt64 evictions;
+	UInt64 evictedBytes;
+	UInt64 bytes;			/* currently cached */
+	UInt64 budget;
+} SecKeychainItemCacheStatistics;
+
+/*!
+	@function SecKeychainItemCacheSetBudget
+	@abstract Sets how much memory may be used to cache the attributes of keychain items read from
+			  keychains in this process. Attributes of the least recently used items are dropped, and
+			  read from their keychains again when needed, to stay within the budget. The cache is
+			  off until a budget is set; while it is on, this process listens for keychain events so
+			  that items changed by other processes are read again. Attributes fetched along with
+			  search results (SecKeychainSearchSetAttributesToFetch) are kept by the items themselves
+			  and don't count against the budget.
+	@param bytes The budget in bytes; 0 disables the cache.
+    @result A result code.  See "Security Error Codes" (SecBase.h).
+*/
+OSStatus SecKeychainItemCacheSetBudget(UInt64 bytes);
+
+/*!
+	@function SecKeychainItemCacheGetStatistics
+	@abstract Returns the counters for the keychain item attribute cache.
+	@param stats On return, the current counters.
+    @result A result code.  See "Security Error Codes" (SecBase.h).
+*/
+OSStatus SecKeychainItemCacheGetStatistics(SecKeychainItemCacheStatistics *stats);
+
 #if defined(__cplusplus)
 }
 #endif
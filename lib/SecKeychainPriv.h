@@ -52,6 +52,10 @@ OSStatus SecKeychainListCopyKeychainAtIndex(UInt16 index, SecKeychainRef *keycha
 OSStatus SecKeychainListRemoveKeychain(SecKeychainRef *keychainRef);
 OSStatus SecKeychainRemoveFromSearchList(SecKeychainRef keychainRef);
 
+/* Open the search list keychains and load their schemas on background threads, ahead of the first search.
+   Returns at once; only the first call in a process does anything. */
+OSStatus SecKeychainPrewarmSearchList(void);
+
 /* Login keychain support */
 OSStatus SecKeychainLogin(UInt32 nameLength, const void* name, UInt32 passwordLength, const void* password);
 OSStatus SecKeychainLogout();
@@ -72,6 +72,40 @@ SecKeychainSearchCreateFromAttributesExtended(CFTypeRef keychainOrArray, SecItem
 }
 
 
+OSStatus
+SecKeychainSearchSetAttributesToFetch(SecKeychainSearchRef searchRef, const SecKeychainAttributeInfo *info)
+{
+	BEGIN_SECAPI
+
+	KCCursorImpl::required(searchRef)->fetchAttributes(info);
+
+	END_SECAPI
+}
+
+
+OSStatus
+SecKeychainSearchSetLimit(SecKeychainSearchRef searchRef, UInt32 maxItems)
+{
+	BEGIN_SECAPI
+
+	KCCursorImpl::required(searchRef)->limit(maxItems);
+
+	END_SECAPI
+}
+
+
+OSStatus
+SecKeychainSearchGetStatistics(SecKeychainSearchStatistics *stats)
+{
+	BEGIN_SECAPI
+
+	Required(stats);
+	KCCursorImpl::getStatistics(*stats);
+
+	END_SECAPI
+}
+
+
 
 OSStatus
 SecKeychainSearchCopyNext(SecKeychainSearchRef searchRef, SecKeychainItemRef *itemRef)
@@ -50,6 +50,46 @@ extern "C" {
 OSStatus SecKeychainSearchCreateFromAttributesExtended(CFTypeRef keychainOrArray, SecItemClass itemClass, const SecKeychainAttributeList *attrList, CSSM_DB_CONJUNCTIVE dbConjunctive, CSSM_DB_OPERATOR dbOperator, SecKeychainSearchRef *searchRef)
 	DEPRECATED_IN_MAC_OS_X_VERSION_10_7_AND_LATER;
 
+/*!
+	@function SecKeychainSearchSetAttributesToFetch
+	@abstract Fetches the specified attributes along with each item the search returns.
+	@param searchRef A reference to the search.
+	@param info A pointer to a list of the attribute tags to fetch; the formats are ignored. Pass NULL to fetch every attribute of the item class.
+	@result A result code.  See "Security Error Codes" (SecBase.h).
+	@discussion The attributes are read in the same database call that finds each item, and are kept with the item, so that a following SecKeychainItemCopyAttributesAndData or SecKeychainItemCopyContent call for them, with no data requested, needn't read the item again. Only takes effect for searches of a single item class.
+*/
+OSStatus SecKeychainSearchSetAttributesToFetch(SecKeychainSearchRef searchRef, const SecKeychainAttributeInfo *info);
+
+/*!
+	@function SecKeychainSearchSetLimit
+	@abstract Limits the number of items a search returns.
+	@param searchRef A reference to the search.
+	@param maxItems The most items to return, or 0 for no limit.
+	@result A result code.  See "Security Error Codes" (SecBase.h).
+	@discussion Once maxItems items have been returned the search ends its database query, and keychains later in the search list are never opened or searched.
+*/
+OSStatus SecKeychainSearchSetLimit(SecKeychainSearchRef searchRef, UInt32 maxItems);
+
+/*!
+	@typedef SecKeychainSearchStatistics
+	@abstract Counts of the database calls made by keychain searches in this process, for measuring lookups.
+*/
+typedef struct SecKeychainSearchStatistics
+{
+	UInt64 activations;		/* keychain databases activated */
+	UInt64 queries;			/* queries started, one per keychain searched */
+	UInt64 recordRequests;	/* DataGetFirst and DataGetNext calls */
+	UInt64 recordReads;		/* extra per-record DataGetFromUniqueRecordId calls */
+} SecKeychainSearchStatistics;
+
+/*!
+	@function SecKeychainSearchGetStatistics
+	@abstract Returns the counts of database calls made by keychain searches so far.
+	@param stats On return, the current counts.
+	@result A result code.  See "Security Error Codes" (SecBase.h).
+*/
+OSStatus SecKeychainSearchGetStatistics(SecKeychainSearchStatistics *stats);
+
 #if defined(__cplusplus)
 }
 #endif
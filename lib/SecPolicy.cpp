@@ -164,19 +164,11 @@ SecPolicyCopyAll(CSSM_CERT_TYPE certificateType, CFArrayRef* policies)
 OSStatus
 SecPolicyCopy(CSSM_CERT_TYPE certificateType, const CSSM_OID *policyOID, SecPolicyRef* policy)
 {
+	BEGIN_SECAPI
 	Required(policy);
 	Required(policyOID);
-	
-	SecPolicySearchRef srchRef = NULL;
-	OSStatus ortn;
-	
-	ortn = SecPolicySearchCreate(certificateType, policyOID, NULL, &srchRef);
-	if(ortn) {
-		return ortn;
-	}
-	ortn = SecPolicySearchCopyNext(srchRef, policy);
-	CFRelease(srchRef);
-	return ortn;
+	*policy = PolicyCursor::policy(CssmOid::overlay(*policyOID))->handle();
+	END_SECAPI
 }
 
 /* new in 10.6 */
@@ -185,14 +177,7 @@ SecPolicyCreateBasicX509(void)
 {
     // return a SecPolicyRef object for the X.509 Basic policy
     SecPolicyRef policy = nil;
-    SecPolicySearchRef policySearch = nil;
-    OSStatus status = SecPolicySearchCreate(CSSM_CERT_X_509v3, &CSSMOID_APPLE_X509_BASIC, NULL, &policySearch);
-    if (!status) {
-        status = SecPolicySearchCopyNext(policySearch, &policy);
-    }
-	if (policySearch) {
-		CFRelease(policySearch);
-	}
+    SecPolicyCopy(CSSM_CERT_X_509v3, &CSSMOID_APPLE_X509_BASIC, &policy);
     return policy;
 }
 
@@ -202,11 +187,7 @@ SecPolicyCreateSSL(Boolean server, CFStringRef hostname)
 {
     // return a SecPolicyRef object for the SSL policy, given hostname and client options
     SecPolicyRef policy = nil;
-    SecPolicySearchRef policySearch = nil;
-    OSStatus status = SecPolicySearchCreate(CSSM_CERT_X_509v3, &CSSMOID_APPLE_TP_SSL, NULL, &policySearch);
-    if (!status) {
-        status = SecPolicySearchCopyNext(policySearch, &policy);
-    }
+    OSStatus status = SecPolicyCopy(CSSM_CERT_X_509v3, &CSSMOID_APPLE_TP_SSL, &policy);
     if (!status && policy) {
         // set options for client-side or server-side policy evaluation
 		char *strbuf = NULL;
@@ -232,9 +213,6 @@ SecPolicyCreateSSL(Boolean server, CFStringRef hostname)
 			free(strbuf);
 		}
     }
-	if (policySearch) {
-		CFRelease(policySearch);
-	}
     return policy;
 }
 
@@ -270,12 +248,7 @@ SecPolicyCreateWithOID(CFTypeRef policyOID)
 		}
 	}
 	if (oidPtr) {
-		SecPolicySearchRef policySearch = NULL;
-		OSStatus status = SecPolicySearchCreate(CSSM_CERT_X_509v3, oidPtr, NULL, &policySearch);
-		if (!status && policySearch) {
-			status = SecPolicySearchCopyNext(policySearch, &policy);
-			CFRelease(policySearch);
-		}
+		SecPolicyCopy(CSSM_CERT_X_509v3, oidPtr, &policy);
 	}
 	return policy;
 }
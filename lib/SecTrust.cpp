@@ -24,6 +24,7 @@
 #include "SecTrust.h"
 #include "SecTrustPriv.h"
 #include "Trust.h"
+#include "AnchorBundle.h"
 #include <security_keychain/SecTrustSettingsPriv.h>
 #include "SecBridge.h"
 #include "SecTrustSettings.h"
@@ -422,6 +423,17 @@ OSStatus SecTrustGetCSSMAnchorCertificates(const CSSM_DATA **cssmAnchors,
 }
 
 
+//
+// Precompile the system roots for AnchorBundle
+//
+OSStatus SecTrustWriteAnchorBundle(const char *path)
+{
+	BEGIN_SECAPI
+	AnchorBundle::write(path ? path : AnchorBundle::defaultPath);
+	END_SECAPI
+}
+
+
 //
 // Get and set user trust settings. Deprecated in 10.5. 
 // User Trust getter, deprecated, works as it always has. 
@@ -114,6 +114,22 @@ OSStatus SecTrustGetCSSMAnchorCertificates(const CSSM_DATA **cssmAnchors, uint32
 */
 OSStatus SecTrustCopyExtendedResult(SecTrustRef trust, CFDictionaryRef *result);
 
+/*!
+	@function SecTrustWriteAnchorBundle
+	@abstract Precompiles the system root certificates into an anchor bundle.
+	@param path Where to write the bundle, or NULL for the system location.
+	@result A result code. See "Security Error Codes" (SecBase.h).
+	@discussion The bundle holds the certificates in SystemRootCertificates.keychain,
+	indexes over them, and the EV policy map from EVRoots.plist, in a form which is
+	mapped into memory on first use, so that anchor lookups need not open the system
+	roots keychain. Call this whenever either file is installed or changed; a bundle
+	which no longer matches them is ignored. A bundle also counts as out of date if
+	either file was modified in or after the second the bundle was written, so if
+	either file was modified within the current second, this waits for that second
+	to pass before writing.
+*/
+OSStatus SecTrustWriteAnchorBundle(const char *path);
+
 
 /*
  * Preference-related strings for Revocation policies.
@@ -145,6 +161,17 @@ OSStatus SecTrustCopyExtendedResult(SecTrustRef trust, CFDictionaryRef *result);
 /* local OCSP responder URI, value arbitrary string value */
 #define kSecOCSPLocalResponder				CFSTR("OCSPLocalResponder")
 
+/*
+ * Boolean in the com.apple.security domain, honored only in /Library/Preferences:
+ * when true, SecTrustEvaluate keeps failing outcomes (kSecTrustResultDeny and
+ * kSecTrustResultFatalTrustFailure) in ~/Library/Caches and reuses them in
+ * the user's other processes. Outcomes which trust a chain are never kept.
+ * The cache's records are authenticated with a key that any process running
+ * as the user can read, so such a process could forge them; the most a
+ * forged record can do is fail an evaluation, never pass one.
+ */
+#define kSecTrustDecisionCachePref			CFSTR("TrustDecisionCache")
+
 /* Extended trust result keys */
 #define kSecEVOrganizationName				CFSTR("Organization")			/* validated EV organization name */
 #define kSecTrustEvaluationDate				CFSTR("TrustEvaluationDate")	/* date when this trust evaluation took place */
@@ -49,6 +49,8 @@
 #include <securityd_client/ssclient.h>
 #include <assert.h>
 #include <vector>
+#include <map>
+#include <string>
 #include <CommonCrypto/CommonDigest.h>
 
 #define trustSettingsDbg(args...)	secdebug("trustSettings", ## args)
@@ -214,6 +216,38 @@ static TrustSettings *tsGetGlobalTrustSettings(
 	return ts;
 }
 
+/*
+ * Results of tsCopyCertsCommon(), keyed by its arguments, for callers such as
+ * SecureTransport which ask for the same set of trusted roots for every 
+ * connection. A result is good for the keychain list and certificate 
+ * generation it was found with, and until the TrustSettings cache is purged.
+ * Protected by sutCacheLock.
+ */
+struct TsQualifiedCerts
+{
+	StorageManager::KeychainList	keychains;
+	uint32							generation;
+	CFRef<CFArrayRef>				certs;
+};
+typedef std::map<std::string, TsQualifiedCerts> TsQualifiedCertsMap;
+
+static ModuleNexus<TsQualifiedCertsMap> tsQualifiedCerts;
+
+static bool tsSameKeychains(
+	const StorageManager::KeychainList &kc1,
+	const StorageManager::KeychainList &kc2)
+{
+	if(kc1.size() != kc2.size()) {
+		return false;
+	}
+	for(StorageManager::KeychainList::size_type dex=0; dex<kc1.size(); dex++) {
+		if(kc1[dex].get() != kc2[dex].get()) {
+			return false;
+		}
+	}
+	return true;
+}
+
 /* 
  * Purge TrustSettings cache. 
  * Called by Keychain Event callback and by our API functions that
@@ -229,6 +263,7 @@ static void tsPurgeCache()
 	for(domain=0; domain<TRUST_SETTINGS_NUM_DOMAINS; domain++) {
 		tsSetGlobalTrustSettings(NULL, domain);
 	}
+	tsQualifiedCerts().clear();
 }
 
 /* 
@@ -388,6 +423,40 @@ static OSStatus tsCopyCertsCommon(
 	Keychain sysCertKc = globals().storageManager.make(SYSTEM_CERT_STORE_PATH, false);
 	keychains.push_back(sysCertKc);
 
+	/* 
+	 * Have we already done this search since anything it depends on changed?
+	 * The key is everything which determines the result, keychains aside.
+	 */
+	std::string key;
+	key += user ? 'u' : '-';
+	key += admin ? 'a' : '-';
+	key += system ? 's' : '-';
+	key += onlyRoots ? 'r' : '-';
+	key.append((const char *)&keyUsage, sizeof(keyUsage));
+	if(policyOID) {
+		uint32 len = policyOID->Length;
+		key.append((const char *)&len, sizeof(len));
+		key.append((const char *)policyOID->Data, policyOID->Length);
+	}
+	else {
+		key += '-';
+	}
+	if(policyString) {
+		key.append(policyString, strlen(policyString) + 1);
+	}
+	uint32 generation = SecTrustKeychainsCertificatesGeneration();
+
+	TsQualifiedCertsMap::iterator cached = tsQualifiedCerts().find(key);
+	if((cached != tsQualifiedCerts().end()) &&
+	   (cached->second.generation == generation) &&
+	   tsSameKeychains(cached->second.keychains, keychains)) {
+		*certArray = cached->second.certs;
+		CFRetain(*certArray);
+		trustSettingsDbg("tsCopyCertsCommon: %ld certs found (cached)",
+			CFArrayGetCount(*certArray));
+		return noErr;
+	}
+
 	assert(kSecTrustSettingsDomainUser == 0);
 	for(unsigned domain=0; domain<TRUST_SETTINGS_NUM_DOMAINS; domain++) {
 		if(!domainEnable[domain]) {
@@ -403,7 +472,14 @@ static OSStatus tsCopyCertsCommon(
 			policyOID, policyString, keyUsage, 
 			outArray);
 	}
-	*certArray = outArray;
+
+	/* remember an immutable copy; it's what we hand out from now on */
+	TsQualifiedCerts &entry = tsQualifiedCerts()[key];
+	entry.keychains = keychains;
+	entry.generation = generation;
+	entry.certs.take(CFArrayCreateCopy(NULL, outArray));
+
+	*certArray = entry.certs;
 	CFRetain(*certArray);
 	trustSettingsDbg("tsCopyCertsCommon: %ld certs found",
 		CFArrayGetCount(outArray));
@@ -677,6 +753,76 @@ OSStatus SecTrustSettingsSetTrustSettingsExternal(
 	END_RCSAPI
 }
 
+/*
+ * Apply many set/remove changes to one domain with a single write and 
+ * a single notification. The changes are all made to one in-memory 
+ * TrustSettings first, so a bad one leaves the domain untouched. 
+ */
+OSStatus SecTrustSettingsApplyChanges(
+	SecTrustSettingsDomain	domain,
+	CFArrayRef				changes)
+{
+	BEGIN_RCSAPI
+
+	TS_REQUIRED(changes)
+
+	if(domain == kSecTrustSettingsDomainSystem) {
+		return errSecDataNotModifiable;
+	}
+	CFIndex numChanges = CFArrayGetCount(changes);
+	if(numChanges == 0) {
+		return noErr;
+	}
+
+	OSStatus result;
+	TrustSettings* ts;
+	
+	result = TrustSettings::CreateTrustSettings(domain, CREATE_YES, TRIM_NO, ts);
+	if (result != noErr) {
+		return result;
+	}
+	
+	auto_ptr<TrustSettings>_(ts);
+
+	for(CFIndex dex=0; dex<numChanges; dex++) {
+		CFDictionaryRef change = (CFDictionaryRef)CFArrayGetValueAtIndex(changes, dex);
+		if((change == NULL) || (CFGetTypeID(change) != CFDictionaryGetTypeID())) {
+			return paramErr;
+		}
+		CFTypeRef certValue = CFDictionaryGetValue(change, kSecTrustSettingsChangeCertificate);
+		SecCertificateRef certRef;
+		if(certValue == NULL) {
+			/* required, so a malformed change can't hit the default root setting */
+			return paramErr;
+		}
+		else if(certValue == kCFNull) {
+			certRef = kSecTrustSettingsDefaultRootCertSetting;
+		}
+		else if(CFGetTypeID(certValue) == SecCertificateGetTypeID()) {
+			certRef = (SecCertificateRef)certValue;
+		}
+		else {
+			return paramErr;
+		}
+		CFTypeRef remove = CFDictionaryGetValue(change, kSecTrustSettingsChangeRemove);
+		if((remove != NULL) && CFEqual(remove, kCFBooleanTrue)) {
+			/* throws if record not found */
+			ts->deleteTrustSettings(certRef);
+		}
+		else {
+			ts->setTrustSettings(certRef, 
+				CFDictionaryGetValue(change, kSecTrustSettingsChangeTrustSettings));
+		}
+	}
+	trustSettingsDbg("SecTrustSettingsApplyChanges: %ld changes to domain %d",
+		(long)numChanges, (int)domain);
+	ts->flushToDisk();
+	tsTrustSettingsChanged();
+	return noErr;
+
+	END_RCSAPI
+}
+
 #pragma mark --- API functions ---
 
 OSStatus SecTrustSettingsCopyTrustSettings(
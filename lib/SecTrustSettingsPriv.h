@@ -135,6 +135,39 @@ OSStatus SecTrustSettingsSetTrustSettingsExternal(
 	CFTypeRef			trustSettingsDictOrArray,	/* optional */
 	CFDataRef			*settingsOut);				/* RETURNED */
 
+/*
+ * Keys of the dictionaries passed to SecTrustSettingsApplyChanges().
+ *
+ * kSecTrustSettingsChangeCertificate:	SecCertificateRef, or kCFNull for 
+ *										the default root setting 
+ *										(kSecTrustSettingsDefaultRootCertSetting,
+ *										which can't be put in a dictionary);
+ *										required
+ * kSecTrustSettingsChangeTrustSettings: as in SecTrustSettingsSetTrustSettings(); 
+ *										absent for NULL
+ * kSecTrustSettingsChangeRemove:		kCFBooleanTrue to remove the cert's 
+ *										trust settings instead
+ */
+#define kSecTrustSettingsChangeCertificate		CFSTR("certificate")
+#define kSecTrustSettingsChangeTrustSettings	CFSTR("trustSettings")
+#define kSecTrustSettingsChangeRemove			CFSTR("remove")
+
+/*
+ * Make any number of SecTrustSettingsSetTrustSettings() and 
+ * SecTrustSettingsRemoveTrustSettings() changes to one domain at once. 
+ * Each element of changes is a dictionary describing one change, using 
+ * the keys above; they are applied in order. A change without a 
+ * kSecTrustSettingsChangeCertificate fails with paramErr. 
+ *
+ * The domain's settings are written, and other processes notified, just 
+ * once, after every change has been applied. If any change is invalid (or
+ * removes settings which don't exist), nothing is written and its error 
+ * is returned. 
+ */
+OSStatus SecTrustSettingsApplyChanges(
+	SecTrustSettingsDomain	domain,
+	CFArrayRef				changes);
+
 #ifdef __cplusplus
 }
 #endif
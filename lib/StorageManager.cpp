@@ -41,6 +41,7 @@
 #include <algorithm>
 #include <string>
 #include <stdio.h>
+#include <dispatch/dispatch.h>
 //#include <Security/AuthorizationTags.h>
 //#include <Security/AuthSession.h>
 #include <security_utilities/debugging.h>
@@ -829,6 +830,41 @@ StorageManager::getSearchList(SecPreferencesDomain domain, KeychainList &keychai
 	}
 }
 
+void
+StorageManager::prewarmSearchList()
+{
+	static dispatch_once_t prewarmed;
+	dispatch_once(&prewarmed, ^{
+		dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+			// making the search list makes each keychain in it
+			KeychainList searchList;
+			try
+			{
+				getSearchList(searchList);
+			}
+			catch (...)
+			{
+				return;
+			}
+
+			KeychainList *keychains = &searchList;
+			dispatch_apply(searchList.size(), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t ix) {
+				try
+				{
+					Keychain keychain = (*keychains)[ix];
+					KCCursorImpl::activateDatabase(keychain);
+					keychain->keychainSchema();
+				}
+				catch (...)
+				{
+					// never mind; a search will run into the same problem
+				}
+			});
+			secdebug("keychain", "prewarmed %lu search list keychains", (unsigned long)searchList.size());
+		});
+	});
+}
+
 void StorageManager::forceUserSearchListReread()
 {
 	mSavedList.forceUserSearchListReread();
@@ -102,6 +102,11 @@ public:
 	void setSearchList(const KeychainList &keychainList);
 	void forceUserSearchListReread ();
 
+	// Open the search list keychains, activate their databases and load
+	// their schemas on background threads, so that the first search doesn't
+	// have to.  Only the first call does anything.
+	void prewarmSearchList();
+
 	void getSearchList(SecPreferencesDomain domain, KeychainList &keychainList);
 	void setSearchList(SecPreferencesDomain domain, const KeychainList &keychainList);
 
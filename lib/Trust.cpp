@@ -26,6 +26,7 @@
 //
 #include <security_keychain/Trust.h>
 #include <security_keychain/TrustSettingsSchema.h>
+#include <security_keychain/SecTrustPriv.h>
 #include <security_cdsa_utilities/cssmdates.h>
 #include <security_utilities/cfutilities.h>
 #include <CoreFoundation/CoreFoundation.h>
@@ -34,6 +35,10 @@
 #include "SecBridge.h"
 #include "TrustAdditions.h"
 #include "TrustKeychains.h"
+#include "TrustDecisionCache.h"
+#include "cssmdatetime.h"
+#include <CommonCrypto/CommonDigest.h>
+#include <algorithm>
 
 
 using namespace Security;
@@ -103,6 +108,171 @@ RecursiveMutex& SecTrustKeychainsGetMutex()
 	return trustKeychainsMutex();
 }
 
+#pragma mark -- TrustSearchContext --
+
+//
+// TrustSearchContext is an immutable snapshot of the databases an evaluation
+// searches: the handles of a keychain search list, less the network-based
+// pseudo-keychains, and the root store and system keychain handles used with
+// trust settings. Building one takes the trust keychains mutex and a CSSM call
+// per keychain, so the most recently built are shared by all evaluations
+// until their search list changes.
+//
+class TrustSearchContext : public RefCount
+{
+public:
+	TrustSearchContext(const StorageManager::KeychainList &keychains, uint32 version);
+
+	bool matches(const StorageManager::KeychainList &keychains, uint32 version) const;
+
+	const vector<CSSM_DL_DB_HANDLE> &searchHandles() const	{ return mSearchHandles; }
+	bool hasRootStore() const							{ return mHasRootStore; }
+	const CSSM_DL_DB_HANDLE &rootStoreHandle() const	{ return mRootStoreHandle; }
+	const CSSM_DL_DB_HANDLE &systemKcHandle() const		{ return mSystemKcHandle; }
+
+private:
+	uint32 mVersion;
+	StorageManager::KeychainList mKeychains;	// held, to keep the handles valid
+	vector<CSSM_DL_DB_HANDLE> mSearchHandles;
+	bool mHasRootStore;
+	CSSM_DL_DB_HANDLE mRootStoreHandle;
+	CSSM_DL_DB_HANDLE mSystemKcHandle;
+};
+
+TrustSearchContext::TrustSearchContext(const StorageManager::KeychainList &keychains, uint32 version)
+	: mVersion(version), mKeychains(keychains), mHasRootStore(true),
+	  mRootStoreHandle(nullCSSMDLDBHandle), mSystemKcHandle(nullCSSMDLDBHandle)
+{
+	StLock<Mutex> _(SecTrustKeychainsGetMutex());
+	for (StorageManager::KeychainList::const_iterator it = mKeychains.begin();
+			it != mKeychains.end(); it++)
+	{
+		try
+		{
+			// For the purpose of looking up intermediate certificates to establish trust,
+			// do not include the network-based LDAP or DotMac pseudo-keychains. (The only
+			// time the network should be consulted for certificates is if there is an AIA
+			// extension with a specific URL, which will be handled by the TP code.)
+			CSSM_DL_DB_HANDLE dldbHandle = (*it)->database()->handle();
+			if (dldbHandle.DLHandle) {
+				CSSM_GUID guid = {};
+				CSSM_RETURN crtn = CSSM_GetModuleGUIDFromHandle(dldbHandle.DLHandle, &guid);
+				if (crtn == CSSM_OK) {
+					if ((memcmp(&guid, &gGuidAppleLDAPDL, sizeof(CSSM_GUID))==0) ||
+						(memcmp(&guid, &gGuidAppleDotMacDL, sizeof(CSSM_GUID))==0)) {
+						continue; // don't add to dlDbList
+					}
+				}
+			}
+			// This DB is OK to search for intermediate certificates.
+			mSearchHandles.push_back(dldbHandle);
+		}
+		catch (...)
+		{
+		}
+	}
+	try {
+		mRootStoreHandle = trustKeychains().rootStoreHandle();
+	}
+	catch (...) {
+		// no root store or system keychain; don't use trust settings but continue
+		mHasRootStore = false;
+	}
+	try {
+		mSystemKcHandle = trustKeychains().systemKcHandle();
+	}
+	catch(...) {
+		/* Oh well, at least we got the root store DB */
+	}
+}
+
+bool TrustSearchContext::matches(const StorageManager::KeychainList &keychains, uint32 version) const
+{
+	if (version != mVersion || keychains.size() != mKeychains.size())
+		return false;
+	for (StorageManager::KeychainList::size_type ix = 0; ix < keychains.size(); ix++)
+		if (keychains[ix].get() != mKeychains[ix].get())
+			return false;
+	return true;
+}
+
+//
+// The most recently used contexts, most recent first. The lock only covers
+// finding and retaining one; contexts are built and used outside it.
+//
+class TrustSearchContexts
+{
+public:
+	TrustSearchContexts() : mVersion(0) {}
+
+	RefPointer<TrustSearchContext> contextFor(const StorageManager::KeychainList &keychains);
+	void invalidate();
+
+private:
+	static const unsigned maxContexts = 4;
+
+	Mutex mMutex;
+	uint32 mVersion;		// bumped when the search list changes
+	vector< RefPointer<TrustSearchContext> > mContexts;
+};
+
+static ModuleNexus<TrustSearchContexts> trustSearchContexts;
+
+RefPointer<TrustSearchContext> TrustSearchContexts::contextFor(const StorageManager::KeychainList &keychains)
+{
+	uint32 version;
+	{
+		StLock<Mutex> _(mMutex);
+		for (vector< RefPointer<TrustSearchContext> >::iterator it = mContexts.begin(); it != mContexts.end(); it++)
+			if ((*it)->matches(keychains, mVersion)) {
+				RefPointer<TrustSearchContext> context = *it;
+				mContexts.erase(it);
+				mContexts.insert(mContexts.begin(), context);
+				return context;
+			}
+		version = mVersion;
+	}
+
+	RefPointer<TrustSearchContext> context = new TrustSearchContext(keychains, version);
+	StLock<Mutex> _(mMutex);
+	if (version == mVersion) {
+		mContexts.insert(mContexts.begin(), context);
+		if (mContexts.size() > maxContexts)
+			mContexts.pop_back();
+	}
+	return context;
+}
+
+void TrustSearchContexts::invalidate()
+{
+	StLock<Mutex> _(mMutex);
+	mVersion++;
+	mContexts.clear();
+}
+
+void SecTrustKeychainsSearchListChanged()
+{
+	trustSearchContexts().invalidate();
+}
+
+//
+// Bumped whenever the certificates in any keychain, or the search list, change.
+// Protected by the trust keychains mutex.
+//
+static uint32 trustKeychainsCertGeneration = 0;
+
+void SecTrustKeychainsCertificatesChanged()
+{
+	StLock<Mutex> _(SecTrustKeychainsGetMutex());
+	trustKeychainsCertGeneration++;
+}
+
+uint32 SecTrustKeychainsCertificatesGeneration()
+{
+	StLock<Mutex> _(SecTrustKeychainsGetMutex());
+	return trustKeychainsCertGeneration;
+}
+
 #pragma mark -- Trust --
 //
 // Construct a Trust object with suitable defaults.
@@ -145,11 +315,44 @@ CssmData cfCertificateData(SecCertificateRef certificate)
     return Certificate::required(certificate)->data();
 }
 
-// SecPolicyRef -> CssmField (CFDataRef/NULL or oid/value of a SecPolicy)
+// SecPolicyRef -> CssmField (the oid/value of a SecPolicy, kept with its value)
 CssmField cfField(SecPolicyRef item)
 {
 	SecPointer<Policy> policy = Policy::required(SecPolicyRef(item));
-    return CssmField(policy->oid(), policy->value());
+    return policy->field();
+}
+
+//
+// A CSSM-layer array built from the elements of a CFArray, like CFToVector,
+// but with room for a typical evaluation's certificates or policies inline,
+// so that building the CertGroup and verify context doesn't hit the heap.
+// The elements share the underlying objects' storage (see cfCertificateData);
+// nothing is copied.
+//
+template <class VectorBase, class CFRefType, VectorBase convert(CFRefType), uint32 inlineCount = 8>
+class CFToInlineVector {
+public:
+	CFToInlineVector(CFArrayRef arrayRef);
+	~CFToInlineVector()				{ if (mVector != mInline) delete[] mVector; }
+
+	operator uint32 () const		{ return mCount; }
+	operator VectorBase *() const	{ return mVector; }
+	bool empty() const				{ return mCount == 0; }
+
+private:
+	uint32 mCount;
+	VectorBase *mVector;
+	VectorBase mInline[inlineCount];
+};
+
+template <class VectorBase, class CFRefType, VectorBase convert(CFRefType), uint32 inlineCount>
+CFToInlineVector<VectorBase, CFRefType, convert, inlineCount>::CFToInlineVector(CFArrayRef arrayRef)
+	: mCount(arrayRef ? uint32(CFArrayGetCount(arrayRef)) : 0), mVector(mInline)
+{
+	if (mCount > inlineCount)
+		mVector = new VectorBase[mCount];
+	for (uint32 n = 0; n < mCount; n++)
+		mVector[n] = convert(CFRefType(CFArrayGetValueAtIndex(arrayRef, n)));
 }
 
 // SecKeychain -> CssmDlDbHandle
@@ -180,6 +383,16 @@ void Trust::evaluate(bool disableEV)
 	// if we have evaluated before, release prior result
 	clearResults();
 
+	// the same evaluation may already have been made, perhaps in another process
+	TrustDecisionCache &decisions = gTrustDecisionCache();
+	std::string decisionKey, decisionEnvironment;
+	if (decisions.enabled()) {
+		decisionKey = decisionCacheKey(disableEV);
+		decisionEnvironment = TrustDecisionCache::environment(mSearchLibs);
+		if (restoreDecision(decisionKey, decisionEnvironment))
+			return;
+	}
+
 	// determine whether the leaf certificate is an EV candidate
 	CFArrayRef allowedAnchors = allowedEVRootsForLeafCertificate(mCerts);
 	CFArrayRef filteredCerts = NULL;
@@ -216,7 +429,7 @@ void Trust::evaluate(bool disableEV)
 	}
 
     // build the target cert group
-    CFToVector<CssmData, SecCertificateRef, cfCertificateData> subjects(mFilteredCerts);
+    CFToInlineVector<CssmData, SecCertificateRef, cfCertificateData> subjects(mFilteredCerts);
     CertGroup subjectCertGroup(CSSM_CERT_X_509v3,
             CSSM_CERT_ENCODING_BER, CSSM_CERTGROUP_DATA);
     subjectCertGroup.count() = subjects;
@@ -288,14 +501,14 @@ void Trust::evaluate(bool disableEV)
 		allPolicies = CFMutableArrayRef(CFArrayRef(mPolicies));
 	}
 	orderRevocationPolicies(allPolicies);
-    CFToVector<CssmField, SecPolicyRef, cfField> policies(allPolicies);
+    CFToInlineVector<CssmField, SecPolicyRef, cfField> policies(allPolicies);
     if (policies.empty())
         MacOSError::throwMe(CSSMERR_TP_INVALID_POLICY_IDENTIFIERS);
     context.setPolicies(policies, policies);
 
 	// anchor certificates (if caller provides them, or if cert requires EV)
 	CFCopyRef<CFArrayRef> anchors(mAllowedAnchors);
-	CFToVector<CssmData, SecCertificateRef, cfCertificateData> roots(anchors);
+	CFToInlineVector<CssmData, SecCertificateRef, cfCertificateData> roots(anchors);
 	if (!anchors) {
 		// no anchor certificates were provided;
 		// built-in anchors will be trusted unless explicitly disabled.
@@ -313,60 +526,24 @@ void Trust::evaluate(bool disableEV)
 		context.anchors(roots, roots);
 	}
 
-	// dlDbList (keychain list)
-	vector<CSSM_DL_DB_HANDLE> dlDbList;
-	{
-		StLock<Mutex> _(SecTrustKeychainsGetMutex());
-		for (StorageManager::KeychainList::const_iterator it = mSearchLibs.begin();
-				it != mSearchLibs.end(); it++)
-		{
-			try
-			{
-				// For the purpose of looking up intermediate certificates to establish trust,
-				// do not include the network-based LDAP or DotMac pseudo-keychains. (The only
-				// time the network should be consulted for certificates is if there is an AIA
-				// extension with a specific URL, which will be handled by the TP code.)
-				CSSM_DL_DB_HANDLE dldbHandle = (*it)->database()->handle();
-				if (dldbHandle.DLHandle) {
-					CSSM_GUID guid = {};
-					CSSM_RETURN crtn = CSSM_GetModuleGUIDFromHandle(dldbHandle.DLHandle, &guid);
-					if (crtn == CSSM_OK) {
-						if ((memcmp(&guid, &gGuidAppleLDAPDL, sizeof(CSSM_GUID))==0) ||
-							(memcmp(&guid, &gGuidAppleDotMacDL, sizeof(CSSM_GUID))==0)) {
-							continue; // don't add to dlDbList
-						}
-					}
-				}
-				// This DB is OK to search for intermediate certificates.
-				dlDbList.push_back(dldbHandle);
-			}
-			catch (...)
-			{
-			}
+	// dlDbList (keychain list), from a snapshot which also keeps the keychains open
+	RefPointer<TrustSearchContext> searchContext = trustSearchContexts().contextFor(mSearchLibs);
+	vector<CSSM_DL_DB_HANDLE> dlDbList(searchContext->searchHandles());
+	if(mUsingTrustSettings) {
+		/* Append system anchors for use with Trust Settings */
+		if (searchContext->hasRootStore()) {
+			if (searchContext->rootStoreHandle().DBHandle)
+				dlDbList.push_back(searchContext->rootStoreHandle());
+			actionDataP->ActionFlags |= CSSM_TP_ACTION_TRUST_SETTINGS;
 		}
-		if(mUsingTrustSettings) {
-			/* Append system anchors for use with Trust Settings */
-			try {
-				CSSM_DL_DB_HANDLE rootStoreHandle = trustKeychains().rootStoreHandle();
-				if (rootStoreHandle.DBHandle)
-					dlDbList.push_back(rootStoreHandle);
-				actionDataP->ActionFlags |= CSSM_TP_ACTION_TRUST_SETTINGS;
-			}
-			catch (...) {
-				// no root store or system keychain; don't use trust settings but continue
-				mUsingTrustSettings = false;
-			}
-			try {
-				CSSM_DL_DB_HANDLE systemKcHandle = trustKeychains().systemKcHandle();
-				if (systemKcHandle.DBHandle)
-					dlDbList.push_back(systemKcHandle);
-			}
-			catch(...) {
-				/* Oh well, at least we got the root store DB */
-			}
+		else {
+			// no root store or system keychain; don't use trust settings but continue
+			mUsingTrustSettings = false;
 		}
-		context.setDlDbList(dlDbList.size(), &dlDbList[0]);
+		if (searchContext->systemKcHandle().DBHandle)
+			dlDbList.push_back(searchContext->systemKcHandle());
 	}
+	context.setDlDbList(dlDbList.size(), &dlDbList[0]);
 
     // verification time
     char timeString[15];
@@ -376,10 +553,6 @@ void Trust::evaluate(bool disableEV)
         context.time(timeString);
     }
 
-	// to avoid keychain open/close thrashing, hold a copy of the search list
-	StorageManager::KeychainList holdSearchList;
-	globals().storageManager.getSearchList(holdSearchList);
-
     // Go TP!
     try {
         mTP->certGroupVerify(subjectCertGroup, context, &mTpResult);
@@ -404,16 +577,17 @@ void Trust::evaluate(bool disableEV)
         secdebug("trusteval", "unexpected evidence ignored");
     }
 
-	/* do post-processing for the evaluated certificate chain */
-	CFArrayRef fullChain = makeCFArray(convert, mCertChain);
-	CFDictionaryRef etResult = extendedTrustResults(fullChain, mResult, mTpReturn, isEVCandidate);
+	/* do post-processing for the evaluated certificate chain;
+	 * only EV checking needs it as a CFArray */
+	CFDictionaryRef etResult = extendedTrustResults(
+		(isEVCandidate) ? certificateChain() : NULL, mResult, mTpReturn, isEVCandidate);
 	mExtendedResult = etResult; // assignment to CFRef type is an implicit retain
 	if (etResult) {
 		CFRelease(etResult);
 	}
-	if (fullChain) {
-		CFRelease(fullChain);
-	}
+
+	if (!decisionKey.empty())
+		saveDecision(decisionKey, decisionEnvironment, revocationPolicySpecified(allPolicies));
 
 	/* Clean up Policies we created implicitly */
 	if(numSpecAdded) {
@@ -533,6 +707,7 @@ void Trust::evaluateUserTrust(const CertGroup &chain,
 {
 	StLock<Mutex>_(mMutex);
     // extract cert chain as Certificate objects
+    mCertChainArray = NULL;
     mCertChain.resize(chain.count());
     for (uint32 n = 0; n < mCertChain.size(); n++) {
         const TPEvidenceInfo &info = TPEvidenceInfo::overlay(infoList[n]);
@@ -641,9 +816,229 @@ void Trust::clearResults()
 		releaseTPEvidence(mTpResult, mTP.allocator());
 		mResult = kSecTrustResultInvalid;
 	}
+	mCertChainArray = NULL;
 }
 
 
+//
+// The evaluated certificate chain as a CFArray of SecCertificateRefs.
+// Built on first use and kept until the chain changes; most evaluations
+// never ask for it. Caller must hold mMutex.
+//
+CFArrayRef Trust::certificateChain()
+{
+	if (!mCertChainArray) {
+		CFArrayRef chain = makeCFArray(convert, mCertChain);
+		mCertChainArray = chain;	// implicit retain
+		CFRelease(chain);
+	}
+	return mCertChainArray;
+}
+
+
+//
+// A digest of everything evaluate() takes from this Trust: the certificates,
+// policies, anchors, action, verify time and keychains. Caller must hold mMutex.
+//
+std::string Trust::decisionCacheKey(bool disableEV)
+{
+	CC_SHA1_CTX ctx;
+	CC_SHA1_Init(&ctx);
+	CssmData actionData = mActionData ? cfData(mActionData) : CssmData();
+	uint32 header[5] = { 1, disableEV, mAction, mAnchorPolicy, uint32(actionData.length()) };
+	CC_SHA1_Update(&ctx, header, sizeof(header));
+	CC_SHA1_Update(&ctx, actionData.data(), (CC_LONG)actionData.length());
+	CFAbsoluteTime verifyTime = mVerifyTime ? CFDateGetAbsoluteTime(mVerifyTime) : 0;
+	uint8 hasVerifyTime = mVerifyTime ? 1 : 0;
+	CC_SHA1_Update(&ctx, &hasVerifyTime, sizeof(hasVerifyTime));
+	CC_SHA1_Update(&ctx, &verifyTime, sizeof(verifyTime));
+
+	// each variable-length part is preceded by its length, so no two inputs run together
+	CFArrayRef arrays[2] = { mCerts, mAnchors };
+	for (unsigned a = 0; a < 2; a++) {
+		uint32 count = arrays[a] ? uint32(CFArrayGetCount(arrays[a])) + 1 : 0;
+		CC_SHA1_Update(&ctx, &count, sizeof(count));
+		for (uint32 n = 0; n + 1 < count; n++) {
+			CssmData data = cfCertificateData(SecCertificateRef(CFArrayGetValueAtIndex(arrays[a], n)));
+			uint32 length = uint32(data.length());
+			CC_SHA1_Update(&ctx, &length, sizeof(length));
+			CC_SHA1_Update(&ctx, data.data(), length);
+		}
+	}
+	CFIndex policyCount = mPolicies ? CFArrayGetCount(mPolicies) : 0;
+	for (CFIndex n = 0; n < policyCount; n++) {
+		SecPointer<Policy> policy = Policy::required(SecPolicyRef(CFArrayGetValueAtIndex(mPolicies, n)));
+		const CssmData *parts[2] = { &policy->oid(), &policy->value() };
+		for (unsigned p = 0; p < 2; p++) {
+			uint32 length = uint32(parts[p]->length());
+			CC_SHA1_Update(&ctx, &length, sizeof(length));
+			CC_SHA1_Update(&ctx, parts[p]->data(), length);
+		}
+	}
+	for (StorageManager::KeychainList::const_iterator it = mSearchLibs.begin(); it != mSearchLibs.end(); it++)
+		CC_SHA1_Update(&ctx, (*it)->name(), (CC_LONG)strlen((*it)->name()) + 1);
+
+	uint8 digest[CC_SHA1_DIGEST_LENGTH];
+	CC_SHA1_Final(digest, &ctx);
+	return std::string((const char *)digest, sizeof(digest));
+}
+
+//
+// Re-create the results of an earlier evaluation from the decision cache:
+// TP evidence in the Apple format (as the TP allocates it, so that
+// releaseTPEvidence can dispose of it), the certificate chain, and the
+// extended results. Caller must hold mMutex.
+//
+bool Trust::restoreDecision(const std::string &key, const std::string &environment)
+{
+	TrustDecisionCache::Decision decision;
+	if (!gTrustDecisionCache().find(key, environment, decision) || decision.chain.empty())
+		return false;
+	secdebug("trustcache", "Trust::evaluate() using cached decision %d", (int)decision.result);
+
+	Allocator &allocator = mTP.allocator();
+	uint32 count = uint32(decision.chain.size());
+	CSSM_TP_APPLE_EVIDENCE_HEADER *header = allocator.alloc<CSSM_TP_APPLE_EVIDENCE_HEADER>();
+	header->Version = CSSM_TP_APPLE_EVIDENCE_VERSION;
+	CSSM_CERTGROUP *certGroup = allocator.alloc<CSSM_CERTGROUP>();
+	memset(certGroup, 0, sizeof(*certGroup));
+	certGroup->CertType = CSSM_CERT_X_509v3;
+	certGroup->CertEncoding = CSSM_CERT_ENCODING_BER;
+	certGroup->CertGroupType = CSSM_CERTGROUP_DATA;
+	certGroup->NumCerts = count;
+	certGroup->GroupList.CertList = allocator.alloc<CSSM_DATA>(count);
+	CSSM_TP_APPLE_EVIDENCE_INFO *info = allocator.alloc<CSSM_TP_APPLE_EVIDENCE_INFO>(count);
+	memset(info, 0, sizeof(*info) * count);
+	for (uint32 n = 0; n < count; n++) {
+		const std::string &der = decision.chain[n];
+		CSSM_DATA &blob = certGroup->GroupList.CertList[n];
+		blob.Length = der.size();
+		blob.Data = allocator.alloc<uint8>(UInt32(der.size()));
+		memcpy(blob.Data, der.data(), der.size());
+		const TrustDecisionCache::Evidence &evidence = decision.evidence[n];
+		info[n].StatusBits = evidence.status;
+		info[n].Index = evidence.index;
+		info[n].NumStatusCodes = uint32(evidence.statusCodes.size());
+		if (info[n].NumStatusCodes) {
+			info[n].StatusCodes = allocator.alloc<CSSM_RETURN>(info[n].NumStatusCodes);
+			memcpy(info[n].StatusCodes, &evidence.statusCodes[0], sizeof(CSSM_RETURN) * info[n].NumStatusCodes);
+		}
+	}
+	mTpResult.NumberOfEvidences = 3;
+	mTpResult.Evidence = allocator.alloc<CSSM_EVIDENCE>(3);
+	mTpResult.Evidence[0].EvidenceForm = CSSM_EVIDENCE_FORM_APPLE_HEADER;
+	mTpResult.Evidence[0].Evidence = header;
+	mTpResult.Evidence[1].EvidenceForm = CSSM_EVIDENCE_FORM_APPLE_CERTGROUP;
+	mTpResult.Evidence[1].Evidence = certGroup;
+	mTpResult.Evidence[2].EvidenceForm = CSSM_EVIDENCE_FORM_APPLE_CERT_INFO;
+	mTpResult.Evidence[2].Evidence = info;
+
+	// the chain, sharing Certificates with our inputs where we can
+	mCertChain.resize(count);
+	for (uint32 n = 0; n < count; n++) {
+		CssmData der(const_cast<char *>(decision.chain[n].data()), decision.chain[n].size());
+		CFArrayRef sources[2] = { mCerts, mAnchors };
+		for (unsigned s = 0; s < 2 && !mCertChain[n]; s++) {
+			CFIndex sourceCount = sources[s] ? CFArrayGetCount(sources[s]) : 0;
+			for (CFIndex i = 0; i < sourceCount; i++) {
+				SecCertificateRef cert = SecCertificateRef(CFArrayGetValueAtIndex(sources[s], i));
+				if (cfCertificateData(cert) == der) {
+					mCertChain[n] = Certificate::required(cert);
+					break;
+				}
+			}
+		}
+		if (!mCertChain[n])
+			mCertChain[n] = new Certificate(der, CSSM_CERT_X_509v3, CSSM_CERT_ENCODING_BER);
+	}
+
+	mResult = decision.result;
+	mTpReturn = decision.tpReturn;
+	mUsingTrustSettings = decision.usingTrustSettings;
+	mFilteredCerts = mCerts.get();
+	mAllowedAnchors = mAnchors.get();
+
+	CFRef<CFDictionaryRef> etResult(extendedTrustResults(NULL, mResult, mTpReturn, false));
+	if (etResult && !decision.evOrganization.empty()) {
+		CFRef<CFMutableDictionaryRef> result(CFDictionaryCreateMutableCopy(NULL, 0, etResult));
+		CFRef<CFStringRef> organization(CFStringCreateWithBytes(NULL,
+			(const UInt8 *)decision.evOrganization.data(), decision.evOrganization.size(),
+			kCFStringEncodingUTF8, false));
+		if (result && organization) {
+			CFDictionarySetValue(result, kSecEVOrganizationName, organization);
+			etResult = result.get();
+		}
+	}
+	mExtendedResult = etResult.get();
+	return true;
+}
+
+//
+// Record the outcome of the evaluation just made, if it is one worth
+// reusing. Only definitive failures are kept (see TrustDecisionCache.h
+// for why successes never are), and only until the earliest
+// of the extended result's expiration, the end of the chain's validity and,
+// if revocation was checked, the next update of the revocation information
+// it relied on. Caller must hold mMutex.
+//
+void Trust::saveDecision(const std::string &key, const std::string &environment,
+	bool checkedRevocation)
+{
+	if (!TrustDecisionCache::cacheable(mResult))
+		return;
+	if (mTpResult.count() != 3 || mTpResult[1].form() != CSSM_EVIDENCE_FORM_APPLE_CERTGROUP
+			|| mTpResult[2].form() != CSSM_EVIDENCE_FORM_APPLE_CERT_INFO)
+		return;
+	const CertGroup &chain = *mTpResult[1].as<CertGroup>();
+	const CSSM_TP_APPLE_EVIDENCE_INFO *infoList = mTpResult[2].as<CSSM_TP_APPLE_EVIDENCE_INFO>();
+	if (chain.count() == 0 || chain.count() != mCertChain.size())
+		return;
+
+	TrustDecisionCache::Decision decision;
+	decision.result = mResult;
+	decision.tpReturn = mTpReturn;
+	decision.usingTrustSettings = mUsingTrustSettings;
+	decision.expires = CFAbsoluteTimeGetCurrent() + (60*60*2);
+	if (mExtendedResult) {
+		CFDateRef expiration = (CFDateRef)CFDictionaryGetValue(mExtendedResult, kSecTrustExpirationDate);
+		if (expiration)
+			decision.expires = CFDateGetAbsoluteTime(expiration);
+		CFStringRef organization = (CFStringRef)CFDictionaryGetValue(mExtendedResult, kSecEVOrganizationName);
+		if (organization)
+			decision.evOrganization = cfString(organization);
+	}
+	decision.chain.resize(chain.count());
+	decision.evidence.resize(chain.count());
+	for (uint32 n = 0; n < chain.count(); n++) {
+		const CssmData &der = chain.blobCerts()[n];
+		decision.chain[n].assign((const char *)der.data(), der.length());
+		const TPEvidenceInfo &info = TPEvidenceInfo::overlay(infoList[n]);
+		TrustDecisionCache::Evidence &evidence = decision.evidence[n];
+		evidence.status = info.status();
+		evidence.index = info.index();
+		evidence.statusCodes.assign(info.StatusCodes, info.StatusCodes + info.NumStatusCodes);
+
+		// no later than this certificate's notAfter
+		CSSM_DATA_PTR notAfter = mCertChain[n]->copyFirstFieldValue(CSSMOID_X509V1ValidityNotAfter);
+		CFDateRef date = NULL;
+		if (notAfter && notAfter->Length == sizeof(CSSM_X509_TIME)) {
+			const CSSM_X509_TIME *time = (const CSSM_X509_TIME *)notAfter->Data;
+			CSSMDateTimeUtils::CssmDateStringToCFDate((const char *)time->time.Data,
+				(unsigned)time->time.Length, &date);
+		}
+		if (notAfter)
+			mCertChain[n]->releaseFieldValue(CSSMOID_X509V1ValidityNotAfter, notAfter);
+		if (!date)
+			return;		// can't tell how long it's good for
+		decision.expires = std::min(decision.expires, CFDateGetAbsoluteTime(date));
+		CFRelease(date);
+	}
+	if (checkedRevocation && !boundByRevocation(infoList, decision.expires))
+		return;		// can't tell how long its revocation status is good for
+	if (decision.expires > CFAbsoluteTimeGetCurrent())
+		gTrustDecisionCache().add(key, environment, decision);
+}
+
 //
 // Build evidence information
 //
@@ -652,8 +1047,9 @@ void Trust::buildEvidence(CFArrayRef &certChain, TPEvidenceInfo * &statusChain)
 	StLock<Mutex>_(mMutex);
 	if (mResult == kSecTrustResultInvalid)
 		MacOSError::throwMe(errSecTrustNotAvailable);
-    certChain = mEvidenceReturned =
-        makeCFArray(convert, mCertChain);
+    certChain = mEvidenceReturned = certificateChain();
+	if (certChain)
+		CFRetain(certChain);	// caller owns a reference, as from makeCFArray
 	if(mTpResult.count() >= 3) {
 		statusChain = mTpResult[2].as<TPEvidenceInfo>();
 	}
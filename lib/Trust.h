@@ -36,6 +36,7 @@
 #include <security_keychain/Policies.h>
 #include <security_keychain/TrustStore.h>
 #include <vector>
+#include <string>
 
 using namespace CssmClient;
 
@@ -100,6 +101,13 @@ private:
         const CSSM_TP_APPLE_EVIDENCE_INFO *info,
 		CFCopyRef<CFArrayRef> anchors);
 	void clearResults();
+	CFArrayRef certificateChain();
+
+	/* persistent decision cache support */
+	std::string decisionCacheKey(bool disableEV);
+	bool restoreDecision(const std::string &key, const std::string &environment);
+	void saveDecision(const std::string &key, const std::string &environment,
+		bool checkedRevocation);
 	
 	Keychain keychainByDLDb(const CSSM_DL_DB_HANDLE &handle);
 
@@ -122,6 +130,8 @@ private:
 	CFMutableArrayRef	forceRevocationPolicies(uint32 &numAdded, 
 							Allocator &alloc,
 							bool requirePerCert=false);
+	bool				boundByRevocation(const CSSM_TP_APPLE_EVIDENCE_INFO *infoList,
+							CFAbsoluteTime &expires);
 	
 private:
     TP mTP;							// our TP
@@ -143,6 +153,7 @@ private:
     StorageManager::KeychainList mSearchLibsUsed; // augmented mSearchLibs used
 
     vector< SecPointer<Certificate> > mCertChain; // distilled certificate chain
+    CFRef<CFArrayRef> mCertChainArray;	// mCertChain as a CFArray, built on demand
 
     // information returned to caller but owned by us
     CFRef<CFArrayRef> mEvidenceReturned;	// evidence chain returned
@@ -26,6 +26,7 @@
 //
 #include "TrustAdditions.h"
 #include "TrustKeychains.h"
+#include "AnchorBundle.h"
 #include "SecBridge.h"
 #include <security_keychain/SecCFTypes.h>
 #include <security_keychain/Globals.h>
@@ -48,6 +49,7 @@
 #include "SecTrustPriv.h"
 #include "SecTrustSettings.h"
 #include "SecTrustSettingsPriv.h"
+#include <libDER/DER_OidTable.h>
 
 //
 // Macros
@@ -183,6 +185,15 @@ static SecKeychainRef systemRootStore()
 	return systemRoots;
 }
 
+// returns a SecCertificateRef for a root certificate found in the anchor bundle;
+// caller must release
+//
+static SecCertificateRef anchorBundleCertificate(const CssmData &certData)
+{
+	SecPointer<Certificate> certificate(new Certificate(certData, CSSM_CERT_X_509v3, CSSM_CERT_ENCODING_BER));
+	return certificate->handle();
+}
+
 // returns a CFDictionaryRef created from the specified XML plist file; caller must release
 //
 static CFDictionaryRef dictionaryWithContentsOfPlistFile(const char *fileName)
@@ -392,9 +403,10 @@ static SecCertificateRef _rootCertificateWithSubjectOfCertificate(SecCertificate
 	if (status)
 		return NULL;
 
-	// get system roots keychain reference
-    SecKeychainRef systemRoots = systemRootStore();
-	if (!systemRoots)
+	// get system roots keychain reference, unless the anchor bundle can answer
+	AnchorBundle &anchors = gAnchorBundle();
+    SecKeychainRef systemRoots = (anchors.valid()) ? NULL : systemRootStore();
+	if (!systemRoots && !anchors.valid())
 		return NULL;
 
     // copy (normalized) subject for the provided certificate
@@ -427,7 +439,15 @@ static SecCertificateRef _rootCertificateWithSubjectOfCertificate(SecCertificate
 			} else {
 				CC_SHA1(cssmKey->KeyData.Data, cssmKey->KeyData.Length, buf);
 			}
-            if (!status) {
+            if (!status && anchors.valid()) {
+                CssmData rootData;
+                BEGIN_SECAPI_INTERNAL_CALL
+                if (anchors.findBySubjectAndKey(CssmData::overlay(*subjectDataPtr),
+                        CssmData::overlay(digest), rootData))
+                    resultCert = anchorBundleCertificate(rootData); // caller must release
+                END_SECAPI_INTERNAL_CALL
+            }
+            else if (!status) {
                 // set up attribute vector (each attribute consists of {tag, length, pointer})
                 // we want to match on the public key hash and the normalized subject name
                 // as well as ensure that the issuer matches the subject
@@ -516,6 +536,17 @@ static SecCertificateRef _rootCertificateWithSubjectKeyIDOfCertificate(SecCertif
 
 	StLock<Mutex> _(SecTrustKeychainsGetMutex());
 
+	AnchorBundle &anchors = gAnchorBundle();
+	if (anchors.valid()) {
+		BEGIN_SECAPI_INTERNAL_CALL
+		CssmData rootData;
+		const CssmData &subjectKeyID = Certificate::required(certificate)->subjectKeyIdentifier();
+		if (anchors.findBySubjectKeyID(subjectKeyID, rootData))
+			resultCert = anchorBundleCertificate(rootData); // caller must release
+		END_SECAPI_INTERNAL_CALL
+		return resultCert;
+	}
+
 	// get system roots keychain reference
     SecKeychainRef systemRoots = systemRootStore();
 	if (!systemRoots)
@@ -554,8 +585,9 @@ CFArrayRef _possibleRootCertificatesForOidString(CFStringRef oidString)
 	if (!evOidDict)
 		return NULL;
 	CFArrayRef possibleCertificateHashes = (CFArrayRef) CFDictionaryGetValue(evOidDict, oidString);
-    SecKeychainRef systemRoots = systemRootStore();
-    if (!possibleCertificateHashes || !systemRoots) {
+	AnchorBundle &anchors = gAnchorBundle();
+    SecKeychainRef systemRoots = (anchors.valid()) ? NULL : systemRootStore();
+    if (!possibleCertificateHashes || (!systemRoots && !anchors.valid())) {
 		SafeCFRelease(&evOidDict);
         return NULL;
 	}
@@ -565,6 +597,27 @@ CFArrayRef _possibleRootCertificatesForOidString(CFStringRef oidString)
 	secdebug("evTrust", "_possibleRootCertificatesForOidString: %d possible hashes", (int)hashCount);
 
 	OSStatus status = noErr;
+	if (anchors.valid()) {
+		// look each hash up directly rather than hashing every root
+		for (CFIndex idx = 0; idx < hashCount; idx++) {
+			CFDataRef hashData = (CFDataRef) CFArrayGetValueAtIndex(possibleCertificateHashes, idx);
+			CssmData rootData;
+			if (!anchors.findBySHA1(CssmData(const_cast<UInt8 *>(CFDataGetBytePtr(hashData)),
+					CFDataGetLength(hashData)), rootData))
+				continue;
+			SecCertificateRef rootCert = NULL;
+			BEGIN_SECAPI_INTERNAL_CALL
+			rootCert = anchorBundleCertificate(rootData);
+			END_SECAPI_INTERNAL_CALL
+			if (rootCert) {
+				CFArrayAppendValue(possibleRootCertificates, rootCert);
+				CFRelease(rootCert);
+			}
+		}
+		SafeCFRelease(&evOidDict);
+		return possibleRootCertificates;
+	}
+
 	SecKeychainSearchRef searchRef = NULL;
 	// note: Sec* APIs are not re-entrant due to the API lock
 	// status = SecKeychainSearchCreateFromAttributes(systemRoots, kSecCertificateItemClass, NULL, &searchRef);
@@ -975,7 +1028,10 @@ static CFDictionaryRef _evCAOidDict()
 	}
 	secdebug("evTrust", "_evCAOidDict: initializing static instance");
 
-	s_evCAOidDict = dictionaryWithContentsOfPlistFile(EV_ROOTS_PLIST_SYSTEM_PATH);
+	if (gAnchorBundle().valid())
+		s_evCAOidDict = gAnchorBundle().copyEVPolicies();
+	else
+		s_evCAOidDict = dictionaryWithContentsOfPlistFile(EV_ROOTS_PLIST_SYSTEM_PATH);
 	if (!s_evCAOidDict)
 		return NULL;
     
@@ -1000,13 +1056,30 @@ static CFDictionaryRef _evCAOidDict()
     return s_evCAOidDict;
 }
 
+static ModuleNexus<Mutex> gOidStringForCertificatePoliciesMutex;
+
+// interned decimal representations of the OIDs known to libDER;
+// protected by gOidStringForCertificatePoliciesMutex
+static CFStringRef gKnownOidStrings[DOID_Count];
+
 // returns a CFStringRef containing a decimal representation of the given OID.
-// Caller must release.
+// Caller must release. Caller must hold gOidStringForCertificatePoliciesMutex.
 
 static CFStringRef _decimalStringForOid(CSSM_OID_PTR oid)
 {
+    // known OIDs are converted once, then just retained
+    DERItem derOid = { oid->Data, (DERSize)oid->Length };
+    DEROidID oidID = DEROidLookup(&derOid);
+    if (oidID != DOID_Unknown) {
+        if (!gKnownOidStrings[oidID]) {
+            gKnownOidStrings[oidID] = CFStringCreateWithCString(NULL,
+                DEROidStrings[oidID], kCFStringEncodingASCII);
+        }
+        return (gKnownOidStrings[oidID]) ? (CFStringRef)CFRetain(gKnownOidStrings[oidID]) : NULL;
+    }
+
     CFMutableStringRef str = CFStringCreateMutable(NULL, 0);
-    if (!str || oid->Length > 32)
+    if (!str || oid->Length == 0 || oid->Length > 32)
         return str;
 
     // The first two levels are encoded into one byte, since the root level
@@ -1052,8 +1125,6 @@ static void _freeFieldData(CSSM_DATA_PTR value, CSSM_OID_PTR oid, CSSM_CL_HANDLE
     return;
 }
 
-static ModuleNexus<Mutex> gOidStringForCertificatePoliciesMutex;
-
 static CFStringRef _oidStringForCertificatePolicies(const CE_CertPolicies *certPolicies)
 {
 	StLock<Mutex> _(gOidStringForCertificatePoliciesMutex());
@@ -1082,7 +1153,8 @@ static CFStringRef _oidStringForCertificatePolicies(const CE_CertPolicies *certP
         CFStringRef oidStr = _decimalStringForOid(oid);
 		if (!oidStr)
 			continue;
-		if (!CFStringCompare(oidStr, CFSTR("2.5.29.32.0"), 0) ||	// is it the "any" OID, or
+		DERItem derOid = { oid->Data, (DERSize)oid->Length };
+		if (DEROidLookup(&derOid) == DOID_AnyPolicy ||				// is it the "any" OID, or
 			CFDictionaryGetValue(evOidDict, oidStr) != NULL) {		// a known EV CA OID?
 			foundOidStr = CFStringCreateCopy(NULL, oidStr);
 		}
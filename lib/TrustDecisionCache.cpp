@@ -0,0 +1,574 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+//
+// TrustDecisionCache.cpp - persistent cache of trust evaluation outcomes
+//
+#include "TrustDecisionCache.h"
+#include <security_keychain/TrustSettingsSchema.h>
+#include <security_keychain/SecTrustPriv.h>
+#include <security_utilities/debugging.h>
+#include <CommonCrypto/CommonDigest.h>
+#include <CommonCrypto/CommonHMAC.h>
+#include <Security/SecRandom.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <errno.h>
+#include <pwd.h>
+#include <algorithm>
+
+namespace Security {
+namespace KeychainCore {
+
+
+ModuleNexus<TrustDecisionCache> gTrustDecisionCache;
+
+static const char *CACHE_FILE = "Library/Caches/com.apple.security.trustdecisions";
+static const char *KEY_SUFFIX = ".key";
+static const size_t keySize = 32;
+static const char *EV_ROOTS_PATH = "/System/Library/Keychains/EVRoots.plist";
+static const size_t maxCacheSize = 1024 * 1024;
+
+
+//
+// File layout: a FileHeader, then records, each a RecordHeader followed by
+// its payload, padded to a multiple of 8 bytes. Host byte order.
+//
+static const uint32 kFileMagic = 'tdc1';
+static const uint32 kFileVersion = 3;
+static const uint32 kRecordMagic = 'tdcr';
+
+struct FileHeader {
+	uint32 magic;
+	uint32 version;
+};
+
+struct RecordHeader {
+	int64 expires;						// CFAbsoluteTime, whole seconds
+	uint32 magic;
+	uint32 length;						// of the payload, unpadded
+	uint8 key[CC_SHA1_DIGEST_LENGTH];
+	uint8 environment[CC_SHA1_DIGEST_LENGTH];
+	uint8 mac[CC_SHA1_DIGEST_LENGTH];		// HMAC-SHA1 of expires, key, environment and payload
+	uint32 reserved;
+};
+
+static size_t padded(size_t length)
+{
+	return (length + 7) & ~size_t(7);
+}
+
+//
+// Records are authenticated with a secret of the user's own, so that a
+// cache file written by anything which doesn't know it is worthless. The
+// secret is only a file, though, readable by all of the user's processes;
+// that is why no record may say that a chain is trusted.
+//
+static void recordMac(const std::string &secret, const RecordHeader &header, const uint8 *payload,
+	uint8 digest[CC_SHA1_DIGEST_LENGTH])
+{
+	CCHmacContext ctx;
+	CCHmacInit(&ctx, kCCHmacAlgSHA1, secret.data(), secret.size());
+	CCHmacUpdate(&ctx, &header.expires, sizeof(header.expires));
+	CCHmacUpdate(&ctx, header.key, sizeof(header.key));
+	CCHmacUpdate(&ctx, header.environment, sizeof(header.environment));
+	CCHmacUpdate(&ctx, payload, header.length);
+	CCHmacFinal(&ctx, digest);
+}
+
+//
+// The effective user's home directory, from the user database; the
+// environment is the caller's to set and is not to be believed.
+//
+static bool userHome(std::string &home)
+{
+	struct passwd pwbuf, *pw = NULL;
+	char buf[4096];
+	if (::getpwuid_r(geteuid(), &pwbuf, buf, sizeof(buf), &pw) || pw == NULL || pw->pw_dir == NULL)
+		return false;
+	home = pw->pw_dir;
+	return true;
+}
+
+
+//
+// Payload encoding
+//
+class PayloadWriter {
+public:
+	void u32(uint32 value)		{ bytes(&value, sizeof(value)); }
+	void string(const std::string &s)	{ u32(uint32(s.size())); bytes(s.data(), s.size()); }
+	void bytes(const void *data, size_t length)
+	{ mData.insert(mData.end(), (const uint8 *)data, (const uint8 *)data + length); }
+
+	const std::vector<uint8> &data() const	{ return mData; }
+
+private:
+	std::vector<uint8> mData;
+};
+
+class PayloadReader {
+public:
+	PayloadReader(const uint8 *data, size_t length) : mData(data), mLength(length), mGood(true) { }
+
+	bool good() const			{ return mGood; }
+	uint32 u32()				{ uint32 value = 0; bytes(&value, sizeof(value)); return value; }
+	std::string string()
+	{
+		uint32 length = u32();
+		if (!mGood || length > mLength) {
+			mGood = false;
+			return std::string();
+		}
+		std::string s((const char *)mData, length);
+		mData += length;
+		mLength -= length;
+		return s;
+	}
+	void bytes(void *out, size_t length)
+	{
+		if (!mGood || length > mLength) {
+			mGood = false;
+			return;
+		}
+		memcpy(out, mData, length);
+		mData += length;
+		mLength -= length;
+	}
+
+private:
+	const uint8 *mData;
+	size_t mLength;
+	bool mGood;
+};
+
+
+//
+// Make and break. The cache is only opened if the administrator asked for
+// it, in /Library/Preferences; users can't turn it on for themselves.
+//
+TrustDecisionCache::TrustDecisionCache()
+	: mFd(-1), mDevice(0), mInode(0), mMap(NULL), mMapSize(0), mScanned(0), mDamaged(false)
+{
+	Boolean enabled = false;
+	CFTypeRef val = CFPreferencesCopyValue(kSecTrustDecisionCachePref,
+		CFSTR("com.apple.security"), kCFPreferencesAnyUser, kCFPreferencesAnyHost);
+	if (val) {
+		if (CFGetTypeID(val) == CFBooleanGetTypeID())
+			enabled = CFBooleanGetValue((CFBooleanRef)val);
+		CFRelease(val);
+	}
+	if (!enabled)
+		return;
+
+	std::string home;
+	if (!userHome(home))
+		return;
+	mPath = home + "/" + CACHE_FILE;
+	if (!loadSecret(mPath + KEY_SUFFIX))
+		return;
+	if (open())
+		secdebug("trustcache", "using trust decision cache %s", mPath.c_str());
+}
+
+TrustDecisionCache::~TrustDecisionCache()
+{
+	close();
+}
+
+
+//
+// Open the cache file, creating it if need be. We only believe a file which
+// is ours and which nobody else can write.
+//
+bool TrustDecisionCache::open()
+{
+	int fd = ::open(mPath.c_str(), O_RDWR | O_CREAT, 0600);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (::fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_uid != geteuid() || (st.st_mode & 077)) {
+		secdebug("trustcache", "%s is not ours alone; not used", mPath.c_str());
+		::close(fd);
+		return false;
+	}
+	if (st.st_size == 0) {
+		FileHeader header = { kFileMagic, kFileVersion };
+		if (::flock(fd, LOCK_EX) == 0) {
+			if (::fstat(fd, &st) == 0 && st.st_size == 0)
+				(void)::write(fd, &header, sizeof(header));
+			::flock(fd, LOCK_UN);
+		}
+	}
+	mFd = fd;
+	mDevice = st.st_dev;
+	mInode = st.st_ino;
+	mScanned = 0;
+	mDamaged = false;
+	mIndex.clear();
+	return true;
+}
+
+//
+// Read the user's record key, making one if there is none yet. As with the
+// cache file, we only believe a key file which is ours alone.
+//
+bool TrustDecisionCache::loadSecret(const std::string &path)
+{
+	int fd = ::open(path.c_str(), O_RDONLY | O_NOFOLLOW);
+	if (fd < 0 && errno == ENOENT) {
+		uint8 secret[keySize];
+		if (SecRandomCopyBytes(kSecRandomDefault, sizeof(secret), secret))
+			return false;
+		std::string tmpPath = path + ".new";
+		::unlink(tmpPath.c_str());
+		int tmp = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW, 0600);
+		if (tmp < 0)
+			return false;
+		bool good = ::write(tmp, secret, sizeof(secret)) == ssize_t(sizeof(secret));
+		if (::close(tmp))
+			good = false;
+		// link, not rename, so that a key someone else just made wins
+		if (good)
+			(void)::link(tmpPath.c_str(), path.c_str());
+		::unlink(tmpPath.c_str());
+		memset(secret, 0, sizeof(secret));
+		fd = ::open(path.c_str(), O_RDONLY | O_NOFOLLOW);
+	}
+	if (fd < 0)
+		return false;
+	struct stat st;
+	uint8 secret[keySize];
+	bool good = ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_uid == geteuid()
+		&& !(st.st_mode & 077) && st.st_size == off_t(sizeof(secret))
+		&& ::read(fd, secret, sizeof(secret)) == ssize_t(sizeof(secret));
+	::close(fd);
+	if (!good) {
+		secdebug("trustcache", "%s is not ours alone; cache not used", path.c_str());
+		return false;
+	}
+	mSecret.assign((const char *)secret, sizeof(secret));
+	memset(secret, 0, sizeof(secret));
+	return true;
+}
+
+void TrustDecisionCache::close()
+{
+	if (mMap) {
+		::munmap(mMap, mMapSize);
+		mMap = NULL;
+		mMapSize = 0;
+	}
+	if (mFd >= 0) {
+		::close(mFd);
+		mFd = -1;
+	}
+	mScanned = 0;
+	mDamaged = false;
+	mIndex.clear();
+}
+
+
+//
+// Catch up with the file: reopen it if someone replaced it, and remap and
+// index any records appended since we last looked.
+//
+void TrustDecisionCache::refresh()
+{
+	struct stat st;
+	if (::stat(mPath.c_str(), &st) || st.st_dev != mDevice || st.st_ino != mInode) {
+		close();
+		if (!open())
+			return;
+	}
+	if (::fstat(mFd, &st) || size_t(st.st_size) <= mMapSize)
+		return;
+	if (mMap)
+		::munmap(mMap, mMapSize);
+	mMap = ::mmap(NULL, size_t(st.st_size), PROT_READ, MAP_SHARED, mFd, 0);
+	if (mMap == MAP_FAILED) {
+		mMap = NULL;
+		mMapSize = 0;
+		return;
+	}
+	mMapSize = size_t(st.st_size);
+	scan();
+}
+
+//
+// Index the records between mScanned and the end of the mapping. A record
+// which doesn't fit is still being written; we'll see it next time.
+//
+void TrustDecisionCache::scan()
+{
+	if (mDamaged)
+		return;
+	const uint8 *base = reinterpret_cast<const uint8 *>(mMap);
+	if (mScanned == 0) {
+		FileHeader header;
+		if (mMapSize < sizeof(header))
+			return;
+		memcpy(&header, base, sizeof(header));
+		if (header.magic != kFileMagic || header.version != kFileVersion) {
+			secdebug("trustcache", "unknown cache file format; ignored");
+			mScanned = mMapSize;
+			mDamaged = true;			// replaced at the next add
+			return;
+		}
+		mScanned = sizeof(header);
+	}
+	while (mScanned + sizeof(RecordHeader) <= mMapSize) {
+		RecordHeader header;
+		memcpy(&header, base + mScanned, sizeof(header));
+		if (header.magic != kRecordMagic) {
+			secdebug("trustcache", "damaged cache record at %lu; ignoring the rest", (unsigned long)mScanned);
+			mScanned = mMapSize;
+			mDamaged = true;
+			return;
+		}
+		size_t next = mScanned + sizeof(header) + padded(header.length);
+		if (next > mMapSize)
+			return;
+		mIndex[Digest((const char *)header.key, sizeof(header.key))] = mScanned;
+		mScanned = next;
+	}
+}
+
+
+//
+// Only outcomes which fail an evaluation are cached. Anything running as
+// the user can read the record key and so forge a record; a forged
+// failure costs a re-evaluation at worst, but a forged success would
+// let it bypass trust settings that take authorization to change.
+//
+bool TrustDecisionCache::cacheable(SecTrustResultType result)
+{
+	return result == kSecTrustResultDeny || result == kSecTrustResultFatalTrustFailure;
+}
+
+
+//
+// Look up a decision. The record is checked against its MAC before
+// anything in it is believed, and is still refused if it trusts.
+//
+bool TrustDecisionCache::find(const Digest &key, const Digest &environment, Decision &decision)
+{
+	StLock<Mutex> _(mMutex);
+	if (mFd < 0)
+		return false;
+	refresh();
+	std::map<Digest, size_t>::const_iterator it = mIndex.find(key);
+	if (it == mIndex.end() || !mMap)
+		return false;
+
+	const uint8 *base = reinterpret_cast<const uint8 *>(mMap);
+	RecordHeader header;
+	memcpy(&header, base + it->second, sizeof(header));
+	const uint8 *payload = base + it->second + sizeof(header);
+	uint8 digest[CC_SHA1_DIGEST_LENGTH];
+	recordMac(mSecret, header, payload, digest);
+	if (memcmp(digest, header.mac, sizeof(digest))) {
+		secdebug("trustcache", "cache record at %lu fails its MAC", (unsigned long)it->second);
+		return false;
+	}
+	if (environment.compare(0, environment.size(), (const char *)header.environment, sizeof(header.environment)))
+		return false;	// trust settings, roots or keychains have changed since
+	if (CFAbsoluteTimeGetCurrent() >= CFAbsoluteTime(header.expires))
+		return false;
+
+	PayloadReader reader(payload, header.length);
+	decision.result = SecTrustResultType(reader.u32());
+	if (!cacheable(decision.result)) {
+		secdebug("trustcache", "cache record at %lu trusts; ignored", (unsigned long)it->second);
+		return false;
+	}
+	decision.tpReturn = OSStatus(reader.u32());
+	decision.usingTrustSettings = reader.u32() != 0;
+	decision.expires = CFAbsoluteTime(header.expires);
+	uint32 count = reader.u32();
+	if (!reader.good() || count > header.length)
+		return false;
+	decision.chain.resize(count);
+	decision.evidence.resize(count);
+	for (uint32 n = 0; n < count && reader.good(); n++) {
+		decision.chain[n] = reader.string();
+		Evidence &evidence = decision.evidence[n];
+		evidence.status = reader.u32();
+		evidence.index = reader.u32();
+		uint32 codes = reader.u32();
+		if (!reader.good() || codes > header.length)
+			return false;
+		evidence.statusCodes.resize(codes);
+		for (uint32 c = 0; c < codes; c++)
+			evidence.statusCodes[c] = CSSM_RETURN(reader.u32());
+	}
+	decision.evOrganization = reader.string();
+	return reader.good();
+}
+
+
+//
+// Append a decision. Appends from several processes are serialized with
+// flock; readers never need the lock.
+//
+void TrustDecisionCache::add(const Digest &key, const Digest &environment, const Decision &decision)
+{
+	StLock<Mutex> _(mMutex);
+	if (mFd < 0 || key.size() != CC_SHA1_DIGEST_LENGTH || environment.size() != CC_SHA1_DIGEST_LENGTH
+			|| !cacheable(decision.result))
+		return;
+
+	PayloadWriter writer;
+	writer.u32(decision.result);
+	writer.u32(uint32(decision.tpReturn));
+	writer.u32(decision.usingTrustSettings);
+	writer.u32(uint32(decision.chain.size()));
+	for (size_t n = 0; n < decision.chain.size(); n++) {
+		writer.string(decision.chain[n]);
+		const Evidence &evidence = decision.evidence[n];
+		writer.u32(evidence.status);
+		writer.u32(evidence.index);
+		writer.u32(uint32(evidence.statusCodes.size()));
+		for (size_t c = 0; c < evidence.statusCodes.size(); c++)
+			writer.u32(evidence.statusCodes[c]);
+	}
+	writer.string(decision.evOrganization);
+
+	RecordHeader header;
+	memset(&header, 0, sizeof(header));
+	header.expires = int64(decision.expires);
+	header.magic = kRecordMagic;
+	header.length = uint32(writer.data().size());
+	memcpy(header.key, key.data(), sizeof(header.key));
+	memcpy(header.environment, environment.data(), sizeof(header.environment));
+	recordMac(mSecret, header, &writer.data()[0], header.mac);
+
+	std::vector<uint8> record((const uint8 *)&header, (const uint8 *)&header + sizeof(header));
+	record.insert(record.end(), writer.data().begin(), writer.data().end());
+	record.resize(sizeof(header) + padded(header.length), 0);
+
+	refresh();
+	if (mFd < 0)
+		return;
+	struct stat st;
+	if (mDamaged || (::fstat(mFd, &st) == 0 && size_t(st.st_size) + record.size() > maxCacheSize))
+		replace();
+	if (mFd < 0)
+		return;
+
+	if (::flock(mFd, LOCK_EX))
+		return;
+	if (::lseek(mFd, 0, SEEK_END) >= off_t(sizeof(FileHeader)))
+		(void)::write(mFd, &record[0], record.size());
+	::flock(mFd, LOCK_UN);
+}
+
+//
+// Start a fresh file beside the old one and rename it into place. Anyone
+// with the old one mapped keeps a good mapping, and notices the new one
+// at their next refresh.
+//
+void TrustDecisionCache::replace()
+{
+	std::string tmpPath = mPath + ".new";
+	int fd = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+	if (fd < 0)
+		return;
+	FileHeader header = { kFileMagic, kFileVersion };
+	bool good = ::write(fd, &header, sizeof(header)) == ssize_t(sizeof(header));
+	::close(fd);
+	if (!good || ::rename(tmpPath.c_str(), mPath.c_str())) {
+		::unlink(tmpPath.c_str());
+		return;
+	}
+	secdebug("trustcache", "replaced trust decision cache");
+	close();
+	open();
+}
+
+
+//
+// The environment a decision was made in, as a digest of the identity,
+// size and modification time of every file that feeds an evaluation
+// besides its inputs: the system roots and trust settings, the admin and
+// per-user trust settings, revocation preferences, and the keychains searched.
+//
+static void addFile(CC_SHA1_CTX &ctx, const char *path)
+{
+	struct stat st;
+	int64 identity[4] = { 0, 0, 0, 0 };
+	if (::stat(path, &st) == 0) {
+		identity[0] = st.st_ino;
+		identity[1] = st.st_size;
+		identity[2] = st.st_mtime;
+		identity[3] = st.st_ctime;
+	}
+	CC_SHA1_Update(&ctx, path, (CC_LONG)strlen(path) + 1);
+	CC_SHA1_Update(&ctx, identity, sizeof(identity));
+}
+
+TrustDecisionCache::Digest TrustDecisionCache::environment(const StorageManager::KeychainList &keychains)
+{
+	CC_SHA1_CTX ctx;
+	CC_SHA1_Init(&ctx);
+	addFile(ctx, SYSTEM_ROOT_STORE_PATH);
+	addFile(ctx, SYSTEM_TRUST_SETTINGS_PATH);
+	addFile(ctx, SYSTEM_CERT_STORE_PATH);
+	addFile(ctx, ADMIN_CERT_STORE_PATH);
+	addFile(ctx, EV_ROOTS_PATH);
+	addFile(ctx, "/Library/Preferences/com.apple.security.plist");
+	addFile(ctx, "/Library/Preferences/" kSecRevocationDomain ".plist");
+	std::string home;
+	if (userHome(home)) {
+		std::string prefs = home + "/Library/Preferences/" kSecRevocationDomain ".plist";
+		addFile(ctx, prefs.c_str());
+	}
+
+	// admin and per-user trust settings: <uuid>.plist files in one directory
+	addFile(ctx, TRUST_SETTINGS_PATH);
+	if (DIR *dir = ::opendir(TRUST_SETTINGS_PATH)) {
+		std::vector<std::string> names;
+		while (struct dirent *entry = ::readdir(dir))
+			if (entry->d_name[0] != '.')
+				names.push_back(entry->d_name);
+		::closedir(dir);
+		std::sort(names.begin(), names.end());
+		for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); it++)
+			addFile(ctx, (std::string(TRUST_SETTINGS_PATH "/") + *it).c_str());
+	}
+
+	for (StorageManager::KeychainList::const_iterator it = keychains.begin(); it != keychains.end(); it++)
+		addFile(ctx, (*it)->name());
+
+	uint8 digest[CC_SHA1_DIGEST_LENGTH];
+	CC_SHA1_Final(digest, &ctx);
+	return Digest((const char *)digest, sizeof(digest));
+}
+
+
+} // end namespace KeychainCore
+} // end namespace Security
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+//
+// TrustDecisionCache.h - persistent cache of trust evaluation outcomes
+//
+#ifndef _SECURITY_TRUSTDECISIONCACHE_H_
+#define _SECURITY_TRUSTDECISIONCACHE_H_
+
+#include <security_keychain/StorageManager.h>
+#include <security_utilities/globalizer.h>
+#include <security_utilities/threading.h>
+#include <Security/SecTrust.h>
+#include <Security/cssmapple.h>
+#include <CoreFoundation/CoreFoundation.h>
+#include <sys/types.h>
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace Security {
+namespace KeychainCore {
+
+
+//
+// A cache of failing Trust::evaluate outcomes shared by all of a user's
+// processes, so that short-lived programs don't re-verify the same bad
+// chains every time they start. It lives in ~/Library/Caches and is off
+// unless the administrator sets kSecTrustDecisionCachePref (com.apple.security
+// domain, /Library/Preferences) to true.
+//
+// A decision is keyed by a digest of the Trust's inputs (certificates,
+// policies, anchors, action, time and keychains) and records a digest of
+// the environment it was made in (trust settings, system roots, revocation
+// preferences, the keychains' files). It is ignored once that environment
+// changes or it expires; a decision that relied on revocation checking
+// expires no later than the CRLs behind it are next updated. Records are
+// appended to the file, each with an HMAC under a random key kept in a
+// file of the user's own. When the file grows too big it is replaced,
+// never truncated, so other processes' mappings of it stay good.
+//
+// The key file only keeps out other users: any process running as this
+// user can read it and forge records. So only Deny and fatal failures are
+// cached, and find() ignores any record which trusts; a forged record can
+// make an evaluation fail, which such a process could bring about anyway,
+// but never make one pass. Successful evaluations are always made afresh.
+//
+class TrustDecisionCache {
+	NOCOPY(TrustDecisionCache)
+public:
+	TrustDecisionCache();
+	~TrustDecisionCache();
+
+	typedef std::string Digest;		// CC_SHA1_DIGEST_LENGTH bytes
+
+	struct Evidence {
+		CSSM_TP_APPLE_CERT_STATUS status;
+		uint32 index;
+		std::vector<CSSM_RETURN> statusCodes;
+	};
+
+	struct Decision {
+		SecTrustResultType result;
+		OSStatus tpReturn;
+		bool usingTrustSettings;
+		CFAbsoluteTime expires;
+		std::vector<std::string> chain;		// DER, leaf first
+		std::vector<Evidence> evidence;		// parallel to chain
+		std::string evOrganization;			// UTF-8; empty unless EV
+	};
+
+	bool enabled() const		{ return mFd >= 0; }
+
+	static bool cacheable(SecTrustResultType result);
+	static Digest environment(const StorageManager::KeychainList &keychains);
+	bool find(const Digest &key, const Digest &environment, Decision &decision);
+	void add(const Digest &key, const Digest &environment, const Decision &decision);
+
+private:
+	bool loadSecret(const std::string &path);
+	bool open();
+	void close();
+	void refresh();
+	void scan();
+	void replace();
+
+	Mutex mMutex;
+	std::string mPath;
+	std::string mSecret;			// HMAC key for records
+	int mFd;
+	dev_t mDevice;
+	ino_t mInode;
+	void *mMap;
+	size_t mMapSize;
+	size_t mScanned;				// records up to here are indexed
+	bool mDamaged;					// unreadable past mScanned
+	std::map<Digest, size_t> mIndex;	// key -> offset of latest record
+};
+
+extern ModuleNexus<TrustDecisionCache> gTrustDecisionCache;
+
+
+} // end namespace KeychainCore
+} // end namespace Security
+
+#endif // !_SECURITY_TRUSTDECISIONCACHE_H_
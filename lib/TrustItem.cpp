@@ -108,7 +108,7 @@ PrimaryKey UserTrustItem::add(Keychain &keychain)
 			Schema::UserTrustSchemaAttributeList,
 			Schema::UserTrustSchemaIndexCount,
 			Schema::UserTrustSchemaIndexList);
-		keychain->keychainSchema()->didCreateRelation(
+		keychain->didCreateRelation(
 			CSSM_DL_DB_RECORD_USER_TRUST,
 			"CSSM_DL_DB_RECORD_USER_TRUST",
 			Schema::UserTrustSchemaAttributeCount,
@@ -43,6 +43,30 @@ extern "C" {
  common global mutex for managing access to trust keychains (i.e. the root certificate store).
  */
 RecursiveMutex& SecTrustKeychainsGetMutex();
+
+/*!
+ @function SecTrustKeychainsSearchListChanged
+ @abstract Discard the keychain handles cached for trust evaluations
+ @discussion Called when the keychain search list changes. Evaluations look up their
+ keychains' handles afresh, and cache them again, from then on.
+ */
+void SecTrustKeychainsSearchListChanged();
+
+/*!
+ @function SecTrustKeychainsCertificatesChanged
+ @abstract Note that certificates were added to, changed in or removed from a keychain
+ @discussion Called on keychain events for certificate records, and when the keychain
+ search list changes. Anything derived from the certificates in a keychain list should
+ be recomputed once SecTrustKeychainsCertificatesGeneration() no longer returns the
+ value it was computed with.
+ */
+void SecTrustKeychainsCertificatesChanged();
+
+/*!
+ @function SecTrustKeychainsCertificatesGeneration
+ @abstract Get a counter which SecTrustKeychainsCertificatesChanged increments
+ */
+uint32 SecTrustKeychainsCertificatesGeneration();
 	
 #if defined(__cplusplus)
 }
@@ -26,12 +26,18 @@
 */
 
 #include <security_keychain/Trust.h>
+#include <security_keychain/Globals.h>
+#include <security_keychain/KCCursor.h>
+#include <security_cdsa_utilities/Schema.h>
 #include <security_utilities/cfutilities.h>
 #include <security_utilities/simpleprefs.h>
 #include <CoreFoundation/CFData.h>
 #include "SecBridge.h"
+#include "cssmdatetime.h"
+#include <Security/SecKeychainItemPriv.h>
 #include <Security/cssmapplePriv.h>
 #include <Security/oidsalg.h>
+#include <algorithm>
 
 /* 
  * These may go into an SPI header for the SecTrust object.
@@ -283,7 +289,7 @@ CFMutableArrayRef Trust::addPreferenceRevocationPolicies(
 		
 		/* Policy manages its own copy of this data */
 		CSSM_DATA optData = {sizeof(opts), (uint8 *)&opts};
-		ocspPolicy->value() = optData;
+		ocspPolicy->setValue(CssmData::overlay(optData));
 		numAdded++;
 	}
 	
@@ -316,7 +322,7 @@ CFMutableArrayRef Trust::addPreferenceRevocationPolicies(
 
 		/* Policy manages its own copy of this data */
 		CSSM_DATA optData = {sizeof(opts), (uint8 *)&opts};
-		crlPolicy->value() = optData;
+		crlPolicy->setValue(CssmData::overlay(optData));
 		numAdded++;
 	}
 	
@@ -602,7 +608,7 @@ CFMutableArrayRef Trust::forceRevocationPolicies(
 
 		/* Policy manages its own copy of the options data */
 		CSSM_DATA optData = {sizeof(opts), (uint8 *)&opts};
-		ocspPolicy->value() = optData;
+		ocspPolicy->setValue(CssmData::overlay(optData));
 		
 		/* Policies array retains the Policy object */
 		CFArrayAppendValue(policies, ocspPolicy->handle(false));
@@ -622,7 +628,7 @@ CFMutableArrayRef Trust::forceRevocationPolicies(
 
 		/* Policy manages its own copy of this data */
 		CSSM_DATA optData = {sizeof(opts), (uint8 *)&opts};
-		crlPolicy->value() = optData;
+		crlPolicy->setValue(CssmData::overlay(optData));
 		
 		/* Policies array retains the Policy object */
 		CFArrayAppendValue(policies, crlPolicy->handle(false));
@@ -631,3 +637,69 @@ CFMutableArrayRef Trust::forceRevocationPolicies(
 
 	return policies;
 }
+
+/*
+ * ocspd's cache of the CRLs it has fetched; an ordinary keychain.
+ */
+#define CRL_CACHE_PATH		"/private/var/db/crls/crlcache.db"
+
+/*
+ * Bound how long the outcome of the evaluation just made may be reused by
+ * how long the revocation status it established stays current: the
+ * earliest nextUpdate of the cached CRLs covering the chain's certificates,
+ * anchors and roots aside. Returns false if that can't be told for every
+ * certificate, e.g. when one's status came from OCSP alone, or its CRL is
+ * already stale. Caller must hold mMutex.
+ */
+bool Trust::boundByRevocation(
+	const CSSM_TP_APPLE_EVIDENCE_INFO *infoList,
+	CFAbsoluteTime &expires)
+{
+	StorageManager::KeychainList crlCache;
+	try {
+		crlCache.push_back(globals().storageManager.make(CRL_CACHE_PATH, false));
+	}
+	catch(...) {
+		return false;
+	}
+
+	CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+	for(uint32 n = 0; n < mCertChain.size(); n++) {
+		if(infoList[n].StatusBits & (CSSM_CERT_STATUS_IS_IN_ANCHORS | CSSM_CERT_STATUS_IS_ROOT)) {
+			continue;
+		}
+		CSSM_DATA_PTR issuer = mCertChain[n]->copyFirstFieldValue(CSSMOID_X509V1IssuerName);
+		if(issuer == NULL) {
+			return false;
+		}
+		/* the freshest CRL from this certificate's issuer is the one the TP used */
+		CFAbsoluteTime nextUpdate = 0;
+		try {
+			KCCursor cursor(crlCache, SecItemClass(CSSM_DL_DB_RECORD_X509_CRL), NULL);
+			cursor->add(CSSM_DB_EQUAL, Schema::kX509CrlIssuer, CssmData::overlay(*issuer));
+			Item item;
+			while(cursor->next(item)) {
+				char timeString[32];
+				SecKeychainAttribute attr = { kSecNextUpdateItemAttr, sizeof(timeString), timeString };
+				UInt32 actualLength = 0;
+				item->getAttribute(attr, &actualLength);
+				CFDateRef date = NULL;
+				CSSMDateTimeUtils::CssmDateStringToCFDate(timeString, (unsigned)attr.length, &date);
+				if(date) {
+					nextUpdate = std::max(nextUpdate, CFDateGetAbsoluteTime(date));
+					CFRelease(date);
+				}
+			}
+		}
+		catch(...) {
+			nextUpdate = 0;
+		}
+		mCertChain[n]->releaseFieldValue(CSSMOID_X509V1IssuerName, issuer);
+		if(nextUpdate <= now) {
+			secdebug("trustcache", "no current CRL for cert %u; revocation freshness unknown", (unsigned)n);
+			return false;
+		}
+		expires = std::min(expires, nextUpdate);
+	}
+	return true;
+}
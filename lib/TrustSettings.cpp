@@ -31,6 +31,7 @@
 #include "TrustSettingsSchema.h"
 #include "SecTrustSettings.h"
 #include "TrustSettingsUtils.h"
+#include "TrustSettingsImage.h"
 #include "TrustKeychains.h"
 #include "SecCertificatePriv.h"
 #include "SecPolicyPriv.h"
@@ -43,6 +44,7 @@
 #include <security_utilities/logging.h>
 #include <security_utilities/cfutilities.h>
 #include <security_utilities/alloc.h>
+#include <security_utilities/globalizer.h>
 #include <Security/cssmapplePriv.h>
 #include <Security/oidscert.h>
 #include <security_keychain/KCCursor.h>
@@ -122,6 +124,28 @@ static bool tsCheckApp(
 	return true;
 }
 
+static bool tsCheckKeyUseValue(
+	SecTrustSettingsKeyUsage appKeyUse,
+	SInt32 certUse)
+{
+	SecTrustSettingsKeyUsage cku = (SecTrustSettingsKeyUsage)certUse;
+	if(cku == kSecTrustSettingsKeyUseAny) {
+		/* explicitly allows anything */
+		return true;
+	}
+	/* cert specification must be a superset of app's intended use */
+	if(appKeyUse == 0) {
+		trustSettingsEvalDbg("tsCheckKeyUse: certKeyUsage, !appKeyUsage");
+		return false;
+	}
+	
+	if((cku & appKeyUse) != appKeyUse) {
+		trustSettingsEvalDbg("tsCheckKeyUse: keyUse mismatch");
+		return false;
+	}
+	return true;
+}
+
 static bool tsCheckKeyUse(
 	SecTrustSettingsKeyUsage appKeyUse,
 	CFNumberRef certKeyUse)
@@ -129,21 +153,7 @@ static bool tsCheckKeyUse(
 	if(certKeyUse != NULL) {
 		SInt32 certUse;
 		CFNumberGetValue(certKeyUse, kCFNumberSInt32Type, &certUse);
-		SecTrustSettingsKeyUsage cku = (SecTrustSettingsKeyUsage)certUse;
-		if(cku == kSecTrustSettingsKeyUseAny) {
-			/* explicitly allows anything */
-			return true;
-		}
-		/* cert specification must be a superset of app's intended use */
-		if(appKeyUse == 0) {
-			trustSettingsEvalDbg("tsCheckKeyUse: certKeyUsage, !appKeyUsage");
-			return false;
-		}
-		
-		if((cku & appKeyUse) != appKeyUse) {
-			trustSettingsEvalDbg("tsCheckKeyUse: keyUse mismatch");
-			return false;
-		}
+		return tsCheckKeyUseValue(appKeyUse, certUse);
 	}
 	return true;
 }
@@ -190,6 +200,73 @@ static bool tsCheckPolicyStr(
 	return true;
 }
 
+/*
+ * The same four comparisons for a usage constraint record in a 
+ * TrustSettingsImage. 
+ */
+static bool tsCheckImageConstraint(
+	const TrustSettingsImage &image,
+	const TrustSettingsImage::Constraint &c,
+	const CSSM_OID *appPolicy,
+	const char *appPolicyStr,
+	SecTrustSettingsKeyUsage appKeyUse)
+{
+	if(c.flags & TrustSettingsImage::kHasPolicy) {
+		if(appPolicy == NULL) {
+			trustSettingsEvalDbg("tsCheckImageConstraint: certPolicy, !appPolicy");
+			return false;
+		}
+		CssmData certPolicy = image.data(c.policyOffset, c.policyLength);
+		if((certPolicy.length() != appPolicy->Length) || 
+		   memcmp(appPolicy->Data, certPolicy.data(), certPolicy.length())) {
+			trustSettingsEvalDbg("tsCheckImageConstraint: policy mismatch");
+			return false;
+		}
+	}
+	if(c.flags & TrustSettingsImage::kHasApplication) {
+		CssmData app = image.data(c.appOffset, c.appLength);
+		CFRef<CFDataRef> certApp(CFDataCreateWithBytesNoCopy(NULL, (const UInt8 *)app.data(), 
+			app.length(), kCFAllocatorNull));
+		if(!tsCheckApp(certApp)) {
+			return false;
+		}
+	}
+	if((c.flags & TrustSettingsImage::kHasKeyUsage) && 
+	   !tsCheckKeyUseValue(appKeyUse, c.keyUsage)) {
+		return false;
+	}
+	if(c.flags & TrustSettingsImage::kHasPolicyString) {
+		if(appPolicyStr == NULL) {
+			trustSettingsEvalDbg("tsCheckImageConstraint: certPolicyStr, !appPolicyStr");
+			return false;
+		}
+		CssmData certPolicyStr = image.data(c.policyStrOffset, c.policyStrLength);
+		size_t appLen = strlen(appPolicyStr);
+		if((appLen == certPolicyStr.length()) && 
+		   !memcmp(appPolicyStr, certPolicyStr.data(), appLen)) {
+			return true;
+		}
+		/* not byte-for-byte equal; let CF decide unless it's all ASCII */
+		bool ascii = true;
+		for(size_t dex = 0; ascii && dex < appLen; dex++) {
+			ascii = !(appPolicyStr[dex] & 0x80);
+		}
+		for(size_t dex = 0; ascii && dex < certPolicyStr.length(); dex++) {
+			ascii = !(((const uint8 *)certPolicyStr.data())[dex] & 0x80);
+		}
+		if(ascii) {
+			trustSettingsEvalDbg("tsCheckImageConstraint: policyStr mismatch");
+			return false;
+		}
+		CFRef<CFStringRef> cfCertPolicyStr(CFStringCreateWithBytes(NULL, 
+			(const UInt8 *)certPolicyStr.data(), certPolicyStr.length(), kCFStringEncodingUTF8, false));
+		if(!cfCertPolicyStr || !tsCheckPolicyStr(appPolicyStr, cfCertPolicyStr)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 /* 
  * Determine if a cert's trust settings dictionary satisfies the specified 
  * usage constraints. Returns true if so.
@@ -342,6 +419,7 @@ bool tsIsGoodCfNum(CFNumberRef cfn, SInt32 *num = NULL)
 TrustSettings::TrustSettings(SecTrustSettingsDomain domain)
 		: mPropList(NULL), 
 		  mTrustDict(NULL),
+		  mImage(NULL),
 		  mDictVersion(0),
 		  mDomain(domain),
 		  mDirty(false)
@@ -375,6 +453,7 @@ OSStatus TrustSettings::CreateTrustSettings(
 	OSStatus ortn = noErr;
 	struct stat sb;
 	const char *path;
+	CFRef<CFDataRef> propList;
 
 	/* get trust settings from file, one way or another */
 	switch(domain) {
@@ -420,11 +499,31 @@ OSStatus TrustSettings::CreateTrustSettings(
 		}
 	}
 	else {
-		CFRef<CFDataRef> propList(CFDataCreate(NULL, fileData.Data, fileData.Length));
-		t->initFromData(propList);
+		/* 
+		 * A trimmed TrustSettings only evaluates, so it can work straight 
+		 * from the compiled image of this very plist, if we have one. 
+		 */
+		if(trim) {
+			t->mImage = TrustSettingsImage::open(domain, fileData);
+		}
+		if(t->mImage == NULL) {
+			propList.take(CFDataCreate(NULL, fileData.Data, fileData.Length));
+			t->initFromData(propList);
+		}
 		alloc.free(fileData.Data);
 	}
-	t->validatePropList(trim);
+	if(t->mImage != NULL) {
+		t->mDictVersion = t->mImage->dictVersion();
+	}
+	else {
+		t->validatePropList(trim);
+		if(trim && propList) {
+			/* we've paid for parsing and validation; save next time the trouble */
+			CSSM_DATA propListData = { CFDataGetLength(propList), 
+				(uint8 *)CFDataGetBytePtr(propList) };
+			TrustSettingsImage::write(domain, propListData, t->mTrustDict, t->mDictVersion);
+		}
+	}
 	
 	ts = t;
 	return noErr;
@@ -469,7 +568,8 @@ TrustSettings::~TrustSettings()
 {
 	trustSettingsDbg("TrustSettings(domain %d) destructor", (int)mDomain);
 	CFRELEASE(mPropList);		/* may be null if trimmed */
-	CFRELEASE(mTrustDict);		/* normally always non-NULL */
+	CFRELEASE(mTrustDict);		/* non-NULL unless we have mImage */
+	delete mImage;
 
 }
 
@@ -573,6 +673,9 @@ void TrustSettings::flushToDisk()
 	}
 	trustSettingsDbg("flushToDisk, domain %d: wrote to disk", (int)mDomain);
 	mDirty = false;
+	
+	/* compile what we just wrote so the next load needn't parse it */
+	TrustSettingsImage::write(mDomain, cssmXmlData, mTrustDict, mDictVersion);
 errOut:
 	AuthorizationFree(authRef, 0);
 	if(ortn) {
@@ -617,6 +720,10 @@ bool TrustSettings::evaluateCert(
 	SecTrustSettingsResult	*resultType,		/* RETURNED */
 	bool					*foundAnyEntry)		/* RETURNED */
 {
+	if(mImage != NULL) {
+		return evaluateCertImage(certHashStr, policyOID, policyStr, keyUsage, 
+			isRootCert, allowedErrors, numAllowedErrors, resultType, foundAnyEntry);
+	}
 	assert(mTrustDict != NULL);
 
 	/* get trust settings dictionary for this cert */
@@ -762,6 +869,98 @@ bool TrustSettings::evaluateCert(
 }
 
 
+/*
+ * Reverse index of the certs in a keychain list: cert hash string to 
+ * SecCertificateRef, with the hash strings in keychain search order. The 
+ * first of any duplicates wins, as it did when findQualifiedCerts() deduped
+ * certs by DER. Building it means reading and hashing every cert in every 
+ * keychain, so the most recent index is kept until the keychain list, or 
+ * the certs in any keychain, change.
+ * Caller holds SecTrustKeychainsGetMutex().
+ */
+class TrustCertIndex
+{
+public:
+	TrustCertIndex() : mGeneration(0), mValid(false) {}
+
+	void update(
+		const StorageManager::KeychainList	&keychains);
+
+	/* hash strings, in keychain order */
+	CFArrayRef certHashStrs() const		{ return mCertHashStrs; }
+	
+	/* not refcounted */
+	SecCertificateRef cert(
+		CFStringRef							certHashStr) const
+	{ return (SecCertificateRef)CFDictionaryGetValue(mCerts, certHashStr); }
+
+private:
+	bool sameKeychains(
+		const StorageManager::KeychainList	&keychains) const;
+
+	StorageManager::KeychainList	mKeychains;
+	uint32							mGeneration;
+	bool							mValid;
+	CFRef<CFMutableArrayRef>		mCertHashStrs;
+	CFRef<CFMutableDictionaryRef>	mCerts;
+};
+
+static ModuleNexus<TrustCertIndex> trustCertIndex;
+
+bool TrustCertIndex::sameKeychains(
+	const StorageManager::KeychainList	&keychains) const
+{
+	if(keychains.size() != mKeychains.size()) {
+		return false;
+	}
+	for(StorageManager::KeychainList::size_type dex=0; dex<keychains.size(); dex++) {
+		if(keychains[dex].get() != mKeychains[dex].get()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void TrustCertIndex::update(
+	const StorageManager::KeychainList	&keychains)
+{
+	uint32 generation = SecTrustKeychainsCertificatesGeneration();
+	if(mValid && (generation == mGeneration) && sameKeychains(keychains)) {
+		return;
+	}
+	trustSettingsEvalDbg("TrustCertIndex: rebuilding");
+	mValid = false;
+
+	CFRef<CFMutableArrayRef> certHashStrs(CFArrayCreateMutable(NULL, 0,
+		&kCFTypeArrayCallBacks));
+	CFRef<CFMutableDictionaryRef> certs(CFDictionaryCreateMutable(NULL, 0,
+		&kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks));
+
+	/* search: all certs, no attributes */
+	KCCursor cursor(keychains, CSSM_DL_DB_RECORD_X509_CERTIFICATE, NULL);
+	Item certItem;
+	while(cursor->next(certItem)) {
+		CFRef<SecCertificateRef> certRef((SecCertificateRef)certItem->handle());
+		CFRef<CFStringRef> certHashStr(SecTrustSettingsCertHashStrFromCert(certRef));
+		if(!certHashStr) {
+			trustSettingsEvalDbg("TrustCertIndex: CertHashStrFromCert error");
+			continue;
+		}
+		if(CFDictionaryContainsKey(certs, certHashStr)) {
+			trustSettingsEvalDbg("TrustCertIndex: dup cert");
+			continue;
+		}
+		CFDictionaryAddValue(certs, certHashStr, certRef);
+		CFArrayAppendValue(certHashStrs, certHashStr);
+	}
+
+	mKeychains = keychains;
+	mGeneration = generation;
+	mCertHashStrs = certHashStrs;
+	mCerts = certs;
+	mValid = true;
+}
+
 /*
  * Find all certs in specified keychain list which have entries in this trust record.
  * Certs already in the array are not added.
@@ -794,56 +993,43 @@ void TrustSettings::findQualifiedCerts(
 	StLock<Mutex> _(SecTrustKeychainsGetMutex());
 
 	/* 
-	 * a set, hopefully with a good hash function for CFData, to keep track of what's
-	 * been added to the outgoing array. 
+	 * Walk the keychains' certs by hash string, which is how we key our 
+	 * entries, rather than enumerating and hashing them again 
 	 */
-	CFRef<CFMutableSetRef> certSet(CFSetCreateMutable(NULL, 0, &kCFTypeSetCallBacks));
-	
-	/* search: all certs, no attributes */
-	KCCursor cursor(keychains, CSSM_DL_DB_RECORD_X509_CERTIFICATE, NULL);
-	Item certItem;
-	bool found;
-	do {
-		found = cursor->next(certItem);
-		if(!found) {
-			break;
-		}
-		CFRef<SecCertificateRef> certRef((SecCertificateRef)certItem->handle());
+	TrustCertIndex &index = trustCertIndex();
+	index.update(keychains);
+	CFArrayRef certHashStrs = index.certHashStrs();
+	CFIndex numCerts = CFArrayGetCount(certHashStrs);
+	for(CFIndex dex=0; dex<numCerts; dex++) {
+		CFStringRef certHashStr = (CFStringRef)CFArrayGetValueAtIndex(certHashStrs, dex);
 		
 		/* do we have an entry for this cert? */
-		CFDictionaryRef certDict = findDictionaryForCert(certRef);
-		if(certDict == NULL) {
-			continue;
-		}
-		
-		if(!findAll) {
-			/* qualify */
-			if(!qualifyUsageWithCertDict(certDict, policyOID,
-					policyString, keyUsage, onlyRoots)) {
+		if(mImage != NULL) {
+			bool foundEntry;
+			bool qualified = qualifyUsageWithImage(certHashStr, policyOID, 
+				policyString, keyUsage, onlyRoots, &foundEntry);
+			if(!foundEntry || (!findAll && !qualified)) {
 				continue;
 			}
 		}
-		
-		/* see if we already have this one - get in CFData form */
-		CSSM_DATA certData;
-		OSStatus ortn = SecCertificateGetData(certRef, &certData);
-		if(ortn) {
-			trustSettingsEvalDbg("findQualifiedCerts: SecCertificateGetData error");
-			continue;
-		}
-		CFRef<CFDataRef> cfData(CFDataCreate(NULL, certData.Data, certData.Length));
-		CFDataRef cfd = cfData;
-		if(CFSetContainsValue(certSet, cfd)) {
-			trustSettingsEvalDbg("findQualifiedCerts: dup cert");
-			continue;
-		}
 		else {
-			/* add to the tracking set, which owns the CFData now */
-			CFSetAddValue(certSet, cfd);	
-			/* and add the SecCert to caller's array, which owns that now */
-			CFArrayAppendValue(certArray, certRef);
+			CFDictionaryRef certDict = findDictionaryForCertHash(certHashStr);
+			if(certDict == NULL) {
+				continue;
+			}
+			
+			if(!findAll) {
+				/* qualify */
+				if(!qualifyUsageWithCertDict(certDict, policyOID,
+						policyString, keyUsage, onlyRoots)) {
+					continue;
+				}
+			}
 		}
-	} while(found);
+		
+		/* the index has no dups; add the SecCert to caller's array */
+		CFArrayAppendValue(certArray, index.cert(certHashStr));
+	}
 }
 
 /*
@@ -1137,6 +1323,133 @@ CFDictionaryRef TrustSettings::findDictionaryForCertHash(
 	return (CFDictionaryRef)CFDictionaryGetValue(mTrustDict, certHashStr);
 }
 
+/*
+ * evaluateCert() for a TrustSettings loaded from its compiled image;
+ * the same logic, over usage constraint records rather than dictionaries.
+ */
+bool TrustSettings::evaluateCertImage(
+	CFStringRef				certHashStr,
+	const CSSM_OID			*policyOID,			/* optional */
+	const char				*policyStr,			/* optional */
+	SecTrustSettingsKeyUsage keyUsage,			/* optional */
+	bool					isRootCert,			/* for checking default setting */
+	CSSM_RETURN				**allowedErrors,	/* IN/OUT; reallocd as needed */
+	uint32					*numAllowedErrors,	/* IN/OUT */
+	SecTrustSettingsResult	*resultType,		/* RETURNED */
+	bool					*foundAnyEntry)		/* RETURNED */
+{
+	assert(mImage != NULL);
+
+	const TrustSettingsImage::Entry *entry = mImage->find(certHashStr);
+	if((entry == NULL) && isRootCert) {
+		entry = mImage->find(kSecTrustRecordDefaultRootCert);
+	}
+	if(entry == NULL) {
+		*foundAnyEntry = false;
+		return false;
+	}
+	*foundAnyEntry = true;
+
+	if(entry->numConstraints == 0) {
+		trustSettingsEvalDbg("evaluateCertImage: no trust settings");
+		*resultType = kSecTrustSettingsResultTrustRoot;
+		return true;
+	}
+
+	CSSM_RETURN *allowedErrs = *allowedErrors;
+	uint32 numAllowedErrs = *numAllowedErrors;
+	bool foundSettings = false;
+	SecTrustSettingsResult returnedResult = kSecTrustSettingsResultInvalid;
+
+	const TrustSettingsImage::Constraint *constraints = mImage->constraints(*entry);
+	for(uint32 dex=0; dex<entry->numConstraints; dex++) {
+		const TrustSettingsImage::Constraint &c = constraints[dex];
+		if(!tsCheckImageConstraint(*mImage, c, policyOID, policyStr, keyUsage)) {
+			continue;
+		}
+		
+		trustSettingsEvalDbg("evaluateCertImage: MATCH");
+		foundSettings = true;
+
+		if(c.flags & TrustSettingsImage::kHasAllowedError) {
+			allowedErrs = (CSSM_RETURN *)::realloc(allowedErrs, 
+				++numAllowedErrs * sizeof(CSSM_RETURN));
+			allowedErrs[numAllowedErrs-1] = (CSSM_RETURN)c.allowedError;
+		}
+		
+		switch(returnedResult) {
+			case kSecTrustSettingsResultUnspecified:
+			case kSecTrustSettingsResultInvalid:
+				if(c.flags & TrustSettingsImage::kHasResult) {
+					returnedResult = (SecTrustSettingsResult)c.result;
+				}
+				else {
+					returnedResult = kSecTrustSettingsResultTrustRoot;
+				}
+				break;	
+			default:
+				break;
+		}
+	}
+
+	*allowedErrors = allowedErrs;
+	*numAllowedErrors = numAllowedErrs;
+	if(returnedResult != kSecTrustSettingsResultInvalid) {
+		*resultType = returnedResult;
+	}
+	return foundSettings;
+}
+
+/*
+ * qualifyUsageWithCertDict() for a TrustSettings loaded from its compiled
+ * image. *foundEntry tells whether the cert has an entry at all.
+ */
+bool TrustSettings::qualifyUsageWithImage(
+	CFStringRef				certHashStr,
+	const CSSM_OID			*policyOID,		/* optional */
+	const char				*policyStr,		/* optional */
+	SecTrustSettingsKeyUsage keyUsage,		/* optional */
+	bool					onlyRoots,
+	bool					*foundEntry)	/* RETURNED */
+{
+	assert(mImage != NULL);
+
+	*foundEntry = false;
+	const TrustSettingsImage::Entry *entry = mImage->find(certHashStr);
+	if(entry == NULL) {
+		return false;
+	}
+	*foundEntry = true;
+
+	if(entry->numConstraints == 0) {
+		trustSettingsEvalDbg("qualifyUsageWithImage: no trust settings");
+		return true;
+	}
+	const TrustSettingsImage::Constraint *constraints = mImage->constraints(*entry);
+	for(uint32 dex=0; dex<entry->numConstraints; dex++) {
+		const TrustSettingsImage::Constraint &c = constraints[dex];
+		if(!tsCheckImageConstraint(*mImage, c, policyOID, policyStr, keyUsage)) {
+			continue;
+		}
+		SecTrustSettingsResult resultType = kSecTrustSettingsResultTrustRoot;
+		if(c.flags & TrustSettingsImage::kHasResult) {
+			resultType = (SecTrustSettingsResult)c.result;
+		}
+		switch(resultType) {
+			case kSecTrustSettingsResultTrustRoot:
+				return true;
+			case kSecTrustSettingsResultTrustAsRoot:
+				return !onlyRoots;
+			default:
+				trustSettingsEvalDbg("qualifyUsageWithImage: bad resultType "
+					"(%lu)", (unsigned long)resultType);
+				return false;
+		}
+	}
+	trustSettingsEvalDbg("qualifyUsageWithImage: NO MATCH");
+	return false;
+}
+
 /*
  * Validate incoming trust settings, which may be NULL, a dictionary, or 
  * an array of dictionaries. Convert from the API-style dictionaries 
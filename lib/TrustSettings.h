@@ -46,6 +46,8 @@ namespace Security
 namespace KeychainCore
 {
 
+class TrustSettingsImage;
+
 /* 
  * Additional values for the SecTrustSettingsDomain enum.
  */
@@ -205,6 +207,29 @@ private:
 		CFTypeRef trustSettingsDictOrArray,
 		Boolean isSelfSigned);
 
+	/*
+	 * evaluateCert() and qualifyUsage() for a TrustSettings loaded from
+	 * its compiled image.
+	 */
+	bool evaluateCertImage(
+		CFStringRef				certHashStr,
+		const CSSM_OID			*policyOID,
+		const char				*policyString,
+		SecTrustSettingsKeyUsage keyUsage,
+		bool					isRootCert,
+		CSSM_RETURN				**allowedErrors,
+		uint32					*numAllowedErrors,
+		SecTrustSettingsResult	*resultType,
+		bool					*foundAnyEntry);
+
+	bool qualifyUsageWithImage(
+		CFStringRef				certHashStr,
+		const CSSM_OID			*policyOID,
+		const char				*policyString,
+		SecTrustSettingsKeyUsage keyUsage,
+		bool					onlyRoots,
+		bool					*foundEntry);
+
 	/* 
 	 * Validate an usage constraint array from disk as part of our mPropDict
 	 * array. Returns true if OK, else returns false. 
@@ -241,6 +266,12 @@ private:
 	/* and the main thing we work with, the dictionary of per-cert trust settings */
 	CFMutableDictionaryRef			mTrustDict;
 	
+	/* 
+	 * Or, for a trimmed TrustSettings, possibly the mapped image of it 
+	 * instead, in which case mTrustDict is NULL 
+	 */
+	TrustSettingsImage				*mImage;
+	
 	/* version number of mPropDict */
 	SInt32							mDictVersion;
 
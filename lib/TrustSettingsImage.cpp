@@ -0,0 +1,494 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * TrustSettingsImage.cpp - compiled, memory-mapped form of one domain's
+ *							Trust Settings
+ */
+
+#include "TrustSettingsImage.h"
+#include "TrustSettingsSchema.h"
+#include <security_utilities/debugging.h>
+#include <security_utilities/cfutilities.h>
+#include <CommonCrypto/CommonDigest.h>
+#include <sys/types.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#define tsImageDbg(args...)		secdebug("trustSettingsImage", ## args)
+
+namespace Security
+{
+
+namespace KeychainCore
+{
+
+/*
+ * File layout. Host byte order; the magic number tells. Offsets in the
+ * header are from the start of the file; offsets in Entry and Constraint
+ * are from the start of the data table.
+ */
+static const uint32 kTsImageMagic = 'tsim';
+static const uint32 kTsImageVersion = 1;
+
+struct TrustSettingsImage::Header {
+	uint32		magic;
+	uint32		version;
+	uint8		propListDigest[CC_SHA1_DIGEST_LENGTH];
+	uint32		domain;
+	sint32		dictVersion;
+	uint32		size;				/* of the whole file */
+	uint32		numEntries;
+	uint32		entriesOffset;		/* Entry[numEntries], sorted by key */
+	uint32		numConstraints;
+	uint32		constraintsOffset;	/* Constraint[numConstraints] */
+	uint32		dataOffset;
+	uint32		dataLength;
+};
+
+/*
+ * Images are only good if nobody who couldn't change the domain's Trust
+ * Settings could have written them, since open() takes the constraints in
+ * an image at face value. So images exist for the admin and system domains
+ * only, and only in a directory which root owns and alone can write, e.g.
+ * "/Library/Security/Trust Settings/com.apple.security.trustsettings.1";
+ * only a process running as root writes them. The user domain is always
+ * parsed.
+ */
+static bool tsImagePath(
+	SecTrustSettingsDomain	domain,
+	std::string				&path)
+{
+	switch(domain) {
+		case kSecTrustSettingsDomainAdmin:
+		case kSecTrustSettingsDomainSystem:
+			break;
+		default:
+			return false;
+	}
+	char name[64];
+	snprintf(name, sizeof(name), "/com.apple.security.trustsettings.%d", (int)domain);
+	path = std::string(TRUST_SETTINGS_PATH) + name;
+	return true;
+}
+
+/* owned by root, and not writable by anyone else */
+static bool tsRootOwned(
+	const struct stat		&sb)
+{
+	return (sb.st_uid == 0) && !(sb.st_mode & (S_IWGRP | S_IWOTH));
+}
+
+static void tsPropListDigest(
+	const CSSM_DATA			&propList,
+	uint8					*digest)
+{
+	CC_SHA1(propList.Data, (CC_LONG)propList.Length, digest);
+}
+
+static bool tsInRange(
+	uint32 offset,
+	uint32 length,
+	uint32 limit)
+{
+	return (offset <= limit) && (length <= limit - offset);
+}
+
+/* sort order of the index: by bytes, then by length */
+static int tsCompareKey(
+	const uint8 *k1, uint32 len1,
+	const uint8 *k2, uint32 len2)
+{
+	int c = memcmp(k1, k2, std::min(len1, len2));
+	if(c != 0) {
+		return c;
+	}
+	return (len1 < len2) ? -1 : ((len1 > len2) ? 1 : 0);
+}
+
+
+TrustSettingsImage::TrustSettingsImage(void *map, size_t mapSize)
+	: mMap(map), mMapSize(mapSize), mHeader(reinterpret_cast<const Header *>(map))
+{
+}
+
+TrustSettingsImage::~TrustSettingsImage()
+{
+	::munmap(mMap, mMapSize);
+}
+
+/*
+ * Map an image and check all of it, so lookups can trust what they find.
+ */
+TrustSettingsImage *TrustSettingsImage::open(
+	SecTrustSettingsDomain	domain,
+	const CSSM_DATA			&propList)
+{
+	std::string path;
+	if(!tsImagePath(domain, path)) {
+		return NULL;
+	}
+	struct stat sb;
+	if(::stat(TRUST_SETTINGS_PATH, &sb) || !S_ISDIR(sb.st_mode) || !tsRootOwned(sb)) {
+		return NULL;
+	}
+	int fd = ::open(path.c_str(), O_RDONLY | O_NOFOLLOW);
+	if(fd < 0) {
+		return NULL;
+	}
+	if(::fstat(fd, &sb) || !S_ISREG(sb.st_mode) || !tsRootOwned(sb) ||
+	   (sb.st_size < (off_t)sizeof(Header)) ||
+	   (sb.st_size > 0x7fffffff)) {
+		tsImageDbg("open: %s unusable", path.c_str());
+		::close(fd);
+		return NULL;
+	}
+	size_t mapSize = (size_t)sb.st_size;
+	void *map = ::mmap(NULL, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if(map == MAP_FAILED) {
+		return NULL;
+	}
+
+	const Header *header = reinterpret_cast<const Header *>(map);
+	const uint8 *base = reinterpret_cast<const uint8 *>(map);
+	uint8 digest[CC_SHA1_DIGEST_LENGTH];
+	tsPropListDigest(propList, digest);
+	uint32 size = (uint32)mapSize;
+	bool good = (header->magic == kTsImageMagic) &&
+		(header->version == kTsImageVersion) &&
+		(header->domain == (uint32)domain) &&
+		(header->size == size) &&
+		!memcmp(header->propListDigest, digest, sizeof(digest)) &&
+		(header->numEntries <= size / sizeof(Entry)) &&
+		tsInRange(header->entriesOffset, header->numEntries * sizeof(Entry), size) &&
+		(header->numConstraints <= size / sizeof(Constraint)) &&
+		tsInRange(header->constraintsOffset, header->numConstraints * sizeof(Constraint), size) &&
+		tsInRange(header->dataOffset, header->dataLength, size) &&
+		(header->entriesOffset % sizeof(uint32) == 0) &&
+		(header->constraintsOffset % sizeof(uint32) == 0);
+	if(good) {
+		const Entry *entries = reinterpret_cast<const Entry *>(base + header->entriesOffset);
+		const uint8 *data = base + header->dataOffset;
+		for(uint32 dex = 0; good && dex < header->numEntries; dex++) {
+			const Entry &entry = entries[dex];
+			good = tsInRange(entry.keyOffset, entry.keyLength, header->dataLength) &&
+				tsInRange(entry.firstConstraint, entry.numConstraints, header->numConstraints);
+			if(good && dex > 0) {
+				const Entry &prev = entries[dex - 1];
+				good = tsCompareKey(data + prev.keyOffset, prev.keyLength,
+					data + entry.keyOffset, entry.keyLength) < 0;
+			}
+		}
+		const Constraint *constraints =
+			reinterpret_cast<const Constraint *>(base + header->constraintsOffset);
+		for(uint32 dex = 0; good && dex < header->numConstraints; dex++) {
+			const Constraint &c = constraints[dex];
+			good = tsInRange(c.policyOffset, c.policyLength, header->dataLength) &&
+				tsInRange(c.appOffset, c.appLength, header->dataLength) &&
+				tsInRange(c.policyStrOffset, c.policyStrLength, header->dataLength);
+		}
+	}
+	if(!good) {
+		tsImageDbg("open: %s stale or damaged", path.c_str());
+		::munmap(map, mapSize);
+		return NULL;
+	}
+	tsImageDbg("open: domain %d, %lu entries", (int)domain, (unsigned long)header->numEntries);
+	return new TrustSettingsImage(map, mapSize);
+}
+
+SInt32 TrustSettingsImage::dictVersion() const
+{
+	return mHeader->dictVersion;
+}
+
+const TrustSettingsImage::Entry *TrustSettingsImage::find(
+	CFStringRef		certHashStr) const
+{
+	/* cert hash strings are 40 hex digits, or kSecTrustRecordDefaultRootCert */
+	char key[128];
+	if(!CFStringGetCString(certHashStr, key, sizeof(key), kCFStringEncodingUTF8)) {
+		return NULL;
+	}
+	const uint8 *base = reinterpret_cast<const uint8 *>(mMap);
+	const Entry *entries = reinterpret_cast<const Entry *>(base + mHeader->entriesOffset);
+	const uint8 *data = base + mHeader->dataOffset;
+	uint32 keyLength = (uint32)strlen(key);
+	uint32 low = 0, high = mHeader->numEntries;
+	while(low < high) {
+		uint32 mid = (low + high) / 2;
+		int c = tsCompareKey(data + entries[mid].keyOffset, entries[mid].keyLength,
+			(const uint8 *)key, keyLength);
+		if(c == 0) {
+			return &entries[mid];
+		}
+		else if(c < 0) {
+			low = mid + 1;
+		}
+		else {
+			high = mid;
+		}
+	}
+	return NULL;
+}
+
+const TrustSettingsImage::Constraint *TrustSettingsImage::constraints(
+	const Entry		&entry) const
+{
+	const uint8 *base = reinterpret_cast<const uint8 *>(mMap);
+	return reinterpret_cast<const Constraint *>(base + mHeader->constraintsOffset) +
+		entry.firstConstraint;
+}
+
+CssmData TrustSettingsImage::data(
+	uint32			offset,
+	uint32			length) const
+{
+	uint8 *base = reinterpret_cast<uint8 *>(mMap);
+	return CssmData(base + mHeader->dataOffset + offset, length);
+}
+
+
+#pragma mark --- Compiling ---
+
+/*
+ * Image under construction.
+ */
+struct TsImageBuilder {
+	struct KeyedEntry {
+		std::string			key;
+		std::vector<TrustSettingsImage::Constraint> constraints;
+		bool operator < (const KeyedEntry &other) const
+		{
+			return tsCompareKey((const uint8 *)key.data(), (uint32)key.size(),
+				(const uint8 *)other.key.data(), (uint32)other.key.size()) < 0;
+		}
+	};
+
+	std::vector<KeyedEntry>	entries;
+	std::vector<uint8>		data;
+
+	uint32 addData(const void *bytes, size_t length)
+	{
+		uint32 offset = (uint32)data.size();
+		data.insert(data.end(), (const uint8 *)bytes, (const uint8 *)bytes + length);
+		return offset;
+	}
+};
+
+static bool tsCfStringToUtf8(
+	CFStringRef		str,
+	std::string		&out)
+{
+	CFIndex length = CFStringGetLength(str);
+	CFIndex maxBytes = CFStringGetMaximumSizeForEncoding(length, kCFStringEncodingUTF8);
+	std::vector<char> buf(maxBytes + 1);
+	CFIndex used = 0;
+	if(CFStringGetBytes(str, CFRangeMake(0, length), kCFStringEncodingUTF8, 0, false,
+			(UInt8 *)&buf[0], maxBytes, &used) != length) {
+		return false;
+	}
+	out.assign(&buf[0], used);
+	return true;
+}
+
+static bool tsCompileConstraint(
+	CFDictionaryRef		ucDict,
+	TsImageBuilder		&builder,
+	TrustSettingsImage::Constraint &c)
+{
+	memset(&c, 0, sizeof(c));
+
+	CFDataRef certPolicy = (CFDataRef)CFDictionaryGetValue(ucDict, kSecTrustSettingsPolicy);
+	if(certPolicy != NULL) {
+		c.flags |= TrustSettingsImage::kHasPolicy;
+		c.policyLength = (uint32)CFDataGetLength(certPolicy);
+		c.policyOffset = builder.addData(CFDataGetBytePtr(certPolicy), c.policyLength);
+	}
+	CFDataRef certApp = (CFDataRef)CFDictionaryGetValue(ucDict, kSecTrustSettingsApplication);
+	if(certApp != NULL) {
+		c.flags |= TrustSettingsImage::kHasApplication;
+		c.appLength = (uint32)CFDataGetLength(certApp);
+		c.appOffset = builder.addData(CFDataGetBytePtr(certApp), c.appLength);
+	}
+	CFStringRef policyStr = (CFStringRef)CFDictionaryGetValue(ucDict, kSecTrustSettingsPolicyString);
+	if(policyStr != NULL) {
+		/* as tsCheckPolicyStr() compares it: without any embedded NULs */
+		CFRef<CFMutableStringRef> noNuls(CFStringCreateMutableCopy(NULL, 0, policyStr));
+		if(!noNuls) {
+			return false;
+		}
+		CFStringFindAndReplace(noNuls, CFSTR("\00"), CFSTR(""),
+			CFRangeMake(0, CFStringGetLength(noNuls)), kCFCompareBackwards);
+		std::string utf8;
+		if(!tsCfStringToUtf8(noNuls, utf8)) {
+			return false;
+		}
+		c.flags |= TrustSettingsImage::kHasPolicyString;
+		c.policyStrLength = (uint32)utf8.size();
+		c.policyStrOffset = builder.addData(utf8.data(), utf8.size());
+	}
+
+	struct {
+		CFStringRef key;
+		uint32 flag;
+		sint32 *value;
+	} numbers[] = {
+		{ kSecTrustSettingsKeyUsage, TrustSettingsImage::kHasKeyUsage, &c.keyUsage },
+		{ kSecTrustSettingsResult, TrustSettingsImage::kHasResult, &c.result },
+		{ kSecTrustSettingsAllowedError, TrustSettingsImage::kHasAllowedError, &c.allowedError }
+	};
+	for(unsigned dex = 0; dex < sizeof(numbers) / sizeof(numbers[0]); dex++) {
+		CFNumberRef cfNum = (CFNumberRef)CFDictionaryGetValue(ucDict, numbers[dex].key);
+		if(cfNum != NULL) {
+			SInt32 s;
+			if(!CFNumberGetValue(cfNum, kCFNumberSInt32Type, &s)) {
+				return false;
+			}
+			c.flags |= numbers[dex].flag;
+			*numbers[dex].value = s;
+		}
+	}
+	return true;
+}
+
+void TrustSettingsImage::write(
+	SecTrustSettingsDomain	domain,
+	const CSSM_DATA			&propList,
+	CFDictionaryRef			trustDict,
+	SInt32					dictVersion)
+{
+	std::string path;
+	if((geteuid() != 0) || !tsImagePath(domain, path)) {
+		return;
+	}
+	if((propList.Length == 0) || (trustDict == NULL)) {
+		::unlink(path.c_str());
+		return;
+	}
+
+	/* gather the per-cert entries; mTrustDict has already been validated */
+	TsImageBuilder builder;
+	CFIndex numCerts = CFDictionaryGetCount(trustDict);
+	std::vector<const void *> keys(numCerts);
+	std::vector<const void *> values(numCerts);
+	if(numCerts) {
+		CFDictionaryGetKeysAndValues(trustDict, &keys[0], &values[0]);
+	}
+	builder.entries.resize(numCerts);
+	for(CFIndex dex = 0; dex < numCerts; dex++) {
+		TsImageBuilder::KeyedEntry &entry = builder.entries[dex];
+		if(!tsCfStringToUtf8((CFStringRef)keys[dex], entry.key)) {
+			tsImageDbg("write: unencodable cert key; no image");
+			::unlink(path.c_str());
+			return;
+		}
+		CFArrayRef trustSettings = (CFArrayRef)CFDictionaryGetValue(
+			(CFDictionaryRef)values[dex], kTrustRecordTrustSettings);
+		CFIndex numSpecs = trustSettings ? CFArrayGetCount(trustSettings) : 0;
+		entry.constraints.resize(numSpecs);
+		for(CFIndex spec = 0; spec < numSpecs; spec++) {
+			CFDictionaryRef ucDict =
+				(CFDictionaryRef)CFArrayGetValueAtIndex(trustSettings, spec);
+			if(!tsCompileConstraint(ucDict, builder, entry.constraints[spec])) {
+				tsImageDbg("write: bad usage constraint; no image");
+				::unlink(path.c_str());
+				return;
+			}
+		}
+	}
+	std::sort(builder.entries.begin(), builder.entries.end());
+
+	/* the key strings go at the end of the data table */
+	std::vector<Entry> entries(builder.entries.size());
+	std::vector<Constraint> constraints;
+	for(size_t dex = 0; dex < builder.entries.size(); dex++) {
+		const TsImageBuilder::KeyedEntry &keyed = builder.entries[dex];
+		Entry &entry = entries[dex];
+		entry.keyLength = (uint32)keyed.key.size();
+		entry.keyOffset = builder.addData(keyed.key.data(), keyed.key.size());
+		entry.firstConstraint = (uint32)constraints.size();
+		entry.numConstraints = (uint32)keyed.constraints.size();
+		constraints.insert(constraints.end(), keyed.constraints.begin(), keyed.constraints.end());
+	}
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	header.magic = kTsImageMagic;
+	header.version = kTsImageVersion;
+	tsPropListDigest(propList, header.propListDigest);
+	header.domain = (uint32)domain;
+	header.dictVersion = dictVersion;
+	header.numEntries = (uint32)entries.size();
+	header.entriesOffset = sizeof(Header);
+	header.numConstraints = (uint32)constraints.size();
+	header.constraintsOffset = header.entriesOffset + header.numEntries * sizeof(Entry);
+	header.dataOffset = header.constraintsOffset + header.numConstraints * sizeof(Constraint);
+	header.dataLength = (uint32)builder.data.size();
+	header.size = header.dataOffset + header.dataLength;
+
+	std::vector<uint8> image;
+	image.reserve(header.size);
+	image.insert(image.end(), (const uint8 *)&header, (const uint8 *)(&header + 1));
+	if(!entries.empty()) {
+		image.insert(image.end(), (const uint8 *)&entries[0],
+			(const uint8 *)(&entries[0] + entries.size()));
+	}
+	if(!constraints.empty()) {
+		image.insert(image.end(), (const uint8 *)&constraints[0],
+			(const uint8 *)(&constraints[0] + constraints.size()));
+	}
+	image.insert(image.end(), builder.data.begin(), builder.data.end());
+
+	/* write it beside the old one and rename it into place */
+	char tmpPath[PATH_MAX];
+	snprintf(tmpPath, sizeof(tmpPath), "%s.%d", path.c_str(), (int)getpid());
+	::unlink(tmpPath);
+	int fd = ::open(tmpPath, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW, 0644);
+	if(fd < 0) {
+		tsImageDbg("write: can't create %s", tmpPath);
+		return;
+	}
+	bool good = (::write(fd, &image[0], image.size()) == (ssize_t)image.size());
+	if(::close(fd)) {
+		good = false;
+	}
+	if(!good || ::rename(tmpPath, path.c_str())) {
+		tsImageDbg("write: error writing %s", path.c_str());
+		::unlink(tmpPath);
+		return;
+	}
+	tsImageDbg("write: domain %d, %lu entries", (int)domain, (unsigned long)entries.size());
+}
+
+} /* end namespace KeychainCore */
+
+} /* end namespace Security */
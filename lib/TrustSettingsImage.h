@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * TrustSettingsImage.h - compiled, memory-mapped form of one domain's
+ *						  Trust Settings
+ */
+
+#ifndef	_TRUST_SETTINGS_IMAGE_H_
+#define _TRUST_SETTINGS_IMAGE_H_
+
+#include <security_keychain/SecTrustSettings.h>
+#include <security_cdsa_utilities/cssmdata.h>
+#include <security_utilities/utilities.h>
+#include <CoreFoundation/CoreFoundation.h>
+
+namespace Security
+{
+
+namespace KeychainCore
+{
+
+/*
+ * A TrustSettingsImage holds the per-cert usage constraints of one domain's
+ * Trust Settings, already validated, in a flat file which is mapped rather
+ * than parsed: a header, an index of cert hash strings sorted for binary
+ * search, and fixed-size usage constraint records referring to a table of
+ * policy, application and policy string bytes.
+ *
+ * An image is only good for the property list it was compiled from; it
+ * records the SHA-1 of that property list, and open() returns NULL unless
+ * the plist the caller just read has the same digest. Since the digest
+ * doesn't vouch for the constraints, only the admin and system domains have
+ * images, kept where only root can write them; a process running as root
+ * (re)writes them when TrustSettings flushes a domain to disk, or when it
+ * has had to parse the plist anyway.
+ */
+class TrustSettingsImage
+{
+	NOCOPY(TrustSettingsImage)
+public:
+	/* one cert's entry, as in mTrustDict */
+	struct Entry {
+		uint32		keyOffset;			/* cert hash string, UTF-8, in the data table */
+		uint32		keyLength;
+		uint32		firstConstraint;
+		uint32		numConstraints;		/* zero: no trust settings, i.e. trust root */
+	};
+
+	/* one usage constraint dictionary */
+	enum {
+		kHasPolicy			= 0x01,
+		kHasApplication		= 0x02,
+		kHasPolicyString	= 0x04,
+		kHasKeyUsage		= 0x08,
+		kHasResult			= 0x10,
+		kHasAllowedError	= 0x20
+	};
+	struct Constraint {
+		uint32		flags;				/* kHas* */
+		sint32		keyUsage;
+		sint32		result;
+		sint32		allowedError;
+		uint32		policyOffset;		/* OID bytes */
+		uint32		policyLength;
+		uint32		appOffset;			/* SecTrustedApplication external form */
+		uint32		appLength;
+		uint32		policyStrOffset;	/* UTF-8, embedded NULs removed */
+		uint32		policyStrLength;
+	};
+
+	~TrustSettingsImage();
+
+	/*
+	 * Map the image for the specified domain if there is one, and it was
+	 * compiled from propList. Returns NULL otherwise; never throws.
+	 */
+	static TrustSettingsImage *open(
+		SecTrustSettingsDomain	domain,
+		const CSSM_DATA			&propList);
+
+	/*
+	 * Compile a validated mTrustDict, parsed from propList, into the image
+	 * for the specified domain. An empty propList removes the image.
+	 * Failure is not an error; there just won't be an image next time.
+	 */
+	static void write(
+		SecTrustSettingsDomain	domain,
+		const CSSM_DATA			&propList,
+		CFDictionaryRef			trustDict,
+		SInt32					dictVersion);
+
+	SInt32 dictVersion() const;
+
+	/* find a cert's entry by its hash string; NULL if none */
+	const Entry *find(
+		CFStringRef				certHashStr) const;
+
+	const Constraint *constraints(
+		const Entry				&entry) const;
+
+	/* policy, application, and policy string bytes; points into the mapping */
+	CssmData data(
+		uint32					offset,
+		uint32					length) const;
+
+	struct Header;
+
+private:
+	TrustSettingsImage(void *map, size_t mapSize);
+
+	void					*mMap;
+	size_t					mMapSize;
+	const Header			*mHeader;
+};
+
+} /* end namespace KeychainCore */
+
+} /* end namespace Security */
+
+#endif	/* _TRUST_SETTINGS_IMAGE_H_ */
@@ -29,13 +29,107 @@
 #include <security_keychain/Certificate.h>
 #include <security_keychain/KCCursor.h>
 #include <security_keychain/SecCFTypes.h>
+#include "CCallbackMgr.h"
 #include <security_cdsa_utilities/Schema.h>
 #include <security_keychain/SecTrustSettingsPriv.h>
+#include <security_utilities/globalizer.h>
+#include <set>
+#include <string>
 
 namespace Security {
 namespace KeychainCore {
 
 
+//
+// A per-process cache of the (certificate, policy, keychain list) triples
+// which have no user trust setting. Almost every lookup finds none, so only
+// those answers are kept; a lookup which does find a setting always goes to
+// the keychains, since it may have to copy the certificate into one. The
+// keychains are identified by their DLDbIdentifiers. Any keychain event on
+// a user trust record, or any change of search list, empties the cache; the
+// generation count keeps a lookup that raced with such an event from
+// caching what it found.
+//
+class UserTrustCache {
+public:
+	UserTrustCache();
+
+	static std::string key(const CssmData &certIndex, const CssmOid &policyOid,
+		const StorageManager::KeychainList &keychains);
+	bool find(const std::string &key, uint32 &generation);
+	void add(const std::string &key, uint32 generation);
+	void invalidate();
+
+private:
+	static const size_t maxEntries = 1024;
+
+	Mutex mMutex;
+	uint32 mGeneration;
+	std::set<std::string> mEntries;
+};
+
+static ModuleNexus<UserTrustCache> userTrustCache;
+
+UserTrustCache::UserTrustCache()
+	: mGeneration(0)
+{
+	// other processes' changes only reach us as keychain events, so make
+	// sure someone is listening for those before we cache anything
+	CCallbackMgr::Instance();
+}
+
+std::string UserTrustCache::key(const CssmData &certIndex, const CssmOid &policyOid,
+	const StorageManager::KeychainList &keychains)
+{
+	std::string key;
+	uint32 length = uint32(certIndex.length());
+	key.append(reinterpret_cast<const char *>(&length), sizeof(length));
+	key.append(reinterpret_cast<const char *>(certIndex.data()), certIndex.length());
+	length = uint32(policyOid.length());
+	key.append(reinterpret_cast<const char *>(&length), sizeof(length));
+	key.append(reinterpret_cast<const char *>(policyOid.data()), policyOid.length());
+	for (StorageManager::KeychainList::const_iterator it = keychains.begin(); it != keychains.end(); it++) {
+		DLDbIdentifier dlDbIdentifier = (*it)->dlDbIdentifier();
+		const CssmSubserviceUid &ssuid = dlDbIdentifier.ssuid();
+		uint32 subservice[2] = { ssuid.subserviceId(), ssuid.subserviceType() };
+		key.append(reinterpret_cast<const char *>(&ssuid.guid()), sizeof(CSSM_GUID));
+		key.append(reinterpret_cast<const char *>(subservice), sizeof(subservice));
+		const char *dbName = dlDbIdentifier.dbName() ? dlDbIdentifier.dbName() : "";
+		key.append(dbName, strlen(dbName) + 1);
+	}
+	return key;
+}
+
+bool UserTrustCache::find(const std::string &key, uint32 &generation)
+{
+	StLock<Mutex> _(mMutex);
+	generation = mGeneration;
+	return mEntries.find(key) != mEntries.end();
+}
+
+void UserTrustCache::add(const std::string &key, uint32 generation)
+{
+	StLock<Mutex> _(mMutex);
+	if (generation != mGeneration)
+		return;		// invalidated while we were looking
+	if (mEntries.size() >= maxEntries)
+		mEntries.clear();
+	mEntries.insert(key);
+}
+
+void UserTrustCache::invalidate()
+{
+	StLock<Mutex> _(mMutex);
+	mGeneration++;
+	mEntries.clear();
+}
+
+void TrustStore::userTrustChanged()
+{
+	userTrustCache().invalidate();
+}
+
+
 //
 // Make and break: trivial
 //
@@ -49,13 +143,36 @@ TrustStore::~TrustStore()
 
 //
 // Retrieve the trust setting for a (certificate, policy) pair.
+// "No setting" answers are cached until the user trust records or the
+// search list change.
 //
 SecTrustUserSetting TrustStore::find(Certificate *cert, Policy *policy,
 	StorageManager::KeychainList &keychainList)
 {
 	StLock<Mutex> _(mMutex);
+
+	CssmAutoData certIndex(Allocator::standard());
+	UserTrustItem::makeCertIndex(cert, certIndex);
+	std::string key = UserTrustCache::key(certIndex.get(), policy->oid(), keychainList);
+	uint32 generation;
+	if (userTrustCache().find(key, generation))
+		return kSecTrustResultUnspecified;
+
+	bool found;
+	SecTrustUserSetting setting = findSetting(cert, policy, keychainList, found);
+	if (!found)
+		userTrustCache().add(key, generation);
+	return setting;
+}
+
+SecTrustUserSetting TrustStore::findSetting(Certificate *cert, Policy *policy,
+	StorageManager::KeychainList &keychainList, bool &found)
+{
+	StLock<Mutex> _(mMutex);
 	
+	found = false;
 	if (Item item = findItem(cert, policy, keychainList)) {
+		found = true;
 		// Make sure that the certificate is available in some keychain,
 		// to provide a basis for editing the trust setting that we're returning.
 		if (cert->keychain() == NULL) {
@@ -151,6 +268,9 @@ void TrustStore::assign(Certificate *cert, Policy *policy, SecTrustUserSetting t
 			}
 		}
 	}
+
+	// don't wait for the keychain event to forget the old setting
+	userTrustChanged();
 }
 
 
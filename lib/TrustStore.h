@@ -55,12 +55,17 @@ public:
     SecTrustUserSetting find(Certificate *cert, Policy *policy, 
 		StorageManager::KeychainList &keychainList);
     void assign(Certificate *cert, Policy *policy, SecTrustUserSetting assignment);
+
+	// forget cached user trust settings (keychain event or search list change)
+	static void userTrustChanged();
     
 	void getCssmRootCertificates(CertGroup &roots);
 	
 	typedef UserTrustItem::TrustData TrustData;
 	
 protected:
+	SecTrustUserSetting findSetting(Certificate *cert, Policy *policy,
+		StorageManager::KeychainList &keychainList, bool &found);
 	Item findItem(Certificate *cert, Policy *policy, 
 		StorageManager::KeychainList &keychainList);
 	void loadRootCertificates();
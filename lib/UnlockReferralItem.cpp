@@ -90,7 +90,7 @@ PrimaryKey UnlockReferralItem::add(Keychain &keychain)
 			Schema::UnlockReferralSchemaAttributeList,
 			Schema::UnlockReferralSchemaIndexCount,
 			Schema::UnlockReferralSchemaIndexList);
-		keychain->keychainSchema()->didCreateRelation(
+		keychain->didCreateRelation(
 			CSSM_DL_DB_RECORD_UNLOCK_REFERRAL,
 			"CSSM_DL_DB_RECORD_UNLOCK_REFERRAL",
 			Schema::UnlockReferralSchemaAttributeCount,
@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * diffDecoders.c - differential test of the generated decoders in
+ * DER_Generated.c against DERParseSequenceContent().
+ *
+ * Every constructed item found anywhere in each input file is run through
+ * every generated decoder and through DERParseSequenceContent() with the
+ * corresponding DERItemSpec table, and the results compared. Most pairings
+ * are of course mismatches which the decoders must reject identically.
+ * Each item is also tried truncated, and with each enclosed item's tag
+ * replaced, to exercise the error paths.
+ *
+ * Typical use:
+ *		diffDecoders certsCrls/EndCertificateCP.01.01.crt certsCrls/Test_CRL_CA1.crl
+ */
+
+#include <stdlib.h>
+#include <strings.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <libDER/libDER.h>
+#include <libDER/asn1Types.h>
+#include <libDER/DER_Decode.h>
+#include <libDER/DER_Generated.h>
+#include <libDERUtils/fileIo.h>
+#include <libDERUtils/libDERUtils.h>
+
+static void usage(char **argv)
+{
+	printf("usage: %s [options] derFile...\n", argv[0]);
+	printf("Options:\n");
+	printf("  -l loops  -- also time both decoders over the input, loops times\n");
+	printf("  -v        -- verbose \n");
+	exit(1);
+}
+
+#define MAX_DEST_ITEMS		32
+#define MAX_DEPTH			16
+#define FILL_BYTE			0xa5
+
+static int verbose = 0;
+static unsigned numCompares = 0;
+static unsigned numMismatches = 0;
+
+/* size of the struct a DERItemSpec table decodes into */
+static DERSize destSize(
+	const DERGeneratedDecoder *dec)
+{
+	DERSize size = 0;
+	DERSize dex;
+
+	for(dex=0; dex<*dec->numItemSpecs; dex++) {
+		DERSize end = dec->itemSpecs[dex].offset + sizeof(DERItem);
+		if(end > size) {
+			size = end;
+		}
+	}
+	return size;
+}
+
+/*
+ * Compare dest buffers item by item; DERItem may contain padding, which
+ * struct assignment need not copy.
+ */
+static int destsDiffer(
+	const DERItem *interp,
+	const DERItem *gen)
+{
+	unsigned dex;
+
+	for(dex=0; dex<MAX_DEST_ITEMS; dex++) {
+		if((interp[dex].data != gen[dex].data) ||
+		   (interp[dex].length != gen[dex].length)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* run one decoder both ways on content and compare */
+static void compareOne(
+	const DERGeneratedDecoder *dec,
+	const DERItem *content,
+	const char *what)
+{
+	DERItem interp[MAX_DEST_ITEMS];
+	DERItem gen[MAX_DEST_ITEMS];
+	DERSize size = destSize(dec);
+	DERReturn irtn, grtn;
+	int zero;
+
+	if(size > sizeof(interp)) {
+		printf("***%s: dest too big (%u)\n", dec->name, (unsigned)size);
+		exit(1);
+	}
+
+	/* once with sizeToZero, once without to check untouched fields */
+	for(zero=0; zero<2; zero++) {
+		memset(interp, FILL_BYTE, sizeof(interp));
+		memset(gen, FILL_BYTE, sizeof(gen));
+		irtn = DERParseSequenceContent(content, *dec->numItemSpecs,
+			dec->itemSpecs, interp, zero ? size : 0);
+		grtn = dec->parseContent(content, gen, zero ? size : 0);
+		numCompares++;
+		if((irtn != grtn) || destsDiffer(interp, gen)) {
+			numMismatches++;
+			printf("***MISMATCH: %s on %s (%u bytes): interpreted %s, ",
+				dec->name, what, (unsigned)content->length, DERReturnString(irtn));
+			printf("generated %s\n", DERReturnString(grtn));
+		}
+		else if(verbose) {
+			printf("%s on %s: %s\n", dec->name, what, DERReturnString(irtn));
+		}
+	}
+}
+
+/* run all decoders on content, plus truncated and tag-substituted copies */
+static void compareAll(
+	const DERItem *content)
+{
+	static const DERByte substTags[] = {
+		0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x17, 0x30, 0x31, 0x80, 0x81, 0xa0, 0xa3
+	};
+	DERSize dex;
+	DERByte *copy;
+	DERItem item;
+	DERSequence seq;
+	DERDecodedInfo child;
+	unsigned trunc;
+
+	for(dex=0; dex<DERNumGeneratedDecoders; dex++) {
+		compareOne(&DERGeneratedDecoders[dex], content, "item");
+	}
+	if(content->length == 0) {
+		return;
+	}
+	copy = (DERByte *)malloc(content->length);
+	memmove(copy, content->data, content->length);
+	item.data = copy;
+
+	for(trunc=1; (trunc<=4) && (trunc<content->length); trunc++) {
+		item.length = content->length - trunc;
+		for(dex=0; dex<DERNumGeneratedDecoders; dex++) {
+			compareOne(&DERGeneratedDecoders[dex], &item, "truncated item");
+		}
+	}
+
+	item.length = content->length;
+	DERDecodeSeqContentInit(&item, &seq);
+	for(;;) {
+		DERByte *tagByte = seq.nextItem;
+		DERByte origTag = *tagByte;
+		unsigned t;
+
+		if(DERDecodeSeqNext(&seq, &child)) {
+			break;
+		}
+		for(t=0; t<sizeof(substTags); t++) {
+			if(substTags[t] == origTag) {
+				continue;
+			}
+			*tagByte = substTags[t];
+			for(dex=0; dex<DERNumGeneratedDecoders; dex++) {
+				compareOne(&DERGeneratedDecoders[dex], &item, "substituted item");
+			}
+		}
+		*tagByte = origTag;
+	}
+	free(copy);
+}
+
+/* callback for each constructed item found */
+typedef void (*itemFcn)(const DERItem *content, void *ctx);
+
+static void walk(
+	const DERItem *der,
+	unsigned depth,
+	itemFcn fcn,
+	void *ctx)
+{
+	DERDecodedInfo decoded;
+	DERSequence seq;
+	DERDecodedInfo child;
+	DERByte *childStart;
+
+	if(depth > MAX_DEPTH) {
+		return;
+	}
+	if(DERDecodeItem(der, &decoded)) {
+		return;
+	}
+	if(!(decoded.tag & ASN1_CONSTRUCTED)) {
+		return;
+	}
+	fcn(&decoded.content, ctx);
+	DERDecodeSeqContentInit(&decoded.content, &seq);
+	for(;;) {
+		DERItem childDER;
+
+		childStart = seq.nextItem;
+		if(DERDecodeSeqNext(&seq, &child)) {
+			break;
+		}
+		childDER.data = childStart;
+		childDER.length = (child.content.data + child.content.length) - childStart;
+		walk(&childDER, depth + 1, fcn, ctx);
+	}
+}
+
+static void compareFcn(
+	const DERItem *content,
+	void *ctx)
+{
+	(void)ctx;
+	compareAll(content);
+}
+
+/* benchmarking */
+static void interpFcn(
+	const DERItem *content,
+	void *ctx)
+{
+	DERItem dest[MAX_DEST_ITEMS];
+	DERSize dex;
+
+	(void)ctx;
+	for(dex=0; dex<DERNumGeneratedDecoders; dex++) {
+		const DERGeneratedDecoder *dec = &DERGeneratedDecoders[dex];
+		DERParseSequenceContent(content, *dec->numItemSpecs, dec->itemSpecs,
+			dest, sizeof(dest));
+	}
+}
+
+static void genFcn(
+	const DERItem *content,
+	void *ctx)
+{
+	DERItem dest[MAX_DEST_ITEMS];
+	DERSize dex;
+
+	(void)ctx;
+	for(dex=0; dex<DERNumGeneratedDecoders; dex++) {
+		DERGeneratedDecoders[dex].parseContent(content, dest, sizeof(dest));
+	}
+}
+
+static double timeWalk(
+	DERItem *items,
+	unsigned numItems,
+	unsigned loops,
+	itemFcn fcn)
+{
+	struct timeval start, end;
+	unsigned loop, dex;
+
+	gettimeofday(&start, NULL);
+	for(loop=0; loop<loops; loop++) {
+		for(dex=0; dex<numItems; dex++) {
+			walk(&items[dex], 0, fcn, NULL);
+		}
+	}
+	gettimeofday(&end, NULL);
+	return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+}
+
+int main(int argc, char **argv)
+{
+	extern char *optarg;
+	extern int optind;
+	int arg;
+	unsigned loops = 0;
+	DERItem *items;
+	unsigned numItems = 0;
+	int dex;
+
+	while ((arg = getopt(argc, argv, "l:vh")) != -1) {
+		switch (arg) {
+			case 'l':
+				loops = atoi(optarg);
+				break;
+			case 'v':
+				verbose = 1;
+				break;
+			case 'h':
+			default:
+				usage(argv);
+		}
+	}
+	if(optind == argc) {
+		usage(argv);
+	}
+
+	items = (DERItem *)malloc(sizeof(DERItem) * (argc - optind));
+	for(dex=optind; dex<argc; dex++) {
+		unsigned char *data = NULL;
+		unsigned dataLen = 0;
+		DERDecodedInfo decoded;
+
+		if(readFile(argv[dex], &data, &dataLen)) {
+			printf("***Error reading %s. Aborting.\n", argv[dex]);
+			exit(1);
+		}
+		items[numItems].data = data;
+		items[numItems].length = dataLen;
+		if(DERDecodeItem(&items[numItems], &decoded)) {
+			printf("...%s is not DER, skipping\n", argv[dex]);
+			free(data);
+			continue;
+		}
+		walk(&items[numItems], 0, compareFcn, NULL);
+		numItems++;
+	}
+	printf("%u files, %u decoders, %u comparisons, %u mismatches\n",
+		numItems, (unsigned)DERNumGeneratedDecoders, numCompares, numMismatches);
+
+	if(loops) {
+		double interp = timeWalk(items, numItems, loops, interpFcn);
+		double gen = timeWalk(items, numItems, loops, genFcn);
+		printf("interpreted %.3f s, generated %.3f s (%.2fx)\n",
+			interp, gen, gen > 0.0 ? interp / gen : 0.0);
+	}
+	return numMismatches ? 1 : 0;
+}
@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * diffEncoders.c - differential test of DEREncodeSequenceReverse() and
+ * the DERReverseEncoder against DEREncodeSequence().
+ *
+ * Every DERItemSpec table in DER_CertCrl.c and DER_Keys.c (via the list
+ * in DER_Generated.h) is used to encode synthetic content of assorted
+ * lengths with both encoders, and the results compared byte for byte.
+ * The cases include zero-length items, content lengths either side of
+ * the 0x80 boundary (where a short form length byte would read as
+ * indefinite length), signed integers needing a leading zero, a
+ * pre-encoded indefinite length item passed through with
+ * DER_ENC_WRITE_DER, sequences nested several deep, and buffers one
+ * byte too small.
+ *
+ * Any DER files named on the command line are also walked; each
+ * constructed item in them which a table decodes is re-encoded both ways.
+ *
+ * Typical use:
+ *		diffEncoders certsCrls/EndCertificateCP.01.01.crt certsCrls/Test_CRL_CA1.crl
+ */
+
+#include <stdlib.h>
+#include <strings.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <libDER/libDER.h>
+#include <libDER/asn1Types.h>
+#include <libDER/DER_Decode.h>
+#include <libDER/DER_Encode.h>
+#include <libDER/DER_Generated.h>
+#include <libDERUtils/fileIo.h>
+#include <libDERUtils/libDERUtils.h>
+
+static void usage(char **argv)
+{
+	printf("usage: %s [options] [derFile...]\n", argv[0]);
+	printf("Options:\n");
+	printf("  -v        -- verbose \n");
+	exit(1);
+}
+
+#define MAX_SRC_ITEMS		32
+#define MAX_DEPTH			16
+#define MAX_NEST			4
+#define FILL_BYTE			0xa5
+
+static int verbose = 0;
+static unsigned numCompares = 0;
+static unsigned numMismatches = 0;
+
+/* encode src both ways into buffers of bufLen bytes and compare */
+static void compareOne(
+	const char *name,
+	DERTag topTag,
+	const void *src,
+	DERShort numItemSpecs,
+	const DERItemSpec *itemSpecs,
+	DERSize bufLen,
+	const char *what)
+{
+	DERByte *fwd = (DERByte *)malloc(bufLen + 1);
+	DERByte *rev = (DERByte *)malloc(bufLen + 1);
+	DERSize fwdLen = bufLen;
+	DERSize revLen = bufLen;
+	DERReturn frtn, rrtn;
+
+	memset(fwd, FILL_BYTE, bufLen + 1);
+	memset(rev, FILL_BYTE, bufLen + 1);
+	frtn = DEREncodeSequence(topTag, src, numItemSpecs, itemSpecs, fwd, &fwdLen);
+	rrtn = DEREncodeSequenceReverse(topTag, src, numItemSpecs, itemSpecs, rev, &revLen);
+	numCompares++;
+	if((frtn != rrtn) ||
+	   ((frtn == DR_Success) &&
+	    ((fwdLen != revLen) || memcmp(fwd, rev, fwdLen))) ||
+	   (fwd[bufLen] != FILL_BYTE) || (rev[bufLen] != FILL_BYTE)) {
+		numMismatches++;
+		printf("***MISMATCH: %s on %s (%u byte buffer): forward %s (%u bytes), ",
+			name, what, (unsigned)bufLen, DERReturnString(frtn), (unsigned)fwdLen);
+		printf("reverse %s (%u bytes)\n", DERReturnString(rrtn), (unsigned)revLen);
+	}
+	else if(verbose) {
+		printf("%s on %s: %s\n", name, what, DERReturnString(frtn));
+	}
+	free(fwd);
+	free(rev);
+}
+
+/*
+ * Encode with the exact size DERLengthOfEncodedSequence() predicts,
+ * with room to spare, and with one byte too few.
+ */
+static void compareSizes(
+	const char *name,
+	DERTag topTag,
+	const void *src,
+	DERShort numItemSpecs,
+	const DERItemSpec *itemSpecs,
+	const char *what)
+{
+	DERSize len = DERLengthOfEncodedSequence(topTag, src, numItemSpecs, itemSpecs);
+
+	compareOne(name, topTag, src, numItemSpecs, itemSpecs, len, what);
+	compareOne(name, topTag, src, numItemSpecs, itemSpecs, len + 16, what);
+	compareOne(name, topTag, src, numItemSpecs, itemSpecs, len - 1, what);
+}
+
+/*
+ * Nest the encoding of itemSpecs depth levels deep, each level followed
+ * by a trailing INTEGER as the signature follows the TBS part of a
+ * certificate: the forward encoder encodes each level separately and
+ * wraps it with DER_ENC_WRITE_DER, the reverse encoder does it all in
+ * one pass.
+ */
+static void compareNested(
+	const DERGeneratedDecoder *dec,
+	const void *src,
+	unsigned depth)
+{
+	static const DERItemSpec wrapSpecs[] = {
+		{ 0, ASN1_CONSTR_SEQUENCE, DER_ENC_WRITE_DER },
+		{ sizeof(DERItem), ASN1_INTEGER, DER_ENC_SIGNED_INT }
+	};
+	static DERByte trailer[] = { 0x80, 0x01 };
+	DERShort numItemSpecs = (DERShort)*dec->numItemSpecs;
+	DERSize bufLen = DERLengthOfEncodedSequence(ASN1_CONSTR_SEQUENCE,
+		src, numItemSpecs, dec->itemSpecs) + (depth * 16);
+	DERByte *fwd = (DERByte *)malloc(bufLen);
+	DERByte *tmp = (DERByte *)malloc(bufLen);
+	DERByte *rev = (DERByte *)malloc(bufLen);
+	DERSize fwdLen = bufLen;
+	DERReverseEncoder enc;
+	DERSize marks[MAX_NEST];
+	DERItem wrap[2];
+	DERItem result;
+	DERReturn frtn, rrtn;
+	unsigned level;
+
+	/* forward, inside out */
+	frtn = DEREncodeSequence(ASN1_CONSTR_SEQUENCE, src, numItemSpecs,
+		dec->itemSpecs, fwd, &fwdLen);
+	for(level=0; (level<depth) && (frtn == DR_Success); level++) {
+		DERSize tmpLen = bufLen;
+
+		wrap[0].data = fwd;
+		wrap[0].length = fwdLen;
+		wrap[1].data = trailer;
+		wrap[1].length = sizeof(trailer);
+		frtn = DEREncodeSequence(ASN1_CONSTR_SEQUENCE, wrap, 2, wrapSpecs,
+			tmp, &tmpLen);
+		memmove(fwd, tmp, tmpLen);
+		fwdLen = tmpLen;
+	}
+
+	/* reverse, one pass: outermost trailer first */
+	result.data = NULL;
+	result.length = 0;
+	rrtn = DERReverseInit(&enc, rev, bufLen);
+	for(level=depth; (level>0) && (rrtn == DR_Success); level--) {
+		marks[level - 1] = DERReverseLength(&enc);
+		rrtn = DERReverseEncodeItem(&enc, ASN1_INTEGER, trailer,
+			sizeof(trailer), DER_ENC_SIGNED_INT);
+	}
+	if(rrtn == DR_Success) {
+		rrtn = DERReverseEncodeSequence(&enc, ASN1_CONSTR_SEQUENCE, src,
+			numItemSpecs, dec->itemSpecs);
+	}
+	for(level=0; (level<depth) && (rrtn == DR_Success); level++) {
+		rrtn = DERReverseEncodeConstructed(&enc, ASN1_CONSTR_SEQUENCE,
+			marks[level]);
+	}
+	if(rrtn == DR_Success) {
+		DERReverseResult(&enc, &result);
+	}
+
+	numCompares++;
+	if((frtn != rrtn) ||
+	   ((frtn == DR_Success) &&
+	    ((fwdLen != result.length) || memcmp(fwd, result.data, fwdLen)))) {
+		numMismatches++;
+		printf("***MISMATCH: %s nested %u deep: forward %s (%u bytes), ",
+			dec->name, depth, DERReturnString(frtn), (unsigned)fwdLen);
+		printf("reverse %s (%u bytes)\n", DERReturnString(rrtn),
+			(unsigned)result.length);
+	}
+	else if(verbose) {
+		printf("%s nested %u deep: %s\n", dec->name, depth, DERReturnString(frtn));
+	}
+	free(fwd);
+	free(tmp);
+	free(rev);
+}
+
+/* set every item in src to content */
+static void fillSrc(
+	DERItem *src,
+	DERByte *content,
+	DERSize length)
+{
+	unsigned dex;
+
+	for(dex=0; dex<MAX_SRC_ITEMS; dex++) {
+		src[dex].data = content;
+		src[dex].length = length;
+	}
+}
+
+/* encode synthetic content with every table */
+static void compareSynthetic(void)
+{
+	/* either side of each length encoding boundary */
+	static const DERSize lengths[] = {
+		0, 1, 0x7e, 0x7f, 0x80, 0x81, 0xff, 0x100, 0xffff, 0x10000
+	};
+	/* leading byte with and without a signed integer pad */
+	static const DERByte leading[] = { 0x01, 0x80 };
+	/* indefinite length SEQUENCE { INTEGER 0 }, which only WRITE_DER may emit */
+	static DERByte indefinite[] = { 0x30, 0x80, 0x02, 0x01, 0x00, 0x00, 0x00 };
+	static const DERItemSpec indefSpecs[] = {
+		{ 0, ASN1_CONSTR_SEQUENCE, DER_ENC_WRITE_DER },
+		{ sizeof(DERItem), ASN1_OCTET_STRING, DER_ENC_NO_OPTS }
+	};
+	DERItem src[MAX_SRC_ITEMS];
+	DERSize maxLen = lengths[sizeof(lengths) / sizeof(lengths[0]) - 1];
+	DERByte *content = (DERByte *)malloc(maxLen);
+	DERSize dex;
+	unsigned l, b, depth;
+	char what[64];
+
+	memset(content, FILL_BYTE, maxLen);
+	for(dex=0; dex<DERNumGeneratedDecoders; dex++) {
+		const DERGeneratedDecoder *dec = &DERGeneratedDecoders[dex];
+		DERShort numItemSpecs = (DERShort)*dec->numItemSpecs;
+
+		if(numItemSpecs > MAX_SRC_ITEMS) {
+			printf("***%s: too many items (%u)\n", dec->name, (unsigned)numItemSpecs);
+			exit(1);
+		}
+		for(l=0; l<sizeof(lengths)/sizeof(lengths[0]); l++) {
+			for(b=0; b<sizeof(leading); b++) {
+				if((lengths[l] == 0) && (b != 0)) {
+					continue;
+				}
+				if(lengths[l] != 0) {
+					content[0] = leading[b];
+				}
+				fillSrc(src, content, lengths[l]);
+				snprintf(what, sizeof(what), "%u byte items, leading 0x%02x",
+					(unsigned)lengths[l], lengths[l] ? leading[b] : 0);
+				compareSizes(dec->name, ASN1_CONSTR_SEQUENCE, src,
+					numItemSpecs, dec->itemSpecs, what);
+				compareSizes(dec->name, ASN1_CONSTR_SET, src,
+					numItemSpecs, dec->itemSpecs, what);
+			}
+		}
+
+		/* the same, wrapped in SEQUENCEs several deep */
+		content[0] = leading[0];
+		fillSrc(src, content, 0x81);
+		for(depth=0; depth<=MAX_NEST; depth++) {
+			compareNested(dec, src, depth);
+		}
+		fillSrc(src, content, 0);
+		compareNested(dec, src, MAX_NEST);
+	}
+
+	/* pre-encoded indefinite length item, then a zero-length item */
+	src[0].data = indefinite;
+	src[0].length = sizeof(indefinite);
+	src[1].data = NULL;
+	src[1].length = 0;
+	compareSizes("indefinite", ASN1_CONSTR_SEQUENCE, src, 2, indefSpecs,
+		"WRITE_DER indefinite length item");
+	free(content);
+}
+
+/* re-encode one constructed item with every table which decodes it */
+static void compareDecoded(
+	const DERItem *content,
+	DERTag tag)
+{
+	DERItem dest[MAX_SRC_ITEMS];
+	DERSize dex;
+
+	for(dex=0; dex<DERNumGeneratedDecoders; dex++) {
+		const DERGeneratedDecoder *dec = &DERGeneratedDecoders[dex];
+
+		if(DERParseSequenceContent(content, *dec->numItemSpecs, dec->itemSpecs,
+				dest, sizeof(dest))) {
+			continue;
+		}
+		compareSizes(dec->name, tag, dest, (DERShort)*dec->numItemSpecs,
+			dec->itemSpecs, "decoded item");
+	}
+}
+
+static void walk(
+	const DERItem *der,
+	unsigned depth)
+{
+	DERDecodedInfo decoded;
+	DERSequence seq;
+	DERDecodedInfo child;
+	DERByte *childStart;
+
+	if(depth > MAX_DEPTH) {
+		return;
+	}
+	if(DERDecodeItem(der, &decoded)) {
+		return;
+	}
+	if(!(decoded.tag & ASN1_CONSTRUCTED)) {
+		return;
+	}
+	compareDecoded(&decoded.content, decoded.tag);
+	DERDecodeSeqContentInit(&decoded.content, &seq);
+	for(;;) {
+		DERItem childDER;
+
+		childStart = seq.nextItem;
+		if(DERDecodeSeqNext(&seq, &child)) {
+			break;
+		}
+		childDER.data = childStart;
+		childDER.length = (child.content.data + child.content.length) - childStart;
+		walk(&childDER, depth + 1);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	extern int optind;
+	int arg;
+	unsigned numFiles = 0;
+	int dex;
+
+	while ((arg = getopt(argc, argv, "vh")) != -1) {
+		switch (arg) {
+			case 'v':
+				verbose = 1;
+				break;
+			case 'h':
+			default:
+				usage(argv);
+		}
+	}
+
+	compareSynthetic();
+
+	for(dex=optind; dex<argc; dex++) {
+		unsigned char *data = NULL;
+		unsigned dataLen = 0;
+		DERItem item;
+
+		if(readFile(argv[dex], &data, &dataLen)) {
+			printf("***Error reading %s. Aborting.\n", argv[dex]);
+			exit(1);
+		}
+		item.data = data;
+		item.length = dataLen;
+		walk(&item, 0);
+		numFiles++;
+		free(data);
+	}
+	printf("%u files, %u tables, %u comparisons, %u mismatches\n",
+		numFiles, (unsigned)DERNumGeneratedDecoders, numCompares, numMismatches);
+	return numMismatches ? 1 : 0;
+}
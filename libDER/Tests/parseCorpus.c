@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * parseCorpus.c - parse a corpus of certificates and CRLs in parallel,
+ * reporting failures, throughput, and where the time went.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <libDER/libDER.h>
+#include <libDERUtils/bulkParse.h>
+#include <libDERUtils/libDERUtils.h>
+
+static void usage(char **argv)
+{
+	printf("usage: %s [options] path...\n", argv[0]);
+	printf("  Each path is a directory, a DER file or concatenation of DER\n");
+	printf("  objects, or a PEM bundle.\n");
+	printf("Options:\n");
+	printf("  -t threads  -- default is one per CPU\n");
+	printf("  -l loops    -- parse the corpus loops times; default 1\n");
+	printf("  -j file     -- write a JSON summary of each object to file\n");
+	printf("  -q          -- quiet, don't list failures\n");
+	exit(1);
+}
+
+static void printJSONString(
+	FILE *f,
+	const char *str)
+{
+	fputc('"', f);
+	for(; *str; str++) {
+		unsigned char c = (unsigned char)*str;
+		if((c == '"') || (c == '\\')) {
+			fprintf(f, "\\%c", c);
+		}
+		else if(c < 0x20) {
+			fprintf(f, "\\u%04x", c);
+		}
+		else {
+			fputc(c, f);
+		}
+	}
+	fputc('"', f);
+}
+
+static int writeJSON(
+	const BulkCorpus *corpus,
+	const char *fileName)
+{
+	FILE *f = fopen(fileName, "w");
+	unsigned dex;
+
+	if(f == NULL) {
+		return -1;
+	}
+	fprintf(f, "{\n  \"objects\": [\n");
+	for(dex=0; dex<corpus->numObjects; dex++) {
+		const BulkObject *obj = &corpus->objects[dex];
+
+		fprintf(f, "    {\"source\": ");
+		printJSONString(f, corpus->sources[obj->source].path);
+		fprintf(f, ", \"index\": %u, \"offset\": %lu, \"length\": %u, \"type\": \"%s\", ",
+			obj->index, (unsigned long)obj->offset, (unsigned)obj->der.length,
+			bulkObjectTypeString(obj->type));
+		fprintf(f, "\"status\": \"%s\", ", DERReturnString(obj->status));
+		if(obj->status) {
+			fprintf(f, "\"phase\": \"%s\", ", bulkPhaseString(obj->failedPhase));
+		}
+		else {
+			fprintf(f, "\"phase\": null, ");
+		}
+		fprintf(f, "\"%s\": %u}%s\n",
+			(obj->type == BO_Crl) ? "revokedCerts" : "extensions",
+			obj->numItems, (dex + 1 < corpus->numObjects) ? "," : "");
+	}
+	fprintf(f, "  ],\n");
+	fprintf(f, "  \"summary\": {\"objects\": %u, \"certs\": %u, \"crls\": %u, "
+		"\"failed\": %u, \"bytes\": %llu, \"threads\": %u, \"parseSeconds\": %f}\n}\n",
+		corpus->numObjects, corpus->numCerts, corpus->numCrls, corpus->numFailed,
+		(unsigned long long)corpus->totalBytes, corpus->numThreads, corpus->parseTime);
+	fclose(f);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	extern char *optarg;
+	extern int optind;
+	int arg;
+	unsigned numThreads = 0;
+	unsigned loops = 1;
+	unsigned loop;
+	char *jsonFile = NULL;
+	int quiet = 0;
+	BulkCorpus corpus;
+	double phaseTime[BP_NumPhases];
+	double parseTime = 0.0;
+	unsigned dex;
+	int rtn;
+
+	while ((arg = getopt(argc, argv, "t:l:j:qh")) != -1) {
+		switch (arg) {
+			case 't':
+				numThreads = atoi(optarg);
+				break;
+			case 'l':
+				loops = atoi(optarg);
+				if(loops == 0) {
+					usage(argv);
+				}
+				break;
+			case 'j':
+				jsonFile = optarg;
+				break;
+			case 'q':
+				quiet = 1;
+				break;
+			case 'h':
+			default:
+				usage(argv);
+		}
+	}
+	if(optind == argc) {
+		usage(argv);
+	}
+
+	bulkCorpusInit(&corpus);
+	for(; optind<argc; optind++) {
+		rtn = bulkCorpusAddPath(&corpus, argv[optind]);
+		if(rtn) {
+			printf("***Error reading %s: %s. Aborting.\n", argv[optind], strerror(rtn));
+			exit(1);
+		}
+	}
+
+	memset(phaseTime, 0, sizeof(phaseTime));
+	for(loop=0; loop<loops; loop++) {
+		rtn = bulkCorpusParse(&corpus, numThreads);
+		if(rtn) {
+			printf("***Error parsing: %s. Aborting.\n", strerror(rtn));
+			exit(1);
+		}
+		for(dex=BP_Outer; dex<BP_NumPhases; dex++) {
+			phaseTime[dex] += corpus.phaseTime[dex];
+		}
+		parseTime += corpus.parseTime;
+	}
+	phaseTime[BP_Load] = corpus.phaseTime[BP_Load];
+	phaseTime[BP_Split] = corpus.phaseTime[BP_Split];
+
+	if(!quiet) {
+		for(dex=0; dex<corpus.numObjects; dex++) {
+			const BulkObject *obj = &corpus.objects[dex];
+			if(obj->status == DR_Success) {
+				continue;
+			}
+			printf("***%s object %u (offset %lu): %s failed: %s\n",
+				corpus.sources[obj->source].path, obj->index,
+				(unsigned long)obj->offset, bulkPhaseString(obj->failedPhase),
+				DERReturnString(obj->status));
+		}
+	}
+
+	printf("%u objects in %u files: %u certs, %u CRLs, %u failed; %llu bytes\n",
+		corpus.numObjects, corpus.numSources, corpus.numCerts, corpus.numCrls,
+		corpus.numFailed, (unsigned long long)corpus.totalBytes);
+	printf("%-8s %10.3f ms\n", bulkPhaseString(BP_Load), phaseTime[BP_Load] * 1000.0);
+	printf("%-8s %10.3f ms\n", bulkPhaseString(BP_Split), phaseTime[BP_Split] * 1000.0);
+	for(dex=BP_Outer; dex<BP_NumPhases; dex++) {
+		printf("%-8s %10.3f ms CPU, %.3f us/object\n",
+			bulkPhaseString((BulkPhase)dex), phaseTime[dex] * 1000.0,
+			corpus.numObjects ? phaseTime[dex] * 1e6 / ((double)corpus.numObjects * loops) : 0.0);
+	}
+	if(parseTime > 0.0) {
+		double objects = (double)corpus.numObjects * loops;
+		double bytes = (double)corpus.totalBytes * loops;
+		printf("parse    %10.3f ms wall, %u threads, %.0f objects/s, %.2f MB/s\n",
+			parseTime * 1000.0, corpus.numThreads, objects / parseTime,
+			bytes / parseTime / (1024.0 * 1024.0));
+	}
+
+	if(jsonFile && writeJSON(&corpus, jsonFile)) {
+		printf("***Error writing %s\n", jsonFile);
+	}
+	rtn = corpus.numFailed ? 1 : 0;
+	bulkCorpusFree(&corpus);
+	return rtn;
+}
@@ -8,10 +8,13 @@
 #include <strings.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
 #include <libDER/libDER.h>
 #include <libDER/asn1Types.h>
 #include <libDER/DER_CertCrl.h>
 #include <libDER/DER_Keys.h>
+#include <libDER/DER_Stream.h>
 #include <libDERUtils/fileIo.h>
 #include <libDERUtils/libDERUtils.h>
 #include <libDERUtils/printFields.h>
@@ -21,23 +24,57 @@ static void usage(char **argv)
 	printf("usage: %s crlFile [options]\n", argv[0]);
 	printf("Options:\n");
 	printf("  -v     -- verbose \n");
+	printf("  -s     -- streaming decode; walk revoked certs without reading whole file\n");
+	printf("  -q     -- quiet; count revoked certs but print nothing else\n");
+	printf("  -t     -- print elapsed time, throughput, and peak RSS\n");
 	/* etc. */
 	exit(1);
 }
 
+/* options */
+static int verbose = 0;
+static int quiet = 0;
+
+static unsigned numRevoked = 0;
+
+/* print one entry of revokedCertificates, given its content */
+static DERReturn printRevokedCert(
+	DERItem *content)
+{
+	DERReturn drtn;
+	DERRevokedCert revoked;
+	unsigned certNum = numRevoked++;
+	
+	drtn = DERParseSequenceContent(content, 
+		DERNumRevokedCertItemSpecs, DERRevokedCertItemSpecs,
+		&revoked, sizeof(revoked));
+	if(drtn) {
+		DERPerror("DERParseSequenceContent(RevokedCert)", drtn);
+		return drtn;
+	}
+	if(quiet) {
+		return DR_Success;
+	}
+	doIndent();
+	printf("revoked cert %u\n", certNum);
+	incrIndent();
+	printItem("serialNum", IT_Leaf, verbose, ASN1_INTEGER, &revoked.serialNum);
+	decodePrintItem("revocationDate",  IT_Leaf, verbose, &revoked.revocationDate);
+	printItem("extensions", IT_Branch, verbose, ASN1_CONSTR_SEQUENCE, &revoked.extensions);
+	decrIndent();
+	return DR_Success;
+}
+
 /* 
  * This is a SEQUENCE OF so we use the low-level DERDecodeSeq* routines to snag one entry 
  * at a time.
  */
 static void	printRevokedCerts(
-	DERItem *revokedCerts, 
-	int verbose)
+	DERItem *revokedCerts)
 {
 	DERReturn drtn;
 	DERDecodedInfo currItem;
 	DERSequence seq;
-	unsigned certNum;
-	DERRevokedCert revoked;
 	
 	drtn = DERDecodeSeqContentInit(revokedCerts, &seq);
 	if(drtn) {
@@ -45,7 +82,7 @@ static void	printRevokedCerts(
 		return;
 	}
 	
-	for(certNum=0; ; certNum++) {
+	for(;;) {
 		drtn = DERDecodeSeqNext(&seq, &currItem);
 		switch(drtn) {
 			case DR_EndOfSequence:
@@ -55,25 +92,162 @@ static void	printRevokedCerts(
 				DERPerror("DERDecodeSeqNext", drtn);
 				return;
 			case DR_Success:
-				doIndent();
-				printf("revoked cert %u\n", certNum);
-				incrIndent();
-				drtn = DERParseSequenceContent(&currItem.content, 
-					DERNumRevokedCertItemSpecs, DERRevokedCertItemSpecs,
-					&revoked, sizeof(revoked));
-				if(drtn) {
-					DERPerror("DERParseSequenceContent(RevokedCert)", drtn);
-					decrIndent();
+				if(printRevokedCert(&currItem.content)) {
 					return;
 				}
-				printItem("serialNum", IT_Leaf, verbose, ASN1_INTEGER, &revoked.serialNum);
-				decodePrintItem("revocationDate",  IT_Leaf, verbose, &revoked.revocationDate);
-				printItem("extensions", IT_Branch, verbose, ASN1_CONSTR_SEQUENCE, &revoked.extensions);
-				decrIndent();
 		}
 	}
 }
 
+/*
+ * Streaming decode. We descend into the SignedCrl and its TBSCrl, skip 
+ * everything except revokedCertificates (the third SEQUENCE in TBSCrl), 
+ * and collect each entry of that one at a time.
+ */
+#define STREAM_CHUNK_SIZE	(64 * 1024)
+#define STREAM_SCRATCH_SIZE	(16 * 1024)
+
+typedef struct {
+	DERStream	stream;
+	unsigned	topChild;		/* index of current item in SignedCrl */
+	unsigned	tbsSeqs;		/* number of SEQUENCEs seen in TBSCrl */
+	int			inRevoked;
+} CrlStreamState;
+
+static DERReturn crlStreamEvent(
+	void					*context,
+	const DERStreamEvent	*event,
+	DERStreamAction			*action)
+{
+	CrlStreamState *state = (CrlStreamState *)context;
+	
+	switch(event->type) {
+		case DSE_ItemStart:
+			switch(event->depth) {
+				case 0:
+					/* SignedCrl */
+					if(event->tag != ASN1_CONSTR_SEQUENCE) {
+						return DR_UnexpectedTag;
+					}
+					state->topChild = 0;
+					break;
+				case 1:
+					/* TBSCrl, then sigAlg and sig */
+					if(state->topChild++ != 0) {
+						*action = DSA_Skip;
+					}
+					else if(event->tag != ASN1_CONSTR_SEQUENCE) {
+						return DR_UnexpectedTag;
+					}
+					state->tbsSeqs = 0;
+					break;
+				case 2:
+					if((event->tag == ASN1_CONSTR_SEQUENCE) && (++state->tbsSeqs == 3)) {
+						if(!quiet) {
+							printHeader("revokedCerts");
+							printf("\n");
+						}
+						incrIndent();
+						state->inRevoked = 1;
+					}
+					else {
+						*action = DSA_Skip;
+					}
+					break;
+				default:
+					*action = state->inRevoked ? DSA_Collect : DSA_Skip;
+					break;
+			}
+			break;
+		case DSE_Item:
+			return printRevokedCert((DERItem *)&event->decoded.content);
+		case DSE_ItemEnd:
+			if((event->depth == 2) && state->inRevoked) {
+				decrIndent();
+				state->inRevoked = 0;
+			}
+			break;
+		default:
+			break;
+	}
+	return DR_Success;
+}
+
+static int crlStreamChunk(
+	void				*context,
+	const unsigned char	*bytes,
+	unsigned			numBytes)
+{
+	CrlStreamState *state = (CrlStreamState *)context;
+	DERReturn drtn;
+	
+	drtn = DERStreamFeed(&state->stream, bytes, numBytes);
+	if(drtn) {
+		DERPerror("DERStreamFeed", drtn);
+		return -1;
+	}
+	return 0;
+}
+
+static int streamCrl(
+	const char *fileName)
+{
+	static DERByte scratch[STREAM_SCRATCH_SIZE];
+	CrlStreamState state;
+	DERReturn drtn;
+	
+	memset(&state, 0, sizeof(state));
+	DERStreamInit(&state.stream, crlStreamEvent, &state, scratch, sizeof(scratch));
+	if(readFileChunks(fileName, STREAM_CHUNK_SIZE, crlStreamChunk, &state)) {
+		printf("***Error reading CRL from %s. Aborting.\n", fileName);
+		return 1;
+	}
+	drtn = DERStreamFinish(&state.stream);
+	if(drtn) {
+		DERPerror("DERStreamFinish", drtn);
+		return 1;
+	}
+	return 0;
+}
+
+static double elapsedSeconds(
+	const struct timeval *start)
+{
+	struct timeval now;
+	
+	gettimeofday(&now, NULL);
+	return (now.tv_sec - start->tv_sec) + 
+		(now.tv_usec - start->tv_usec) / 1000000.0;
+}
+
+static void printTiming(
+	const char *fileName,
+	const struct timeval *start)
+{
+	double secs = elapsedSeconds(start);
+	struct rusage ru;
+	FILE *f;
+	long fileSize = 0;
+	long maxRssKB;
+	
+	f = fopen(fileName, "r");
+	if(f != NULL) {
+		fseek(f, 0, SEEK_END);
+		fileSize = ftell(f);
+		fclose(f);
+	}
+	getrusage(RUSAGE_SELF, &ru);
+#ifdef __APPLE__
+	maxRssKB = ru.ru_maxrss / 1024;		/* bytes on Darwin */
+#else
+	maxRssKB = ru.ru_maxrss;
+#endif
+	printf("%u revoked certs, %ld bytes in %.3f s (%.1f MB/s), peak RSS %ld KB\n",
+		numRevoked, fileSize, secs, 
+		secs > 0.0 ? (fileSize / (1024.0 * 1024.0)) / secs : 0.0,
+		maxRssKB);
+}
+
 int main(int argc, char **argv)
 {
 	unsigned char *crlData = NULL;
@@ -82,7 +256,9 @@ int main(int argc, char **argv)
 	DERTBSCrl tbs;
 	DERReturn drtn;
 	DERItem item;
-	int verbose = 0;
+	int streaming = 0;
+	int timing = 0;
+	struct timeval start;
 	extern char *optarg;
 	int arg;
 	extern int optind;
@@ -90,17 +266,22 @@ int main(int argc, char **argv)
 	if(argc < 2) {
 		usage(argv);
 	}
-	if(readFile(argv[1], &crlData, &crlDataLen)) {
-		printf("***Error reading CRL from %s. Aborting.\n", argv[1]);
-		exit(1);
-	}
 
 	optind = 2;
-	while ((arg = getopt(argc, argv, "vh")) != -1) {
+	while ((arg = getopt(argc, argv, "vsqth")) != -1) {
 		switch (arg) {
 			case 'v':
 				verbose = 1;
 				break;
+			case 's':
+				streaming = 1;
+				break;
+			case 'q':
+				quiet = 1;
+				break;
+			case 't':
+				timing = 1;
+				break;
 			case 'h':
 				usage(argv);
 		}
@@ -109,6 +290,22 @@ int main(int argc, char **argv)
 		usage(argv);
 	}
 
+	gettimeofday(&start, NULL);
+	if(streaming) {
+		if(streamCrl(argv[1])) {
+			exit(1);
+		}
+		if(timing) {
+			printTiming(argv[1], &start);
+		}
+		return 0;
+	}
+
+	if(readFile(argv[1], &crlData, &crlDataLen)) {
+		printf("***Error reading CRL from %s. Aborting.\n", argv[1]);
+		exit(1);
+	}
+
 	/* Top level decode of signed CRL into 3 components */
 	item.data = crlData;
 	item.length = crlDataLen;
@@ -118,7 +315,9 @@ int main(int argc, char **argv)
 		DERPerror("DERParseSequence(SignedCrl)", drtn);
 		exit(1);
 	}
-	printItem("TBSCrl", IT_Branch, verbose, ASN1_CONSTR_SEQUENCE, &signedCrl.tbs);
+	if(!quiet) {
+		printItem("TBSCrl", IT_Branch, verbose, ASN1_CONSTR_SEQUENCE, &signedCrl.tbs);
+	}
 	
 	incrIndent();
 	
@@ -130,6 +329,16 @@ int main(int argc, char **argv)
 		DERPerror("DERParseSequenceContent(TBSCrl)", drtn);
 		exit(1);
 	}
+	if(quiet) {
+		/* still walk revokedCerts so -t has a count */
+		if(tbs.revokedCerts.data) {
+			printRevokedCerts(&tbs.revokedCerts);
+		}
+		if(timing) {
+			printTiming(argv[1], &start);
+		}
+		return 0;
+	}
 	if(tbs.version.data) {
 		printItem("version", IT_Leaf, verbose, ASN1_INTEGER, &tbs.version);
 	}
@@ -147,7 +356,7 @@ int main(int argc, char **argv)
 	if(tbs.revokedCerts.data) {
 		printItem("version", IT_Leaf, verbose, ASN1_CONSTR_SEQUENCE, &tbs.revokedCerts);
 		incrIndent();
-		printRevokedCerts(&tbs.revokedCerts, verbose);
+		printRevokedCerts(&tbs.revokedCerts);
 		decrIndent();
 	}
 	
@@ -163,5 +372,8 @@ int main(int argc, char **argv)
 
 	printItem("sig", IT_Leaf, verbose, ASN1_BIT_STRING, &signedCrl.sig);
 	
+	if(timing) {
+		printTiming(argv[1], &start);
+	}
 	return 0;
 }
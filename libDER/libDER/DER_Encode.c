@@ -338,5 +338,172 @@ DERSize DERLengthOfEncodedSequence(
 		contentLen;
 }
 
+/* Single-pass reverse encoding */
+
+DERReturn DERReverseInit(
+	DERReverseEncoder	*enc,
+	DERByte				*buf,
+	DERSize				bufLen)
+{
+	if((enc == NULL) || (buf == NULL)) {
+		return DR_ParamErr;
+	}
+	enc->start = buf;
+	enc->curr = buf + bufLen;
+	enc->end = buf + bufLen;
+	return DR_Success;
+}
+
+DERSize DERReverseLength(
+	const DERReverseEncoder	*enc)
+{
+	return (DERSize)(enc->end - enc->curr);
+}
+
+void DERReverseResult(
+	const DERReverseEncoder	*enc,
+	DERItem				*result)	/* RETURNED */
+{
+	result->data = enc->curr;
+	result->length = DERReverseLength(enc);
+}
+
+DERReturn DERReverseWriteDER(
+	DERReverseEncoder	*enc,
+	const DERByte		*der,
+	DERSize				length)
+{
+	if((DERSize)(enc->curr - enc->start) < length) {
+		return DR_BufOverflow;
+	}
+	enc->curr -= length;
+	DERMemmove(enc->curr, der, length);
+	return DR_Success;
+}
+
+/* prepend tag and length of an item whose content has been written */
+static DERReturn DERReverseEncodeHeader(
+	DERReverseEncoder	*enc,
+	DERTag				tag,
+	DERSize				length)
+{
+	DERSize tagLen = DERLengthOfTag(tag);
+	DERSize lenLen = DERLengthOfLength(length);
+	DERSize room = (DERSize)(enc->curr - enc->start);
+	DERReturn drtn;
+	
+	if(room < tagLen + lenLen) {
+		return DR_BufOverflow;
+	}
+	enc->curr -= tagLen + lenLen;
+	drtn = DEREncodeTag(tag, enc->curr, &tagLen);
+	if(drtn) {
+		return drtn;
+	}
+	return DEREncodeLength(length, enc->curr + tagLen, &lenLen);
+}
+
+DERReturn DERReverseEncodeItem(
+	DERReverseEncoder	*enc,
+	DERTag				tag,
+	const DERByte		*src,
+	DERSize				length,
+	DERShort			options)
+{
+	DERReturn drtn;
+	DERSize contentLen = length;
+	
+	if(options & DER_ENC_WRITE_DER) {
+		/* easy case - no encode */
+		return DERReverseWriteDER(enc, src, length);
+	}
+	drtn = DERReverseWriteDER(enc, src, length);
+	if(drtn) {
+		return drtn;
+	}
+	if((options & DER_ENC_SIGNED_INT) && (length != 0) && (src[0] & 0x80)) {
+		/* insert zero keep it positive */
+		if(enc->curr == enc->start) {
+			return DR_BufOverflow;
+		}
+		*--enc->curr = 0;
+		contentLen++;
+	}
+	return DERReverseEncodeHeader(enc, tag, contentLen);
+}
+
+DERReturn DERReverseEncodeConstructed(
+	DERReverseEncoder	*enc,
+	DERTag				tag,
+	DERSize				mark)
+{
+	DERSize encoded = DERReverseLength(enc);
+	
+	if(mark > encoded) {
+		return DR_ParamErr;
+	}
+	return DERReverseEncodeHeader(enc, tag, encoded - mark);
+}
+
+DERReturn DERReverseEncodeSequence(
+	DERReverseEncoder	*enc,
+	DERTag				topTag,		/* ASN1_CONSTR_SEQUENCE, ASN1_CONSTR_SET */
+	const void			*src,		/* generally a ptr to a struct full of 
+									 *    DERItems */
+	DERShort			numItems,	/* size of itemSpecs[] */
+	const DERItemSpec	*itemSpecs)
+{
+	DERSize mark = DERReverseLength(enc);
+	DERReturn drtn;
+	unsigned dex;
+	
+	/* grind thru the items, last to first */
+	for(dex=numItems; dex>0; dex--) {
+		const DERItemSpec *currItemSpec = &itemSpecs[dex - 1];
+		DERShort currOptions = currItemSpec->options;
+		const DERByte *byteSrc = (const DERByte *)src + currItemSpec->offset;
+		const DERItem *itemSrc = (const DERItem *)byteSrc;
+
+		if(!(currOptions & DER_ENC_WRITE_DER) &&
+		   (currOptions & DER_DEC_OPTIONAL) && (itemSrc->length == 0)) {
+			/* If an optional item isn't present we skip it. */
+			continue;
+		}
+		drtn = DERReverseEncodeItem(enc, currItemSpec->tag,
+			itemSrc->data, itemSrc->length, currOptions);
+		if(drtn) {
+			return drtn;
+		}
+	}
+	return DERReverseEncodeConstructed(enc, topTag, mark);
+}
+
+DERReturn DEREncodeSequenceReverse(
+	DERTag				topTag,		/* ASN1_CONSTR_SEQUENCE, ASN1_CONSTR_SET */
+	const void			*src,		/* generally a ptr to a struct full of 
+									 *    DERItems */
+	DERShort			numItems,	/* size of itemSpecs[] */
+	const DERItemSpec	*itemSpecs,
+	DERByte				*derOut,	/* encoded data written here */
+	DERSize				*inOutLen)	/* IN/OUT */
+{
+	DERReverseEncoder enc;
+	DERReturn drtn;
+	DERItem result;
+	
+	drtn = DERReverseInit(&enc, derOut, *inOutLen);
+	if(drtn) {
+		return drtn;
+	}
+	drtn = DERReverseEncodeSequence(&enc, topTag, src, numItems, itemSpecs);
+	if(drtn) {
+		return drtn;
+	}
+	DERReverseResult(&enc, &result);
+	DERMemmove(derOut, result.data, result.length);
+	*inOutLen = result.length;
+	return DR_Success;
+}
+
 #endif	/* DER_ENCODE_ENABLE */
 
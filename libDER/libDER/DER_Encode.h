@@ -93,7 +93,104 @@ DERSize DERLengthOfEncodedSequence(
 									 *    DERItems */
 	DERShort			numItems,	/* size of itemSpecs[] */
 	const DERItemSpec	*itemSpecs);
-	
+
+/*
+ * Single-pass reverse encoding.
+ *
+ * DEREncodeSequence() has to know a sequence's content length before it
+ * can write the sequence's length, so it walks the itemSpecs twice, and 
+ * nested sequences (encoded separately and written with DER_ENC_WRITE_DER)
+ * get sized once per level of nesting. The DERReverseEncoder instead 
+ * writes from the end of the caller's buffer toward the beginning: content
+ * is written first, so by the time a tag and length are written the 
+ * content length is simply the number of bytes written since the content 
+ * started. Nesting of any depth costs a single pass.
+ *
+ * Usage: write the items of a constructed type last to first, then wrap 
+ * them with DERReverseEncodeConstructed(), passing the value of 
+ * DERReverseLength() from before the items were written:
+ *
+ *		DERReverseInit(&enc, buf, bufLen);
+ *		mark = DERReverseLength(&enc);
+ *		DERReverseEncodeSequence(&enc, ASN1_CONSTR_SEQUENCE, &inner, ...);
+ *		DERReverseEncodeItem(&enc, ASN1_INTEGER, version, versionLen, 0);
+ *		DERReverseEncodeConstructed(&enc, ASN1_CONSTR_SEQUENCE, mark);
+ *		DERReverseResult(&enc, &encoded);
+ *
+ * The encoding ends up at the end of the caller's buffer; 
+ * DERReverseResult() says where. Any error leaves the encoder unusable
+ * for further writes.
+ */
+typedef struct {
+	DERByte		*start;		/* caller's buffer */
+	DERByte		*curr;		/* encoded data runs from here... */
+	DERByte		*end;		/* ...to here */
+} DERReverseEncoder;
+
+DERReturn DERReverseInit(
+	DERReverseEncoder	*enc,
+	DERByte				*buf,
+	DERSize				bufLen);
+
+/* number of bytes encoded so far */
+DERSize DERReverseLength(
+	const DERReverseEncoder	*enc);
+
+/* the complete encoding, which is at the end of the caller's buffer */
+void DERReverseResult(
+	const DERReverseEncoder	*enc,
+	DERItem				*result);	/* RETURNED */
+
+/* prepend raw, already-encoded bytes */
+DERReturn DERReverseWriteDER(
+	DERReverseEncoder	*enc,
+	const DERByte		*der,
+	DERSize				length);
+
+/* 
+ * Prepend one item. Options are DER_ENC_SIGNED_INT or DER_ENC_WRITE_DER 
+ * as for DEREncodeSequence().
+ */
+DERReturn DERReverseEncodeItem(
+	DERReverseEncoder	*enc,
+	DERTag				tag,
+	const DERByte		*src,
+	DERSize				length,
+	DERShort			options);
+
+/* 
+ * Prepend the tag and length of a constructed item whose content is
+ * everything written since DERReverseLength() returned mark.
+ */
+DERReturn DERReverseEncodeConstructed(
+	DERReverseEncoder	*enc,
+	DERTag				tag,
+	DERSize				mark);
+
+/* 
+ * Prepend a complete sequence described by itemSpecs, exactly as 
+ * DEREncodeSequence() would encode it. 
+ */
+DERReturn DERReverseEncodeSequence(
+	DERReverseEncoder	*enc,
+	DERTag				topTag,		/* ASN1_CONSTR_SEQUENCE, ASN1_CONSTR_SET */
+	const void			*src,		/* generally a ptr to a struct full of 
+									 *    DERItems */
+	DERShort			numItems,	/* size of itemSpecs[] */
+	const DERItemSpec	*itemSpecs);
+
+/*
+ * Drop-in replacement for DEREncodeSequence() which encodes in a single
+ * pass and then moves the result to the start of derOut.
+ */
+DERReturn DEREncodeSequenceReverse(
+	DERTag				topTag,		/* ASN1_CONSTR_SEQUENCE, ASN1_CONSTR_SET */
+	const void			*src,		/* generally a ptr to a struct full of 
+									 *    DERItems */
+	DERShort			numItems,	/* size of itemSpecs[] */
+	const DERItemSpec	*itemSpecs,
+	DERByte				*derOut,	/* encoded data written here */
+	DERSize				*inOutLen);	/* IN/OUT */
 	
 #ifdef __cplusplus
 }
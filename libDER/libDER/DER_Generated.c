@@ -0,0 +1,1980 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * GENERATED FILE - DO NOT EDIT. Generated by genDecoders.pl from
+ * DER_CertCrl.c, DER_Keys.c.
+ */
+
+#include <libDER/DER_Generated.h>
+#include <libDER/DER_Decode.h>
+#include <libDER/asn1Types.h>
+#include <libDER/DER_CertCrl.h>
+#include <libDER/DER_Keys.h>
+
+/* DERSignedCertCrlItemSpecs from DER_CertCrl.c */
+DERReturn DERParseSignedCertCrlContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	DERByte			*currDER;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERSignedCertCrl, tbs), ASN1_CONSTR_SEQUENCE, DER_DEC_NO_OPTS | DER_DEC_SAVE_DER */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_CONSTR_SEQUENCE)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERSignedCertCrl, tbs));
+	*dst = currDecoded.content;
+	dst->data = currDER;
+	dst->length += (currDecoded.content.data - currDER);
+
+	/* DER_OFFSET(DERSignedCertCrl, sigAlg), ASN1_CONSTR_SEQUENCE, DER_DEC_NO_OPTS */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_CONSTR_SEQUENCE)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERSignedCertCrl, sigAlg));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERSignedCertCrl, sig), ASN1_BIT_STRING, DER_DEC_NO_OPTS */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_BIT_STRING)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERSignedCertCrl, sig));
+	*dst = currDecoded.content;
+	return DR_Success;
+}
+
+DERReturn DERParseSignedCertCrl(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseSignedCertCrlContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERTBSCertItemSpecs from DER_CertCrl.c */
+DERReturn DERParseTBSCertContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	int				pending = 0;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERTBSCert, version), ASN1_CONSTRUCTED | ASN1_CONTEXT_SPECIFIC | 0, DER_DEC_OPTIONAL */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag == (ASN1_CONSTRUCTED | ASN1_CONTEXT_SPECIFIC | 0)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCert, version));
+		*dst = currDecoded.content;
+	}
+	else {
+		pending = 1;
+	}
+
+	/* DER_OFFSET(DERTBSCert, serialNum), ASN1_INTEGER, DER_DEC_NO_OPTS */
+	if(!pending) {
+		drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+		if(drtn) {
+			return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+		}
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCert, serialNum));
+	*dst = currDecoded.content;
+	pending = 0;
+
+	/* DER_OFFSET(DERTBSCert, tbsSigAlg), ASN1_CONSTR_SEQUENCE, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_CONSTR_SEQUENCE)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCert, tbsSigAlg));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERTBSCert, issuer), ASN1_CONSTR_SEQUENCE, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_CONSTR_SEQUENCE)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCert, issuer));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERTBSCert, validity), ASN1_CONSTR_SEQUENCE, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_CONSTR_SEQUENCE)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCert, validity));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERTBSCert, subject), ASN1_CONSTR_SEQUENCE, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_CONSTR_SEQUENCE)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCert, subject));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERTBSCert, subjectPubKey), ASN1_CONSTR_SEQUENCE, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_CONSTR_SEQUENCE)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCert, subjectPubKey));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERTBSCert, issuerID), ASN1_CONTEXT_SPECIFIC | 1, DER_DEC_OPTIONAL */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+	}
+	if(currDecoded.tag == (ASN1_CONTEXT_SPECIFIC | 1)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCert, issuerID));
+		*dst = currDecoded.content;
+	}
+	else {
+		pending = 1;
+	}
+
+	/* DER_OFFSET(DERTBSCert, subjectID), ASN1_CONTEXT_SPECIFIC | 2, DER_DEC_OPTIONAL */
+	if(!pending) {
+		drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+		if(drtn) {
+			return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+		}
+	}
+	if(currDecoded.tag == (ASN1_CONTEXT_SPECIFIC | 2)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCert, subjectID));
+		*dst = currDecoded.content;
+		pending = 0;
+	}
+	else {
+		pending = 1;
+	}
+
+	/* DER_OFFSET(DERTBSCert, extensions), ASN1_CONSTRUCTED | ASN1_CONTEXT_SPECIFIC | 3, DER_DEC_OPTIONAL */
+	if(!pending) {
+		drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+		if(drtn) {
+			return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+		}
+	}
+	if(currDecoded.tag == (ASN1_CONSTRUCTED | ASN1_CONTEXT_SPECIFIC | 3)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCert, extensions));
+		*dst = currDecoded.content;
+		pending = 0;
+		return DR_Success;
+	}
+	return DR_UnexpectedTag;
+}
+
+DERReturn DERParseTBSCert(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseTBSCertContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERValidityItemSpecs from DER_CertCrl.c */
+DERReturn DERParseValidityContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	DERByte			*currDER;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERValidity, notBefore), 0, DER_DEC_ASN_ANY | DER_DEC_SAVE_DER */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERValidity, notBefore));
+	*dst = currDecoded.content;
+	dst->data = currDER;
+	dst->length += (currDecoded.content.data - currDER);
+
+	/* DER_OFFSET(DERValidity, notAfter), 0, DER_DEC_ASN_ANY | DER_DEC_SAVE_DER */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERValidity, notAfter));
+	*dst = currDecoded.content;
+	dst->data = currDER;
+	dst->length += (currDecoded.content.data - currDER);
+	return DR_Success;
+}
+
+DERReturn DERParseValidity(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseValidityContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERAttributeTypeAndValueItemSpecs from DER_CertCrl.c */
+DERReturn DERParseAttributeTypeAndValueContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	DERByte			*currDER;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERAttributeTypeAndValue, type), ASN1_OBJECT_ID, DER_DEC_NO_OPTS */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_OBJECT_ID)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERAttributeTypeAndValue, type));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERAttributeTypeAndValue, value), 0, DER_DEC_ASN_ANY | DER_DEC_SAVE_DER */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERAttributeTypeAndValue, value));
+	*dst = currDecoded.content;
+	dst->data = currDER;
+	dst->length += (currDecoded.content.data - currDER);
+	return DR_Success;
+}
+
+DERReturn DERParseAttributeTypeAndValue(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseAttributeTypeAndValueContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERExtensionItemSpecs from DER_CertCrl.c */
+DERReturn DERParseExtensionContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	int				pending = 0;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERExtension, extnID), ASN1_OBJECT_ID, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_OBJECT_ID)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERExtension, extnID));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERExtension, critical), ASN1_BOOLEAN, DER_DEC_OPTIONAL */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag == (ASN1_BOOLEAN)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERExtension, critical));
+		*dst = currDecoded.content;
+	}
+	else {
+		pending = 1;
+	}
+
+	/* DER_OFFSET(DERExtension, extnValue), ASN1_OCTET_STRING, DER_DEC_NO_OPTS */
+	if(!pending) {
+		drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+		if(drtn) {
+			return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+		}
+	}
+	if(currDecoded.tag != (ASN1_OCTET_STRING)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERExtension, extnValue));
+	*dst = currDecoded.content;
+	pending = 0;
+	return DR_Success;
+}
+
+DERReturn DERParseExtension(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseExtensionContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERBasicConstraintsItemSpecs from DER_CertCrl.c */
+DERReturn DERParseBasicConstraintsContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	int				pending = 0;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERBasicConstraints, cA), ASN1_BOOLEAN, DER_DEC_OPTIONAL */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+	}
+	if(currDecoded.tag == (ASN1_BOOLEAN)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERBasicConstraints, cA));
+		*dst = currDecoded.content;
+	}
+	else {
+		pending = 1;
+	}
+
+	/* DER_OFFSET(DERBasicConstraints, pathLenConstraint), ASN1_INTEGER, DER_DEC_OPTIONAL */
+	if(!pending) {
+		drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+		if(drtn) {
+			return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+		}
+	}
+	if(currDecoded.tag == (ASN1_INTEGER)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERBasicConstraints, pathLenConstraint));
+		*dst = currDecoded.content;
+		pending = 0;
+		return DR_Success;
+	}
+	return DR_UnexpectedTag;
+}
+
+DERReturn DERParseBasicConstraints(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseBasicConstraintsContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERPrivateKeyUsagePeriodItemSpecs from DER_CertCrl.c */
+DERReturn DERParsePrivateKeyUsagePeriodContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	int				pending = 0;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERPrivateKeyUsagePeriod, notBefore), ASN1_CONTEXT_SPECIFIC | 0, DER_DEC_OPTIONAL */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+	}
+	if(currDecoded.tag == (ASN1_CONTEXT_SPECIFIC | 0)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERPrivateKeyUsagePeriod, notBefore));
+		*dst = currDecoded.content;
+	}
+	else {
+		pending = 1;
+	}
+
+	/* DER_OFFSET(DERPrivateKeyUsagePeriod, notAfter), ASN1_CONTEXT_SPECIFIC | 1, DER_DEC_OPTIONAL */
+	if(!pending) {
+		drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+		if(drtn) {
+			return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+		}
+	}
+	if(currDecoded.tag == (ASN1_CONTEXT_SPECIFIC | 1)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERPrivateKeyUsagePeriod, notAfter));
+		*dst = currDecoded.content;
+		pending = 0;
+		return DR_Success;
+	}
+	return DR_UnexpectedTag;
+}
+
+DERReturn DERParsePrivateKeyUsagePeriod(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParsePrivateKeyUsagePeriodContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERDistributionPointItemSpecs from DER_CertCrl.c */
+DERReturn DERParseDistributionPointContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	int				pending = 0;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERDistributionPoint, distributionPoint), ASN1_CONTEXT_SPECIFIC | ASN1_CONSTRUCTED | 0, DER_DEC_OPTIONAL */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+	}
+	if(currDecoded.tag == (ASN1_CONTEXT_SPECIFIC | ASN1_CONSTRUCTED | 0)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERDistributionPoint, distributionPoint));
+		*dst = currDecoded.content;
+	}
+	else {
+		pending = 1;
+	}
+
+	/* DER_OFFSET(DERDistributionPoint, reasons), ASN1_CONTEXT_SPECIFIC | 1, DER_DEC_OPTIONAL */
+	if(!pending) {
+		drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+		if(drtn) {
+			return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+		}
+	}
+	if(currDecoded.tag == (ASN1_CONTEXT_SPECIFIC | 1)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERDistributionPoint, reasons));
+		*dst = currDecoded.content;
+		pending = 0;
+	}
+	else {
+		pending = 1;
+	}
+
+	/* DER_OFFSET(DERDistributionPoint, cRLIssuer), ASN1_CONTEXT_SPECIFIC | ASN1_CONSTRUCTED | 2, DER_DEC_OPTIONAL */
+	if(!pending) {
+		drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+		if(drtn) {
+			return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+		}
+	}
+	if(currDecoded.tag == (ASN1_CONTEXT_SPECIFIC | ASN1_CONSTRUCTED | 2)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERDistributionPoint, cRLIssuer));
+		*dst = currDecoded.content;
+		pending = 0;
+		return DR_Success;
+	}
+	return DR_UnexpectedTag;
+}
+
+DERReturn DERParseDistributionPoint(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseDistributionPointContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERPolicyInformationItemSpecs from DER_CertCrl.c */
+DERReturn DERParsePolicyInformationContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERPolicyInformation, policyIdentifier), ASN1_OBJECT_ID, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_OBJECT_ID)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERPolicyInformation, policyIdentifier));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERPolicyInformation, policyQualifiers), ASN1_CONSTR_SEQUENCE, DER_DEC_OPTIONAL */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+	}
+	if(currDecoded.tag == (ASN1_CONSTR_SEQUENCE)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERPolicyInformation, policyQualifiers));
+		*dst = currDecoded.content;
+		return DR_Success;
+	}
+	return DR_UnexpectedTag;
+}
+
+DERReturn DERParsePolicyInformation(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParsePolicyInformationContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERPolicyQualifierInfoItemSpecs from DER_CertCrl.c */
+DERReturn DERParsePolicyQualifierInfoContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	DERByte			*currDER;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERPolicyQualifierInfo, policyQualifierID), ASN1_OBJECT_ID, DER_DEC_NO_OPTS */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_OBJECT_ID)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERPolicyQualifierInfo, policyQualifierID));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERPolicyQualifierInfo, qualifier), 0, DER_DEC_ASN_ANY | DER_DEC_SAVE_DER */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERPolicyQualifierInfo, qualifier));
+	*dst = currDecoded.content;
+	dst->data = currDER;
+	dst->length += (currDecoded.content.data - currDER);
+	return DR_Success;
+}
+
+DERReturn DERParsePolicyQualifierInfo(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParsePolicyQualifierInfoContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERUserNoticeItemSpecs from DER_CertCrl.c */
+DERReturn DERParseUserNoticeContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	DERByte			*currDER;
+	int				pending = 0;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERUserNotice, noticeRef), ASN1_CONSTR_SEQUENCE, DER_DEC_OPTIONAL */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+	}
+	if(currDecoded.tag == (ASN1_CONSTR_SEQUENCE)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERUserNotice, noticeRef));
+		*dst = currDecoded.content;
+	}
+	else {
+		pending = 1;
+	}
+
+	/* DER_OFFSET(DERUserNotice, explicitText), 0, DER_DEC_ASN_ANY | DER_DEC_OPTIONAL | DER_DEC_SAVE_DER */
+	if(!pending) {
+		currDER = derSeq.nextItem;
+		drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+		if(drtn) {
+			return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+		}
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERUserNotice, explicitText));
+	*dst = currDecoded.content;
+	dst->data = currDER;
+	dst->length += (currDecoded.content.data - currDER);
+	pending = 0;
+	return DR_Success;
+}
+
+DERReturn DERParseUserNotice(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseUserNoticeContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERNoticeReferenceItemSpecs from DER_CertCrl.c */
+DERReturn DERParseNoticeReferenceContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	DERByte			*currDER;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERNoticeReference, organization), 0, DER_DEC_ASN_ANY | DER_DEC_SAVE_DER */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERNoticeReference, organization));
+	*dst = currDecoded.content;
+	dst->data = currDER;
+	dst->length += (currDecoded.content.data - currDER);
+
+	/* DER_OFFSET(DERNoticeReference, noticeNumbers), ASN1_CONSTR_SEQUENCE, DER_DEC_NO_OPTS */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_CONSTR_SEQUENCE)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERNoticeReference, noticeNumbers));
+	*dst = currDecoded.content;
+	return DR_Success;
+}
+
+DERReturn DERParseNoticeReference(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseNoticeReferenceContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERPolicyMappingItemSpecs from DER_CertCrl.c */
+DERReturn DERParsePolicyMappingContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERPolicyMapping, issuerDomainPolicy), ASN1_OBJECT_ID, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_OBJECT_ID)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERPolicyMapping, issuerDomainPolicy));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERPolicyMapping, subjectDomainPolicy), ASN1_OBJECT_ID, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_OBJECT_ID)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERPolicyMapping, subjectDomainPolicy));
+	*dst = currDecoded.content;
+	return DR_Success;
+}
+
+DERReturn DERParsePolicyMapping(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParsePolicyMappingContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERAccessDescriptionItemSpecs from DER_CertCrl.c */
+DERReturn DERParseAccessDescriptionContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	DERByte			*currDER;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERAccessDescription, accessMethod), ASN1_OBJECT_ID, DER_DEC_NO_OPTS */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_OBJECT_ID)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERAccessDescription, accessMethod));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERAccessDescription, accessLocation), 0, DER_DEC_ASN_ANY | DER_DEC_SAVE_DER */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERAccessDescription, accessLocation));
+	*dst = currDecoded.content;
+	dst->data = currDER;
+	dst->length += (currDecoded.content.data - currDER);
+	return DR_Success;
+}
+
+DERReturn DERParseAccessDescription(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseAccessDescriptionContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERAuthorityKeyIdentifierItemSpecs from DER_CertCrl.c */
+DERReturn DERParseAuthorityKeyIdentifierContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	int				pending = 0;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERAuthorityKeyIdentifier, keyIdentifier), ASN1_CONTEXT_SPECIFIC | 0, DER_DEC_OPTIONAL */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+	}
+	if(currDecoded.tag == (ASN1_CONTEXT_SPECIFIC | 0)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERAuthorityKeyIdentifier, keyIdentifier));
+		*dst = currDecoded.content;
+	}
+	else {
+		pending = 1;
+	}
+
+	/* DER_OFFSET(DERAuthorityKeyIdentifier, authorityCertIssuer), ASN1_CONTEXT_SPECIFIC | ASN1_CONSTRUCTED | 1, DER_DEC_OPTIONAL */
+	if(!pending) {
+		drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+		if(drtn) {
+			return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+		}
+	}
+	if(currDecoded.tag == (ASN1_CONTEXT_SPECIFIC | ASN1_CONSTRUCTED | 1)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERAuthorityKeyIdentifier, authorityCertIssuer));
+		*dst = currDecoded.content;
+		pending = 0;
+	}
+	else {
+		pending = 1;
+	}
+
+	/* DER_OFFSET(DERAuthorityKeyIdentifier, authorityCertSerialNumber), ASN1_CONTEXT_SPECIFIC | 2, DER_DEC_OPTIONAL */
+	if(!pending) {
+		drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+		if(drtn) {
+			return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+		}
+	}
+	if(currDecoded.tag == (ASN1_CONTEXT_SPECIFIC | 2)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERAuthorityKeyIdentifier, authorityCertSerialNumber));
+		*dst = currDecoded.content;
+		pending = 0;
+		return DR_Success;
+	}
+	return DR_UnexpectedTag;
+}
+
+DERReturn DERParseAuthorityKeyIdentifier(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseAuthorityKeyIdentifierContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DEROtherNameItemSpecs from DER_CertCrl.c */
+DERReturn DERParseOtherNameContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DEROtherName, typeIdentifier), ASN1_OBJECT_ID, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_OBJECT_ID)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DEROtherName, typeIdentifier));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DEROtherName, value), ASN1_CONTEXT_SPECIFIC | ASN1_CONSTRUCTED | 0, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_CONTEXT_SPECIFIC | ASN1_CONSTRUCTED | 0)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DEROtherName, value));
+	*dst = currDecoded.content;
+	return DR_Success;
+}
+
+DERReturn DERParseOtherName(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseOtherNameContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERPolicyConstraintsItemSpecs from DER_CertCrl.c */
+DERReturn DERParsePolicyConstraintsContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	int				pending = 0;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERPolicyConstraints, requireExplicitPolicy), ASN1_CONTEXT_SPECIFIC | 0, DER_DEC_OPTIONAL */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+	}
+	if(currDecoded.tag == (ASN1_CONTEXT_SPECIFIC | 0)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERPolicyConstraints, requireExplicitPolicy));
+		*dst = currDecoded.content;
+	}
+	else {
+		pending = 1;
+	}
+
+	/* DER_OFFSET(DERPolicyConstraints, inhibitPolicyMapping), ASN1_CONTEXT_SPECIFIC | 1, DER_DEC_OPTIONAL */
+	if(!pending) {
+		drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+		if(drtn) {
+			return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+		}
+	}
+	if(currDecoded.tag == (ASN1_CONTEXT_SPECIFIC | 1)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERPolicyConstraints, inhibitPolicyMapping));
+		*dst = currDecoded.content;
+		pending = 0;
+		return DR_Success;
+	}
+	return DR_UnexpectedTag;
+}
+
+DERReturn DERParsePolicyConstraints(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParsePolicyConstraintsContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERTBSCrlItemSpecs from DER_CertCrl.c */
+DERReturn DERParseTBSCrlContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	DERByte			*currDER;
+	int				pending = 0;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERTBSCrl, version), ASN1_INTEGER, DER_DEC_OPTIONAL */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag == (ASN1_INTEGER)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCrl, version));
+		*dst = currDecoded.content;
+	}
+	else {
+		pending = 1;
+	}
+
+	/* DER_OFFSET(DERTBSCrl, tbsSigAlg), ASN1_CONSTR_SEQUENCE, DER_DEC_NO_OPTS */
+	if(!pending) {
+		currDER = derSeq.nextItem;
+		drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+		if(drtn) {
+			return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+		}
+	}
+	if(currDecoded.tag != (ASN1_CONSTR_SEQUENCE)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCrl, tbsSigAlg));
+	*dst = currDecoded.content;
+	pending = 0;
+
+	/* DER_OFFSET(DERTBSCrl, issuer), ASN1_CONSTR_SEQUENCE, DER_DEC_NO_OPTS */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_CONSTR_SEQUENCE)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCrl, issuer));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERTBSCrl, thisUpdate), 0, DER_DEC_ASN_ANY | DER_DEC_SAVE_DER */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCrl, thisUpdate));
+	*dst = currDecoded.content;
+	dst->data = currDER;
+	dst->length += (currDecoded.content.data - currDER);
+
+	/* DER_OFFSET(DERTBSCrl, nextUpdate), 0, DER_DEC_ASN_ANY | DER_DEC_SAVE_DER */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCrl, nextUpdate));
+	*dst = currDecoded.content;
+	dst->data = currDER;
+	dst->length += (currDecoded.content.data - currDER);
+
+	/* DER_OFFSET(DERTBSCrl, revokedCerts), ASN1_CONSTR_SEQUENCE, DER_DEC_OPTIONAL */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+	}
+	if(currDecoded.tag == (ASN1_CONSTR_SEQUENCE)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCrl, revokedCerts));
+		*dst = currDecoded.content;
+	}
+	else {
+		pending = 1;
+	}
+
+	/* DER_OFFSET(DERTBSCrl, extensions), ASN1_CONSTRUCTED | ASN1_CONTEXT_SPECIFIC | 0, DER_DEC_OPTIONAL */
+	if(!pending) {
+		currDER = derSeq.nextItem;
+		drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+		if(drtn) {
+			return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+		}
+	}
+	if(currDecoded.tag == (ASN1_CONSTRUCTED | ASN1_CONTEXT_SPECIFIC | 0)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERTBSCrl, extensions));
+		*dst = currDecoded.content;
+		pending = 0;
+		return DR_Success;
+	}
+	return DR_UnexpectedTag;
+}
+
+DERReturn DERParseTBSCrl(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseTBSCrlContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERRevokedCertItemSpecs from DER_CertCrl.c */
+DERReturn DERParseRevokedCertContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	DERByte			*currDER;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERRevokedCert, serialNum), ASN1_INTEGER, DER_DEC_NO_OPTS */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRevokedCert, serialNum));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRevokedCert, revocationDate), 0, DER_DEC_ASN_ANY | DER_DEC_SAVE_DER */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRevokedCert, revocationDate));
+	*dst = currDecoded.content;
+	dst->data = currDER;
+	dst->length += (currDecoded.content.data - currDER);
+
+	/* DER_OFFSET(DERRevokedCert, extensions), ASN1_CONSTR_SEQUENCE, DER_DEC_OPTIONAL */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+	}
+	if(currDecoded.tag == (ASN1_CONSTR_SEQUENCE)) {
+		dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRevokedCert, extensions));
+		*dst = currDecoded.content;
+		return DR_Success;
+	}
+	return DR_UnexpectedTag;
+}
+
+DERReturn DERParseRevokedCert(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseRevokedCertContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERAlgorithmIdItemSpecs from DER_Keys.c */
+DERReturn DERParseAlgorithmIdContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+	DERByte			*currDER;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERAlgorithmId, oid), ASN1_OBJECT_ID, DER_DEC_NO_OPTS */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_OBJECT_ID)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERAlgorithmId, oid));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERAlgorithmId, params), 0, DER_DEC_ASN_ANY | DER_DEC_OPTIONAL | DER_DEC_SAVE_DER */
+	currDER = derSeq.nextItem;
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERAlgorithmId, params));
+	*dst = currDecoded.content;
+	dst->data = currDER;
+	dst->length += (currDecoded.content.data - currDER);
+	return DR_Success;
+}
+
+DERReturn DERParseAlgorithmId(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseAlgorithmIdContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERSubjPubKeyInfoItemSpecs from DER_Keys.c */
+DERReturn DERParseSubjPubKeyInfoContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERSubjPubKeyInfo, algId), ASN1_CONSTR_SEQUENCE, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_CONSTR_SEQUENCE)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERSubjPubKeyInfo, algId));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERSubjPubKeyInfo, pubKey), ASN1_BIT_STRING, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_BIT_STRING)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERSubjPubKeyInfo, pubKey));
+	*dst = currDecoded.content;
+	return DR_Success;
+}
+
+DERReturn DERParseSubjPubKeyInfo(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseSubjPubKeyInfoContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERRSAPrivKeyCRTItemSpecs from DER_Keys.c */
+DERReturn DERParseRSAPrivKeyCRTContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* 0, ASN1_INTEGER, DER_DEC_SKIP */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	
+	/* 0, ASN1_INTEGER, DER_DEC_SKIP */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	
+	/* 0, ASN1_INTEGER, DER_DEC_SKIP */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	
+	/* 0, ASN1_INTEGER, DER_DEC_SKIP */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	
+	/* DER_OFFSET(DERRSAPrivKeyCRT, p), ASN1_INTEGER, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAPrivKeyCRT, p));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRSAPrivKeyCRT, q), ASN1_INTEGER, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAPrivKeyCRT, q));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRSAPrivKeyCRT, dp), ASN1_INTEGER, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAPrivKeyCRT, dp));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRSAPrivKeyCRT, dq), ASN1_INTEGER, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAPrivKeyCRT, dq));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRSAPrivKeyCRT, qInv), ASN1_INTEGER, DER_DEC_NO_OPTS */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAPrivKeyCRT, qInv));
+	*dst = currDecoded.content;
+	return DR_Success;
+}
+
+DERReturn DERParseRSAPrivKeyCRT(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseRSAPrivKeyCRTContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERRSAPubKeyPKCS1ItemSpecs from DER_Keys.c */
+DERReturn DERParseRSAPubKeyPKCS1Content(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERRSAPubKeyPKCS1, modulus), ASN1_INTEGER, DER_DEC_NO_OPTS | DER_ENC_SIGNED_INT */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAPubKeyPKCS1, modulus));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRSAPubKeyPKCS1, pubExponent), ASN1_INTEGER, DER_DEC_NO_OPTS | DER_ENC_SIGNED_INT */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAPubKeyPKCS1, pubExponent));
+	*dst = currDecoded.content;
+	return DR_Success;
+}
+
+DERReturn DERParseRSAPubKeyPKCS1(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseRSAPubKeyPKCS1Content(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERRSAPubKeyAppleItemSpecs from DER_Keys.c */
+DERReturn DERParseRSAPubKeyAppleContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERRSAPubKeyApple, modulus), ASN1_INTEGER, DER_DEC_NO_OPTS | DER_ENC_SIGNED_INT */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAPubKeyApple, modulus));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRSAPubKeyApple, reciprocal), ASN1_INTEGER, DER_DEC_NO_OPTS | DER_ENC_SIGNED_INT */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAPubKeyApple, reciprocal));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRSAPubKeyApple, pubExponent), ASN1_INTEGER, DER_DEC_NO_OPTS | DER_ENC_SIGNED_INT */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAPubKeyApple, pubExponent));
+	*dst = currDecoded.content;
+	return DR_Success;
+}
+
+DERReturn DERParseRSAPubKeyApple(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseRSAPubKeyAppleContent(&topDecode.content, dest, sizeToZero);
+}
+
+/* DERRSAKeyPairItemSpecs from DER_Keys.c */
+DERReturn DERParseRSAKeyPairContent(
+	const DERItem			*content,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERSequence		derSeq;
+	DERDecodedInfo	currDecoded;
+	DERReturn		drtn;
+	DERItem			*dst;
+
+	if(sizeToZero) {
+		DERMemset(dest, 0, sizeToZero);
+	}
+	derSeq.nextItem = content->data;
+	derSeq.end = content->data + content->length;
+
+	/* DER_OFFSET(DERRSAKeyPair, version), ASN1_INTEGER, DER_ENC_SIGNED_INT */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAKeyPair, version));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRSAKeyPair, n), ASN1_INTEGER, DER_ENC_SIGNED_INT */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAKeyPair, n));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRSAKeyPair, e), ASN1_INTEGER, DER_ENC_SIGNED_INT */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAKeyPair, e));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRSAKeyPair, d), ASN1_INTEGER, DER_ENC_SIGNED_INT */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAKeyPair, d));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRSAKeyPair, p), ASN1_INTEGER, DER_ENC_SIGNED_INT */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAKeyPair, p));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRSAKeyPair, q), ASN1_INTEGER, DER_ENC_SIGNED_INT */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAKeyPair, q));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRSAKeyPair, dp), ASN1_INTEGER, DER_ENC_SIGNED_INT */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAKeyPair, dp));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRSAKeyPair, dq), ASN1_INTEGER, DER_ENC_SIGNED_INT */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAKeyPair, dq));
+	*dst = currDecoded.content;
+
+	/* DER_OFFSET(DERRSAKeyPair, qInv), ASN1_INTEGER, DER_ENC_SIGNED_INT */
+	drtn = DERDecodeSeqNext(&derSeq, &currDecoded);
+	if(drtn) {
+		return (drtn == DR_EndOfSequence) ? DR_IncompleteSeq : drtn;
+	}
+	if(currDecoded.tag != (ASN1_INTEGER)) {
+		return DR_UnexpectedTag;
+	}
+	dst = (DERItem *)((DERByte *)dest + DER_OFFSET(DERRSAKeyPair, qInv));
+	*dst = currDecoded.content;
+	return DR_Success;
+}
+
+DERReturn DERParseRSAKeyPair(
+	const DERItem			*der,
+	void					*dest,			/* DERDecodedInfo(s) here RETURNED */
+	DERSize					sizeToZero)	/* optional */
+{
+	DERReturn drtn;
+	DERDecodedInfo topDecode;
+
+	drtn = DERDecodeItem(der, &topDecode);
+	if(drtn) {
+		return drtn;
+	}
+	if(topDecode.tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	return DERParseRSAKeyPairContent(&topDecode.content, dest, sizeToZero);
+}
+
+const DERGeneratedDecoder DERGeneratedDecoders[] = 
+{
+	{ "SignedCertCrl", DERSignedCertCrlItemSpecs, &DERNumSignedCertCrlItemSpecs, DERParseSignedCertCrlContent },
+	{ "TBSCert", DERTBSCertItemSpecs, &DERNumTBSCertItemSpecs, DERParseTBSCertContent },
+	{ "Validity", DERValidityItemSpecs, &DERNumValidityItemSpecs, DERParseValidityContent },
+	{ "AttributeTypeAndValue", DERAttributeTypeAndValueItemSpecs, &DERNumAttributeTypeAndValueItemSpecs, DERParseAttributeTypeAndValueContent },
+	{ "Extension", DERExtensionItemSpecs, &DERNumExtensionItemSpecs, DERParseExtensionContent },
+	{ "BasicConstraints", DERBasicConstraintsItemSpecs, &DERNumBasicConstraintsItemSpecs, DERParseBasicConstraintsContent },
+	{ "PrivateKeyUsagePeriod", DERPrivateKeyUsagePeriodItemSpecs, &DERNumPrivateKeyUsagePeriodItemSpecs, DERParsePrivateKeyUsagePeriodContent },
+	{ "DistributionPoint", DERDistributionPointItemSpecs, &DERNumDistributionPointItemSpecs, DERParseDistributionPointContent },
+	{ "PolicyInformation", DERPolicyInformationItemSpecs, &DERNumPolicyInformationItemSpecs, DERParsePolicyInformationContent },
+	{ "PolicyQualifierInfo", DERPolicyQualifierInfoItemSpecs, &DERNumPolicyQualifierInfoItemSpecs, DERParsePolicyQualifierInfoContent },
+	{ "UserNotice", DERUserNoticeItemSpecs, &DERNumUserNoticeItemSpecs, DERParseUserNoticeContent },
+	{ "NoticeReference", DERNoticeReferenceItemSpecs, &DERNumNoticeReferenceItemSpecs, DERParseNoticeReferenceContent },
+	{ "PolicyMapping", DERPolicyMappingItemSpecs, &DERNumPolicyMappingItemSpecs, DERParsePolicyMappingContent },
+	{ "AccessDescription", DERAccessDescriptionItemSpecs, &DERNumAccessDescriptionItemSpecs, DERParseAccessDescriptionContent },
+	{ "AuthorityKeyIdentifier", DERAuthorityKeyIdentifierItemSpecs, &DERNumAuthorityKeyIdentifierItemSpecs, DERParseAuthorityKeyIdentifierContent },
+	{ "OtherName", DEROtherNameItemSpecs, &DERNumOtherNameItemSpecs, DERParseOtherNameContent },
+	{ "PolicyConstraints", DERPolicyConstraintsItemSpecs, &DERNumPolicyConstraintsItemSpecs, DERParsePolicyConstraintsContent },
+	{ "TBSCrl", DERTBSCrlItemSpecs, &DERNumTBSCrlItemSpecs, DERParseTBSCrlContent },
+	{ "RevokedCert", DERRevokedCertItemSpecs, &DERNumRevokedCertItemSpecs, DERParseRevokedCertContent },
+	{ "AlgorithmId", DERAlgorithmIdItemSpecs, &DERNumAlgorithmIdItemSpecs, DERParseAlgorithmIdContent },
+	{ "SubjPubKeyInfo", DERSubjPubKeyInfoItemSpecs, &DERNumSubjPubKeyInfoItemSpecs, DERParseSubjPubKeyInfoContent },
+	{ "RSAPrivKeyCRT", DERRSAPrivKeyCRTItemSpecs, &DERNumRSAPrivKeyCRTItemSpecs, DERParseRSAPrivKeyCRTContent },
+	{ "RSAPubKeyPKCS1", DERRSAPubKeyPKCS1ItemSpecs, &DERNumRSAPubKeyPKCS1ItemSpecs, DERParseRSAPubKeyPKCS1Content },
+	{ "RSAPubKeyApple", DERRSAPubKeyAppleItemSpecs, &DERNumRSAPubKeyAppleItemSpecs, DERParseRSAPubKeyAppleContent },
+	{ "RSAKeyPair", DERRSAKeyPairItemSpecs, &DERNumRSAKeyPairItemSpecs, DERParseRSAKeyPairContent },
+};
+const DERSize DERNumGeneratedDecoders = 
+	sizeof(DERGeneratedDecoders) / sizeof(DERGeneratedDecoder);
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * GENERATED FILE - DO NOT EDIT. Generated by genDecoders.pl from
+ * DER_CertCrl.c, DER_Keys.c.
+ */
+
+#ifndef	_DER_GENERATED_H_
+#define _DER_GENERATED_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libDER/libDER.h>
+
+/*
+ * Each of these is equivalent to DERParseSequenceContent() or
+ * DERParseSequence() with the DERItemSpec table of the same name.
+ */
+DERReturn DERParseSignedCertCrlContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseSignedCertCrl(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseTBSCertContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseTBSCert(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseValidityContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseValidity(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseAttributeTypeAndValueContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseAttributeTypeAndValue(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseExtensionContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseExtension(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseBasicConstraintsContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseBasicConstraints(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParsePrivateKeyUsagePeriodContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParsePrivateKeyUsagePeriod(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseDistributionPointContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseDistributionPoint(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParsePolicyInformationContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParsePolicyInformation(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParsePolicyQualifierInfoContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParsePolicyQualifierInfo(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseUserNoticeContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseUserNotice(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseNoticeReferenceContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseNoticeReference(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParsePolicyMappingContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParsePolicyMapping(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseAccessDescriptionContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseAccessDescription(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseAuthorityKeyIdentifierContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseAuthorityKeyIdentifier(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseOtherNameContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseOtherName(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParsePolicyConstraintsContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParsePolicyConstraints(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseTBSCrlContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseTBSCrl(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseRevokedCertContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseRevokedCert(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseAlgorithmIdContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseAlgorithmId(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseSubjPubKeyInfoContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseSubjPubKeyInfo(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseRSAPrivKeyCRTContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseRSAPrivKeyCRT(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseRSAPubKeyPKCS1Content(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseRSAPubKeyPKCS1(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseRSAPubKeyAppleContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseRSAPubKeyApple(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseRSAKeyPairContent(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+DERReturn DERParseRSAKeyPair(const DERItem *der, void *dest,
+	DERSize sizeToZero);
+
+/* table of generated decoders, for testing */
+typedef DERReturn (*DERGeneratedParseFcn)(const DERItem *content, void *dest,
+	DERSize sizeToZero);
+
+typedef struct {
+	const char				*name;
+	const DERItemSpec		*itemSpecs;
+	const DERSize			*numItemSpecs;
+	DERGeneratedParseFcn	parseContent;
+} DERGeneratedDecoder;
+
+extern const DERGeneratedDecoder DERGeneratedDecoders[];
+extern const DERSize DERNumGeneratedDecoders;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* _DER_GENERATED_H_ */
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * GENERATED FILE - DO NOT EDIT. Generated by genOidTable.pl from
+ * oids.c.
+ */
+
+#include <libDER/DER_OidTable.h>
+
+const DERItem * const DEROidItems[DOID_Count] = {
+	NULL,
+	&oidRsa,
+	&oidMd2Rsa,
+	&oidMd5Rsa,
+	&oidSha1Rsa,
+	&oidSha1,
+	&oidSha256Rsa,
+	&oidSubjectKeyIdentifier,
+	&oidKeyUsage,
+	&oidPrivateKeyUsagePeriod,
+	&oidSubjectAltName,
+	&oidIssuerAltName,
+	&oidBasicConstraints,
+	&oidCrlDistributionPoints,
+	&oidCertificatePolicies,
+	&oidAnyPolicy,
+	&oidPolicyMappings,
+	&oidAuthorityKeyIdentifier,
+	&oidPolicyConstraints,
+	&oidExtendedKeyUsage,
+	&oidAnyExtendedKeyUsage,
+	&oidInhibitAnyPolicy,
+	&oidAuthorityInfoAccess,
+	&oidSubjectInfoAccess,
+	&oidAdOCSP,
+	&oidAdCAIssuer,
+	&oidNetscapeCertType,
+	&oidEntrustVersInfo,
+	&oidMSNTPrincipalName,
+	&oidQtCps,
+	&oidQtUNotice,
+	&oidCommonName,
+	&oidCountryName,
+	&oidLocalityName,
+	&oidStateOrProvinceName,
+	&oidOrganizationName,
+	&oidOrganizationalUnitName,
+	&oidDescription,
+	&oidEmailAddress,
+	&oidFriendlyName,
+	&oidLocalKeyId,
+	&oidExtendedKeyUsageServerAuth,
+	&oidExtendedKeyUsageClientAuth,
+	&oidExtendedKeyUsageCodeSigning,
+	&oidExtendedKeyUsageEmailProtection,
+	&oidExtendedKeyUsageOCSPSigning,
+	&oidExtendedKeyUsageIPSec,
+	&oidExtendedKeyUsageMicrosoftSGC,
+	&oidExtendedKeyUsageNetscapeSGC,
+	&oidAppleSecureBootCertSpec,
+	&oidAppleProvisioningProfile,
+	&oidAppleApplicationSigning,
+};
+
+const char * const DEROidStrings[DOID_Count] = {
+	NULL,
+	"1.2.840.113549.1.1.1",		/* Rsa */
+	"1.2.840.113549.1.1.2",		/* Md2Rsa */
+	"1.2.840.113549.1.1.4",		/* Md5Rsa */
+	"1.2.840.113549.1.1.5",		/* Sha1Rsa */
+	"1.3.14.3.2.26",		/* Sha1 */
+	"1.2.840.113549.1.1.11",		/* Sha256Rsa */
+	"2.5.29.14",		/* SubjectKeyIdentifier */
+	"2.5.29.15",		/* KeyUsage */
+	"2.5.29.16",		/* PrivateKeyUsagePeriod */
+	"2.5.29.17",		/* SubjectAltName */
+	"2.5.29.18",		/* IssuerAltName */
+	"2.5.29.19",		/* BasicConstraints */
+	"2.5.29.31",		/* CrlDistributionPoints */
+	"2.5.29.32",		/* CertificatePolicies */
+	"2.5.29.32.0",		/* AnyPolicy */
+	"2.5.29.33",		/* PolicyMappings */
+	"2.5.29.35",		/* AuthorityKeyIdentifier */
+	"2.5.29.36",		/* PolicyConstraints */
+	"2.5.29.37",		/* ExtendedKeyUsage */
+	"2.5.29.37.0",		/* AnyExtendedKeyUsage */
+	"2.5.29.54",		/* InhibitAnyPolicy */
+	"1.3.6.1.5.5.7.1.1",		/* AuthorityInfoAccess */
+	"1.3.6.1.5.5.7.1.11",		/* SubjectInfoAccess */
+	"1.3.6.1.5.5.7.48.1",		/* AdOCSP */
+	"1.3.6.1.5.5.7.48.2",		/* AdCAIssuer */
+	"2.16.840.1.113730.1.1",		/* NetscapeCertType */
+	"1.2.840.113533.7.65.0",		/* EntrustVersInfo */
+	"1.3.6.1.4.1.311.20.2.3",		/* MSNTPrincipalName */
+	"1.3.6.1.5.5.7.2.1",		/* QtCps */
+	"1.3.6.1.5.5.7.2.2",		/* QtUNotice */
+	"2.5.4.3",		/* CommonName */
+	"2.5.4.6",		/* CountryName */
+	"2.5.4.7",		/* LocalityName */
+	"2.5.4.8",		/* StateOrProvinceName */
+	"2.5.4.10",		/* OrganizationName */
+	"2.5.4.11",		/* OrganizationalUnitName */
+	"2.5.4.13",		/* Description */
+	"1.2.840.113549.1.9.1",		/* EmailAddress */
+	"1.2.840.113549.1.9.20",		/* FriendlyName */
+	"1.2.840.113549.1.9.21",		/* LocalKeyId */
+	"1.3.6.1.5.5.7.3.1",		/* ExtendedKeyUsageServerAuth */
+	"1.3.6.1.5.5.7.3.2",		/* ExtendedKeyUsageClientAuth */
+	"1.3.6.1.5.5.7.3.3",		/* ExtendedKeyUsageCodeSigning */
+	"1.3.6.1.5.5.7.3.4",		/* ExtendedKeyUsageEmailProtection */
+	"1.3.6.1.5.5.7.3.9",		/* ExtendedKeyUsageOCSPSigning */
+	"1.3.6.1.5.5.8.2.2",		/* ExtendedKeyUsageIPSec */
+	"1.3.6.1.4.1.311.10.3.3",		/* ExtendedKeyUsageMicrosoftSGC */
+	"2.16.840.1.113730.4.1",		/* ExtendedKeyUsageNetscapeSGC */
+	"1.2.840.113635.100.6.1.1",		/* AppleSecureBootCertSpec */
+	"1.2.840.113635.100.6.2.2.1",		/* AppleProvisioningProfile */
+	"1.2.840.113635.100.6.1.3",		/* AppleApplicationSigning */
+};
+
+#define DER_OID_HASH_SEED	234U
+#define DER_OID_HASH_BITS	8
+#define DER_OID_HASH_SIZE	(1 << DER_OID_HASH_BITS)
+
+/* DEROidID for each hash slot */
+static const DERByte DEROidHashSlots[DER_OID_HASH_SIZE] = {
+	  0,  29,   0,   0,   0,  32,   0,   0,   0,   6,   0,   0,  25,   0,  39,   0,
+	 16,   2,   0,  15,  43,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,  36,   0,   0,   0,   0,   0,   1,  23,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  49,   0,   0,   0,
+	 22,   0,   0,  51,  24,   0,   0,  12,   0,   0,  27,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,  19,  28,  41,   0,  48,   0,   0,
+	 42,   0,   0,  37,   0,   0,   0,   0,   0,   0,   0,   0,   9,   0,   0,  21,
+	  0,   0,  18,   0,   0,  44,   0,   0,   0,  35,  20,   0,   0,  17,   0,   0,
+	  0,   0,   0,   0,   0,   0,   8,  31,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,  34,   0,   0,  38,   0,   0,   0,   0,   0,
+	  0,   0,   3,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,  46,   0,   0,   0,   0,   0,   0,   0,   0,  14,   0,   0,   0,   0,
+	  7,   0,   0,  13,   0,   0,   0,   0,   0,  40,   0,   0,   0,   0,   0,   0,
+	  0,  47,   0,   0,   0,   0,   0,   4,  45,   0,   0,   0,   0,   0,   0,  11,
+	 10,   0,   0,   0,  50,   5,  26,   0,   0,   0,   0,   0,   0,   0,  33,  30,
+};
+
+DEROidID DEROidLookup(
+	const DERItem		*oid)
+{
+	uint32_t hash = DER_OID_HASH_SEED;
+	DERSize dex;
+	DEROidID oidID;
+
+	if(oid == NULL) {
+		return DOID_Unknown;
+	}
+	for(dex=0; dex<oid->length; dex++) {
+		hash = (hash ^ oid->data[dex]) * 16777619U;
+	}
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bU;
+	hash ^= hash >> 13;
+	oidID = (DEROidID)DEROidHashSlots[hash & (DER_OID_HASH_SIZE - 1)];
+	if((oidID != DOID_Unknown) && DEROidCompare(oid, DEROidItems[oidID])) {
+		return oidID;
+	}
+	return DOID_Unknown;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * GENERATED FILE - DO NOT EDIT. Generated by genOidTable.pl from
+ * oids.c.
+ */
+
+#ifndef	_DER_OIDTABLE_H_
+#define _DER_OIDTABLE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libDER/libDER.h>
+#include <libDER/oids.h>
+
+/* IDs of the OIDs in oids.c */
+typedef enum {
+	DOID_Unknown = 0,
+	DOID_Rsa,
+	DOID_Md2Rsa,
+	DOID_Md5Rsa,
+	DOID_Sha1Rsa,
+	DOID_Sha1,
+	DOID_Sha256Rsa,
+	DOID_SubjectKeyIdentifier,
+	DOID_KeyUsage,
+	DOID_PrivateKeyUsagePeriod,
+	DOID_SubjectAltName,
+	DOID_IssuerAltName,
+	DOID_BasicConstraints,
+	DOID_CrlDistributionPoints,
+	DOID_CertificatePolicies,
+	DOID_AnyPolicy,
+	DOID_PolicyMappings,
+	DOID_AuthorityKeyIdentifier,
+	DOID_PolicyConstraints,
+	DOID_ExtendedKeyUsage,
+	DOID_AnyExtendedKeyUsage,
+	DOID_InhibitAnyPolicy,
+	DOID_AuthorityInfoAccess,
+	DOID_SubjectInfoAccess,
+	DOID_AdOCSP,
+	DOID_AdCAIssuer,
+	DOID_NetscapeCertType,
+	DOID_EntrustVersInfo,
+	DOID_MSNTPrincipalName,
+	DOID_QtCps,
+	DOID_QtUNotice,
+	DOID_CommonName,
+	DOID_CountryName,
+	DOID_LocalityName,
+	DOID_StateOrProvinceName,
+	DOID_OrganizationName,
+	DOID_OrganizationalUnitName,
+	DOID_Description,
+	DOID_EmailAddress,
+	DOID_FriendlyName,
+	DOID_LocalKeyId,
+	DOID_ExtendedKeyUsageServerAuth,
+	DOID_ExtendedKeyUsageClientAuth,
+	DOID_ExtendedKeyUsageCodeSigning,
+	DOID_ExtendedKeyUsageEmailProtection,
+	DOID_ExtendedKeyUsageOCSPSigning,
+	DOID_ExtendedKeyUsageIPSec,
+	DOID_ExtendedKeyUsageMicrosoftSGC,
+	DOID_ExtendedKeyUsageNetscapeSGC,
+	DOID_AppleSecureBootCertSpec,
+	DOID_AppleProvisioningProfile,
+	DOID_AppleApplicationSigning,
+	DOID_Count
+} DEROidID;
+
+/* indexed by DEROidID; entry 0 is NULL */
+extern const DERItem * const DEROidItems[DOID_Count];
+extern const char * const DEROidStrings[DOID_Count];	/* "2.5.29.15" etc. */
+
+/* Map an OID to its DEROidID, DOID_Unknown if it's not in oids.c. */
+DEROidID DEROidLookup(
+	const DERItem		*oid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* _DER_OIDTABLE_H_ */
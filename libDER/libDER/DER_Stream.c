@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * DER_Stream.c - incremental (push-style) DER decoding
+ */
+
+#include <libDER/DER_Stream.h>
+#include <libDER/asn1Types.h>
+
+#include <libDER/libDER_config.h>
+
+#ifndef	DER_DECODE_ENABLE
+#error Please define DER_DECODE_ENABLE.
+#endif
+
+#if		DER_DECODE_ENABLE
+
+/*
+ * Decode a tag and length from the first avail bytes at derPtr. Same
+ * rules as DERDecodeItem(), except that the content need not be present,
+ * and running out of bytes before the length is complete is reported
+ * as DR_IncompleteSeq rather than DR_DecodeError.
+ */
+static DERReturn DERStreamDecodeHeader(
+	const DERByte	*derPtr,
+	DERSize			avail,
+	DERTag			*tag,			/* RETURNED */
+	DERSize			*contentLen,	/* RETURNED */
+	DERSize			*headerLen)		/* RETURNED */
+{
+	DERByte tag1;			/* first tag byte */
+	DERByte len1;			/* first length byte */
+	DERTag tagNumber;       /* tag number without class and method bits */
+	DERSize used = 0;
+
+	if(avail < 1) {
+		return DR_IncompleteSeq;
+	}
+	tag1 = derPtr[used++];
+	tagNumber = tag1 & 0x1F;
+	if(tagNumber == 0x1F) {
+#ifdef DER_MULTIBYTE_TAGS
+        const DERTag overflowMask = ((DERTag)0x7F << (sizeof(DERTag) * 8 - 7));
+        DERByte tagByte;
+        tagNumber = 0;
+        do {
+            if(used >= avail) {
+                return DR_IncompleteSeq;
+            }
+            if((tagNumber & overflowMask) != 0) {
+                return DR_DecodeError;
+            }
+            tagByte = derPtr[used++];
+            tagNumber = (tagNumber << 7) | (tagByte & 0x7F);
+        } while((tagByte & 0x80) != 0);
+
+        /* Check for any of the top 3 reserved bits being set. */
+        if ((tagNumber & (overflowMask << 4)) != 0)
+#endif
+            return DR_DecodeError;
+	}
+
+	if(used >= avail) {
+		return DR_IncompleteSeq;
+	}
+	len1 = derPtr[used++];
+	if(len1 & 0x80) {
+		/* long length form - first byte is length of length */
+		DERSize longLen = 0;
+		unsigned dex;
+
+		len1 &= 0x7f;
+		if((len1 == 0) || (len1 > sizeof(DERSize))) {
+			/* indefinite length, or too big */
+			return DR_DecodeError;
+		}
+		if(avail - used < len1) {
+			return DR_IncompleteSeq;
+		}
+		for(dex=0; dex<len1; dex++) {
+			longLen <<= 8;
+			longLen |= derPtr[used++];
+		}
+		*contentLen = longLen;
+	}
+	else {
+		*contentLen = len1;
+	}
+	*tag = ((DERTag)(tag1 & 0xE0) << ((sizeof(DERTag) - 1) * 8)) | tagNumber;
+	*headerLen = used;
+	return DR_Success;
+}
+
+static DERReturn DERStreamEmit(
+	DERStream			*stream,
+	DERStreamEventType	type,
+	const DERStreamFrame *frame,
+	DERShort			depth,
+	const DERByte		*der,
+	DERSize				derLen,
+	DERStreamAction		*action)
+{
+	DERStreamEvent event;
+	DERStreamAction ignored;
+
+	event.type = type;
+	event.tag = frame->tag;
+	event.length = frame->length;
+	event.depth = depth;
+	event.der.data = (DERByte *)der;
+	event.der.length = derLen;
+	event.decoded.tag = frame->tag;
+	if(type == DSE_Item) {
+		/* content is at the end of the full encoding */
+		event.decoded.content.data = (DERByte *)der + derLen - frame->length;
+		event.decoded.content.length = frame->length;
+	}
+	else {
+		event.decoded.content = event.der;
+	}
+	if(action == NULL) {
+		ignored = frame->action;
+		action = &ignored;
+	}
+	return stream->callback(stream->context, &event, action);
+}
+
+/*
+ * Close out any DSA_Descend items whose content has been used up.
+ */
+static DERReturn DERStreamPopFrames(
+	DERStream			*stream)
+{
+	DERReturn drtn;
+
+	while((stream->depth > 0) &&
+	      (stream->stack[stream->depth - 1].end == stream->offset)) {
+		stream->depth--;
+		drtn = DERStreamEmit(stream, DSE_ItemEnd,
+			&stream->stack[stream->depth], stream->depth, NULL, 0, NULL);
+		if(drtn) {
+			return drtn;
+		}
+	}
+	return DR_Success;
+}
+
+/* the current leaf item's content has all been consumed */
+static DERReturn DERStreamEndItem(
+	DERStream			*stream)
+{
+	DERReturn drtn = DR_Success;
+
+	stream->inItem = 0;
+	switch(stream->item.action) {
+		case DSA_Stream:
+			drtn = DERStreamEmit(stream, DSE_ItemEnd, &stream->item,
+				stream->depth, NULL, 0, NULL);
+			break;
+		case DSA_Collect:
+			drtn = DERStreamEmit(stream, DSE_Item, &stream->item,
+				stream->depth, stream->scratch, stream->collected, NULL);
+			break;
+		default:
+			break;
+	}
+	if(drtn) {
+		return drtn;
+	}
+	return DERStreamPopFrames(stream);
+}
+
+/*
+ * A complete header has been decoded and consumed; stream->offset is
+ * the offset of the item's content. If the header was decoded in place,
+ * headerPtr points to it and data/length describe what follows in the
+ * caller's chunk; otherwise the header is in stream->header.
+ */
+static DERReturn DERStreamStartItem(
+	DERStream			*stream,
+	DERTag				tag,
+	DERSize				contentLen,
+	const DERByte		*headerPtr,
+	DERSize				headerLen,
+	const DERByte		**data,		/* IN/OUT */
+	DERSize				*length)	/* IN/OUT */
+{
+	DERStreamFrame frame;
+	DERStreamAction action;
+	DERReturn drtn;
+
+	frame.end = stream->offset + contentLen;
+	frame.length = contentLen;
+	frame.tag = tag;
+	if((stream->depth > 0) &&
+	   (frame.end > stream->stack[stream->depth - 1].end)) {
+		/* runs past the end of the enclosing item */
+		return DR_DecodeError;
+	}
+
+	action = (tag & ASN1_CONSTRUCTED) ? DSA_Descend : DSA_Stream;
+	frame.action = action;
+	drtn = DERStreamEmit(stream, DSE_ItemStart, &frame, stream->depth,
+		NULL, 0, &action);
+	if(drtn) {
+		return drtn;
+	}
+	frame.action = action;
+
+	switch(action) {
+		case DSA_Descend:
+			if(!(tag & ASN1_CONSTRUCTED)) {
+				return DR_ParamErr;
+			}
+			if(stream->depth == DER_STREAM_MAX_DEPTH) {
+				return DR_BufOverflow;
+			}
+			stream->stack[stream->depth++] = frame;
+			/* might be empty */
+			return DERStreamPopFrames(stream);
+		case DSA_Stream:
+		case DSA_Skip:
+			break;
+		case DSA_Collect:
+			if((contentLen == 0) ||
+			   ((headerPtr != NULL) && (*length >= contentLen))) {
+				/* easy case - it's all right here, or it's just a header */
+				stream->item = frame;
+				drtn = DERStreamEmit(stream, DSE_Item, &frame, stream->depth,
+					headerPtr ? headerPtr : stream->header,
+					headerLen + contentLen, NULL);
+				if(drtn) {
+					return drtn;
+				}
+				*data += contentLen;
+				*length -= contentLen;
+				stream->offset += contentLen;
+				return DERStreamPopFrames(stream);
+			}
+			/* straddles chunks, assemble it in scratch */
+			if((stream->scratch == NULL) ||
+			   (contentLen > stream->scratchSize) ||
+			   (headerLen > stream->scratchSize - contentLen)) {
+				return DR_BufOverflow;
+			}
+			DERMemmove(stream->scratch,
+				headerPtr ? headerPtr : stream->header, headerLen);
+			stream->collected = headerLen;
+			break;
+		default:
+			return DR_ParamErr;
+	}
+
+	stream->item = frame;
+	stream->inItem = 1;
+	if(contentLen == 0) {
+		return DERStreamEndItem(stream);
+	}
+	return DR_Success;
+}
+
+DERReturn DERStreamInit(
+	DERStream			*stream,
+	DERStreamCallback	callback,
+	void				*context,
+	DERByte				*scratch,		/* optional */
+	DERSize				scratchSize)
+{
+	if((stream == NULL) || (callback == NULL)) {
+		return DR_ParamErr;
+	}
+	DERMemset(stream, 0, sizeof(*stream));
+	stream->callback = callback;
+	stream->context = context;
+	stream->scratch = scratch;
+	stream->scratchSize = scratch ? scratchSize : 0;
+	stream->status = DR_Success;
+	return DR_Success;
+}
+
+DERReturn DERStreamFeed(
+	DERStream			*stream,
+	const DERByte		*data,
+	DERSize				length)
+{
+	DERReturn drtn = DR_Success;
+
+	if(stream->status) {
+		return stream->status;
+	}
+
+	while(length != 0) {
+		DERTag tag;
+		DERSize contentLen;
+		DERSize headerLen;
+		const DERByte *headerPtr;
+
+		if(stream->inItem) {
+			/* more content for the current leaf item */
+			uint64_t remaining = stream->item.end - stream->offset;
+			DERSize thisLen = (remaining < length) ? (DERSize)remaining : length;
+
+			switch(stream->item.action) {
+				case DSA_Stream:
+					drtn = DERStreamEmit(stream, DSE_Content, &stream->item,
+						stream->depth, data, thisLen, NULL);
+					break;
+				case DSA_Collect:
+					DERMemmove(stream->scratch + stream->collected, data, thisLen);
+					stream->collected += thisLen;
+					break;
+				default:
+					break;
+			}
+			if(drtn) {
+				break;
+			}
+			data += thisLen;
+			length -= thisLen;
+			stream->offset += thisLen;
+			if(stream->offset == stream->item.end) {
+				drtn = DERStreamEndItem(stream);
+				if(drtn) {
+					break;
+				}
+			}
+			continue;
+		}
+
+		/*
+		 * Next up is a tag and length. Decode it in place if we can,
+		 * else accumulate it one byte at a time.
+		 */
+		if(stream->headerLen == 0) {
+			DERSize avail = (length < DER_STREAM_MAX_HEADER) ?
+				length : DER_STREAM_MAX_HEADER;
+			drtn = DERStreamDecodeHeader(data, avail, &tag, &contentLen, &headerLen);
+			if((drtn == DR_IncompleteSeq) && (length < DER_STREAM_MAX_HEADER)) {
+				/* the rest of this chunk is a partial header */
+				DERMemmove(stream->header, data, length);
+				stream->headerLen = length;
+				stream->offset += length;
+				length = 0;
+				drtn = DR_Success;
+			}
+			else if(drtn == DR_Success) {
+				headerPtr = data;
+				data += headerLen;
+				length -= headerLen;
+				stream->offset += headerLen;
+			}
+		}
+		else {
+			stream->header[stream->headerLen++] = *data++;
+			length--;
+			stream->offset++;
+			drtn = DERStreamDecodeHeader(stream->header, stream->headerLen,
+				&tag, &contentLen, &headerLen);
+			if(drtn == DR_IncompleteSeq) {
+				drtn = DR_Success;
+			}
+			else if(drtn == DR_Success) {
+				headerPtr = NULL;
+				stream->headerLen = 0;
+			}
+		}
+		if(drtn) {
+			break;
+		}
+		if((stream->depth > 0) &&
+		   (stream->offset > stream->stack[stream->depth - 1].end)) {
+			/* header runs past the end of the enclosing item */
+			drtn = DR_DecodeError;
+			break;
+		}
+		if(stream->headerLen != 0) {
+			/* still waiting for the rest of the header */
+			continue;
+		}
+		drtn = DERStreamStartItem(stream, tag, contentLen, headerPtr, headerLen,
+			&data, &length);
+		if(drtn) {
+			break;
+		}
+	}
+	stream->status = drtn;
+	return drtn;
+}
+
+DERReturn DERStreamFinish(
+	DERStream			*stream)
+{
+	if(stream->status) {
+		return stream->status;
+	}
+	if(stream->inItem || (stream->headerLen != 0) || (stream->depth != 0)) {
+		return DR_IncompleteSeq;
+	}
+	return DR_Success;
+}
+
+#endif	/* DER_DECODE_ENABLE */
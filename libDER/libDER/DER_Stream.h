@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+/*
+ * DER_Stream.h - incremental (push-style) DER decoding
+ */
+
+#ifndef	_DER_STREAM_H_
+#define _DER_STREAM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libDER/libDER.h>
+#include <libDER/DER_Decode.h>
+
+/*
+ * The routines in DER_Decode.h require the entire encoding to be
+ * contiguous in memory. The stream decoder accepts its input in
+ * arbitrarily sized chunks via DERStreamFeed() and reports what it
+ * finds to a caller-supplied callback as a series of events. State
+ * is kept in a fixed-size DERStream, so memory use is bounded no
+ * matter how large the encoding is; the only other memory used is
+ * an optional caller-supplied scratch buffer (see DSA_Collect).
+ *
+ * As with the rest of libDER, only definite length encodings are
+ * supported. Any number of top-level items may be fed in sequence.
+ */
+
+/* max nesting of constructed items the caller can descend into */
+#ifndef DER_STREAM_MAX_DEPTH
+#define DER_STREAM_MAX_DEPTH	16
+#endif
+
+/* max size of an encoded tag and length */
+#define DER_STREAM_MAX_HEADER	\
+	(1 + ((sizeof(DERTag) * 8) + 6) / 7 + 1 + sizeof(DERSize))
+
+typedef enum {
+	DSE_ItemStart,		/* tag and length of a new item decoded */
+	DSE_Content,		/* a fragment of a DSA_Stream item's content */
+	DSE_Item,			/* a complete DSA_Collect item */
+	DSE_ItemEnd			/* end of a DSA_Descend or DSA_Stream item */
+} DERStreamEventType;
+
+/*
+ * What to do with an item, returned by the callback for DSE_ItemStart.
+ * The default is DSA_Descend for constructed items and DSA_Stream
+ * for primitive ones.
+ */
+typedef enum {
+	DSA_Descend,		/* constructed only: report each enclosed item */
+	DSA_Stream,			/* report content as DSE_Content fragments */
+	DSA_Skip,			/* discard the item; no further events */
+	DSA_Collect			/* report the whole item once, as DSE_Item */
+} DERStreamAction;
+
+typedef struct {
+	DERStreamEventType	type;
+	DERTag				tag;
+	DERSize				length;		/* content length of current item */
+	DERShort			depth;		/* 0 for top-level items */
+
+	/*
+	 * DSE_Content: the fragment of content.
+	 * DSE_Item: decoded.content is the item's content and der is its
+	 * full DER encoding, including tag and length.
+	 *
+	 * These are only valid for the duration of the callback; they point
+	 * into either the caller's current chunk or the scratch buffer.
+	 */
+	DERDecodedInfo		decoded;
+	DERItem				der;
+} DERStreamEvent;
+
+/*
+ * Event callback. For DSE_ItemStart, *action is set to the default
+ * action on entry and may be changed by the callback; it's ignored
+ * for the other events. Any return other than DR_Success aborts
+ * decoding, and that value is returned from DERStreamFeed().
+ */
+typedef DERReturn (*DERStreamCallback)(
+	void					*context,
+	const DERStreamEvent	*event,
+	DERStreamAction			*action);	/* IN/OUT, DSE_ItemStart only */
+
+/* one open constructed or streamed item */
+typedef struct {
+	uint64_t			end;			/* stream offset just past content */
+	DERSize				length;			/* content length */
+	DERTag				tag;
+	DERStreamAction		action;
+} DERStreamFrame;
+
+/*
+ * State of a stream decode. Opaque to callers; allocate one (on the
+ * stack is fine) and call DERStreamInit().
+ */
+typedef struct {
+	DERStreamCallback	callback;
+	void				*context;
+	DERByte				*scratch;		/* for DSA_Collect, optional */
+	DERSize				scratchSize;
+
+	DERReturn			status;			/* sticky error */
+	uint64_t			offset;			/* total bytes consumed so far */
+
+	/* header being accumulated across chunks */
+	DERByte				header[DER_STREAM_MAX_HEADER];
+	DERSize				headerLen;
+
+	/* current leaf item, if any (DSA_Stream, DSA_Skip, DSA_Collect) */
+	int					inItem;
+	DERStreamFrame		item;
+	DERSize				collected;		/* bytes of item in scratch */
+
+	/* open DSA_Descend items */
+	DERShort			depth;
+	DERStreamFrame		stack[DER_STREAM_MAX_DEPTH];
+} DERStream;
+
+/*
+ * Prepare a DERStream for use. The scratch buffer is only needed when
+ * the callback uses DSA_Collect; items which arrive in one chunk are
+ * reported in place, as are empty ones; those which straddle chunks
+ * are assembled in scratch and must fit there (else DR_BufOverflow).
+ */
+DERReturn DERStreamInit(
+	DERStream			*stream,
+	DERStreamCallback	callback,
+	void				*context,
+	DERByte				*scratch,		/* optional */
+	DERSize				scratchSize);
+
+/*
+ * Feed the next chunk of the encoding. Chunks may be split anywhere,
+ * including within a tag or length. Callbacks are invoked from within
+ * this call. Once an error is returned, all subsequent calls return
+ * the same error.
+ */
+DERReturn DERStreamFeed(
+	DERStream			*stream,
+	const DERByte		*data,
+	DERSize				length);
+
+/*
+ * Call after the last chunk. Returns DR_IncompleteSeq if the input
+ * ended part way through an item.
+ */
+DERReturn DERStreamFinish(
+	DERStream			*stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* _DER_STREAM_H_ */
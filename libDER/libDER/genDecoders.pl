@@ -0,0 +1,303 @@
+#!/usr/bin/perl
+#
+# Copyright (c) 2010 Apple Inc. All Rights Reserved.
+#
+# genDecoders.pl - generate straight-line sequence decoders from the
+# DERItemSpec tables in libDER source files.
+#
+# DERParseSequenceContent() interprets a DERItemSpec table at runtime,
+# checking each item's options and tag as it goes. For each table found
+# in the input files this script emits a pair of functions which do
+# exactly the same thing with the tags, offsets, and options baked in:
+#
+#	DERReturn DERParse<Name>Content(const DERItem *content, void *dest,
+#		DERSize sizeToZero);
+#	DERReturn DERParse<Name>(const DERItem *der, void *dest,
+#		DERSize sizeToZero);
+#
+# where the table is named DER<Name>ItemSpecs. These behave identically to
+# DERParseSequenceContent() and DERParseSequence() called with that table.
+# DERGeneratedDecoders[] lists each table with its generated decoder, for
+# use in differential testing (see Tests/diffDecoders.c).
+#
+# The interpreted path remains the reference; rerun this whenever a table
+# changes:
+#
+#	cd libDER/libDER && perl genDecoders.pl -o DER_Generated \
+#		-i libDER/DER_CertCrl.h -i libDER/DER_Keys.h DER_CertCrl.c DER_Keys.c
+#
+# Options:
+#	-o base		write base.c and base.h
+#	-i header	#include <header> in the generated files
+#	-s			generate static functions into base.c only, for #including
+#				in the file which defines the tables (which may define
+#				the destination structs privately)
+#
+
+use strict;
+use warnings;
+
+my %optionValues = (
+	'DER_DEC_NO_OPTS'	=> 0x0000,
+	'DER_DEC_OPTIONAL'	=> 0x0001,
+	'DER_DEC_ASN_ANY'	=> 0x0002,
+	'DER_DEC_SKIP'		=> 0x0004,
+	'DER_DEC_SAVE_DER'	=> 0x0008,
+	'DER_ENC_NO_OPTS'	=> 0x0000,
+	'DER_ENC_SIGNED_INT'=> 0x0100,
+	'DER_ENC_WRITE_DER'	=> 0x0200,
+);
+
+my $outBase;
+my $static = 0;
+my @includes;
+my @inFiles;
+
+while (@ARGV) {
+	my $arg = shift @ARGV;
+	if ($arg eq '-o') {
+		$outBase = shift @ARGV;
+	} elsif ($arg eq '-i') {
+		push @includes, shift @ARGV;
+	} elsif ($arg eq '-s') {
+		$static = 1;
+	} else {
+		push @inFiles, $arg;
+	}
+}
+die "usage: $0 [-s] [-i header]... -o base specfile.c...\n"
+	unless defined($outBase) && @inFiles;
+
+# split on commas not enclosed in parentheses
+sub splitFields {
+	my ($str) = @_;
+	my @fields;
+	my $depth = 0;
+	my $curr = '';
+	foreach my $ch (split //, $str) {
+		if ($ch eq ',' && $depth == 0) {
+			push @fields, $curr;
+			$curr = '';
+			next;
+		}
+		$depth++ if $ch eq '(';
+		$depth-- if $ch eq ')';
+		$curr .= $ch;
+	}
+	push @fields, $curr;
+	@fields = map { s/^\s+|\s+$//g; s/\s+/ /g; $_ } @fields;
+	return grep { $_ ne '' } @fields;
+}
+
+sub optionsValue {
+	my ($str) = @_;
+	my $value = 0;
+	foreach my $opt (split /\|/, $str) {
+		$opt =~ s/^\s+|\s+$//g;
+		if (exists $optionValues{$opt}) {
+			$value |= $optionValues{$opt};
+		} elsif ($opt =~ /^(0x[0-9a-fA-F]+|\d+)$/) {
+			$value |= ($opt =~ /^0/) ? oct($opt) : $opt;
+		} else {
+			die "unknown option '$opt'\n";
+		}
+	}
+	return $value;
+}
+
+# parse all tables: list of { name, file, items => [ {offset, tag, options} ] }
+my @tables;
+foreach my $file (@inFiles) {
+	open(my $fh, '<', $file) or die "$file: $!\n";
+	local $/;
+	my $src = <$fh>;
+	close $fh;
+	$src =~ s{/\*.*?\*/}{}gs;
+	$src =~ s{//[^\n]*}{}g;
+	while ($src =~ /const\s+DERItemSpec\s+(\w+)\s*\[\s*\]\s*=\s*\{(.*?)\}\s*;/gs) {
+		my ($name, $body) = ($1, $2);
+		my @items;
+		while ($body =~ /\{([^{}]*)\}/g) {
+			my @f = splitFields($1);
+			die "$file: $name: malformed item '$1'\n" unless @f == 3;
+			push @items, { offset => $f[0], tag => $f[1],
+				options => optionsValue($f[2]), optStr => $f[2] };
+		}
+		die "$file: $name: no items\n" unless @items;
+		(my $base = $name) =~ s/^DER(\w+)ItemSpecs$/$1/
+			or die "$file: $name: can't derive decoder name\n";
+		(my $shortFile = $file) =~ s{.*/}{};
+		push @tables, { name => $name, base => $base, file => $shortFile,
+			items => \@items };
+	}
+}
+die "no DERItemSpec tables found\n" unless @tables;
+
+my $header = <<"EOF";
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * GENERATED FILE - DO NOT EDIT. Generated by genDecoders.pl from
+ * @{[ join(', ', map { my $f = $_; $f =~ s{.*/}{}; $f } @inFiles) ]}.
+ */
+EOF
+
+my $fnStatic = $static ? 'static ' : '';
+
+sub emitDecoder {
+	my ($t) = @_;
+	my @items = @{$t->{items}};
+	my $num = scalar @items;
+	my $out = '';
+
+	# which locals do we need?
+	my ($needDst, $needDER, $needPending) = (0, 0, 0);
+	for (my $i = 0; $i < $num; $i++) {
+		my $o = $items[$i]{options};
+		$needDst = 1 unless $o & $optionValues{DER_DEC_SKIP};
+		$needDER = 1 if $o & $optionValues{DER_DEC_SAVE_DER};
+		$needPending = 1 if ($i < $num - 1) && ($o & $optionValues{DER_DEC_OPTIONAL}) &&
+			!($o & $optionValues{DER_DEC_ASN_ANY});
+	}
+
+	$out .= "/* $t->{name} from $t->{file} */\n";
+	$out .= "${fnStatic}DERReturn DERParse$t->{base}Content(\n";
+	$out .= "\tconst DERItem\t\t\t*content,\n";
+	$out .= "\tvoid\t\t\t\t\t*dest,\t\t\t/* DERDecodedInfo(s) here RETURNED */\n";
+	$out .= "\tDERSize\t\t\t\t\tsizeToZero)\t/* optional */\n";
+	$out .= "{\n";
+	$out .= "\tDERSequence\t\tderSeq;\n";
+	$out .= "\tDERDecodedInfo\tcurrDecoded;\n";
+	$out .= "\tDERReturn\t\tdrtn;\n";
+	$out .= "\tDERItem\t\t\t*dst;\n" if $needDst;
+	$out .= "\tDERByte\t\t\t*currDER;\n" if $needDER;
+	$out .= "\tint\t\t\t\tpending = 0;\n" if $needPending;
+	$out .= "\n";
+	$out .= "\tif(sizeToZero) {\n\t\tDERMemset(dest, 0, sizeToZero);\n\t}\n";
+	$out .= "\tderSeq.nextItem = content->data;\n";
+	$out .= "\tderSeq.end = content->data + content->length;\n";
+
+	# mayPend: an unmatched item might be waiting from an earlier optional spec
+	my $mayPend = 0;
+	for (my $i = 0; $i < $num; $i++) {
+		my $it = $items[$i];
+		my $o = $it->{options};
+		my $optional = $o & $optionValues{DER_DEC_OPTIONAL};
+		my $any = $o & $optionValues{DER_DEC_ASN_ANY};
+		my $last = ($i == $num - 1);
+		my $restOptional = 1;
+		for (my $j = $i; $j < $num; $j++) {
+			$restOptional = 0 unless $items[$j]{options} & $optionValues{DER_DEC_OPTIONAL};
+		}
+		my $eos = $restOptional ? 'DR_Success' : 'DR_IncompleteSeq';
+		my $ind = $mayPend ? "\t\t" : "\t";
+
+		$out .= "\n\t/* $it->{offset}, $it->{tag}, $it->{optStr} */\n";
+		$out .= "\tif(!pending) {\n" if $mayPend;
+		$out .= "${ind}currDER = derSeq.nextItem;\n" if $needDER;
+		$out .= "${ind}drtn = DERDecodeSeqNext(&derSeq, &currDecoded);\n";
+		$out .= "${ind}if(drtn) {\n";
+		$out .= "${ind}\treturn (drtn == DR_EndOfSequence) ? $eos : drtn;\n";
+		$out .= "${ind}}\n";
+		$out .= "\t}\n" if $mayPend;
+
+		my $store = '';
+		unless ($o & $optionValues{DER_DEC_SKIP}) {
+			$store .= "dst = (DERItem *)((DERByte *)dest + $it->{offset});\n";
+			$store .= "*dst = currDecoded.content;\n";
+			if ($o & $optionValues{DER_DEC_SAVE_DER}) {
+				$store .= "dst->data = currDER;\n";
+				$store .= "dst->length += (currDecoded.content.data - currDER);\n";
+			}
+		}
+		$store .= "pending = 0;\n" if $mayPend;
+		$store .= "return DR_Success;\n" if $last;
+
+		my $indent = sub { my ($s, $n) = @_; my $t = "\t" x $n; $s =~ s/^/$t/mg; $s };
+		if ($any) {
+			$out .= $indent->($store, 1);
+			$mayPend = 0;
+		} elsif (!$optional) {
+			$out .= "\tif(currDecoded.tag != ($it->{tag})) {\n\t\treturn DR_UnexpectedTag;\n\t}\n";
+			$out .= $indent->($store, 1);
+			$mayPend = 0;
+		} elsif ($last) {
+			$out .= "\tif(currDecoded.tag == ($it->{tag})) {\n";
+			$out .= $indent->($store, 2);
+			$out .= "\t}\n\treturn DR_UnexpectedTag;\n";
+		} else {
+			$out .= "\tif(currDecoded.tag == ($it->{tag})) {\n";
+			$out .= $indent->($store, 2);
+			$out .= "\t}\n\telse {\n\t\tpending = 1;\n\t}\n";
+			$mayPend = 1;
+		}
+	}
+	$out .= "}\n\n";
+
+	$out .= "${fnStatic}DERReturn DERParse$t->{base}(\n";
+	$out .= "\tconst DERItem\t\t\t*der,\n";
+	$out .= "\tvoid\t\t\t\t\t*dest,\t\t\t/* DERDecodedInfo(s) here RETURNED */\n";
+	$out .= "\tDERSize\t\t\t\t\tsizeToZero)\t/* optional */\n";
+	$out .= "{\n";
+	$out .= "\tDERReturn drtn;\n";
+	$out .= "\tDERDecodedInfo topDecode;\n\n";
+	$out .= "\tdrtn = DERDecodeItem(der, &topDecode);\n";
+	$out .= "\tif(drtn) {\n\t\treturn drtn;\n\t}\n";
+	$out .= "\tif(topDecode.tag != ASN1_CONSTR_SEQUENCE) {\n\t\treturn DR_UnexpectedTag;\n\t}\n";
+	$out .= "\treturn DERParse$t->{base}Content(&topDecode.content, dest, sizeToZero);\n";
+	$out .= "}\n\n";
+	return $out;
+}
+
+# the .c file
+my $c = $header . "\n";
+unless ($static) {
+	(my $hname = $outBase) =~ s{.*/}{};
+	$c .= "#include <libDER/$hname.h>\n";
+}
+$c .= "#include <libDER/DER_Decode.h>\n#include <libDER/asn1Types.h>\n";
+$c .= "#include <$_>\n" foreach @includes;
+$c .= "\n";
+$c .= emitDecoder($_) foreach @tables;
+unless ($static) {
+	$c .= "const DERGeneratedDecoder DERGeneratedDecoders[] = \n{\n";
+	foreach my $t (@tables) {
+		$c .= "\t{ \"$t->{base}\", $t->{name}, &DERNum$t->{base}ItemSpecs, DERParse$t->{base}Content },\n";
+	}
+	$c .= "};\n";
+	$c .= "const DERSize DERNumGeneratedDecoders = \n";
+	$c .= "\tsizeof(DERGeneratedDecoders) / sizeof(DERGeneratedDecoder);\n";
+}
+open(my $cfh, '>', "$outBase.c") or die "$outBase.c: $!\n";
+print $cfh $c;
+close $cfh;
+
+exit 0 if $static;
+
+# the .h file
+(my $guard = $outBase) =~ s{.*/}{};
+$guard = '_' . uc($guard) . '_H_';
+my $h = $header . "\n";
+$h .= "#ifndef\t$guard\n#define $guard\n\n";
+$h .= "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n";
+$h .= "#include <libDER/libDER.h>\n\n";
+$h .= "/*\n * Each of these is equivalent to DERParseSequenceContent() or\n";
+$h .= " * DERParseSequence() with the DERItemSpec table of the same name.\n */\n";
+foreach my $t (@tables) {
+	$h .= "DERReturn DERParse$t->{base}Content(const DERItem *content, void *dest,\n\tDERSize sizeToZero);\n";
+	$h .= "DERReturn DERParse$t->{base}(const DERItem *der, void *dest,\n\tDERSize sizeToZero);\n";
+}
+$h .= "\n/* table of generated decoders, for testing */\n";
+$h .= "typedef DERReturn (*DERGeneratedParseFcn)(const DERItem *content, void *dest,\n\tDERSize sizeToZero);\n\n";
+$h .= "typedef struct {\n";
+$h .= "\tconst char\t\t\t\t*name;\n";
+$h .= "\tconst DERItemSpec\t\t*itemSpecs;\n";
+$h .= "\tconst DERSize\t\t\t*numItemSpecs;\n";
+$h .= "\tDERGeneratedParseFcn\tparseContent;\n";
+$h .= "} DERGeneratedDecoder;\n\n";
+$h .= "extern const DERGeneratedDecoder DERGeneratedDecoders[];\n";
+$h .= "extern const DERSize DERNumGeneratedDecoders;\n\n";
+$h .= "#ifdef __cplusplus\n}\n#endif\n\n#endif\t/* $guard */\n";
+open(my $hfh, '>', "$outBase.h") or die "$outBase.h: $!\n";
+print $hfh $h;
+close $hfh;
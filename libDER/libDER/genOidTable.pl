@@ -0,0 +1,252 @@
+#!/usr/bin/perl
+#
+# Copyright (c) 2010 Apple Inc. All Rights Reserved.
+#
+# genOidTable.pl - generate a perfect hash table of the OIDs in oids.c.
+#
+# Each OID defined in oids.c as
+#
+#	static const DERByte _oidFoo[] = { ... };
+#	const DERItem oidFoo = { ... };
+#
+# is given a small integer ID, DOID_Foo, and placed in a hash table sized
+# and seeded so that no two known OIDs share a slot. DEROidLookup() then
+# maps any OID to its ID with one hash and one compare, and the ID can be
+# used to index arrays of per-OID data, such as DEROidStrings[], which
+# holds the dotted decimal form of each OID, computed here.
+#
+# Rerun this whenever an OID is added to oids.c:
+#
+#	cd libDER/libDER && perl genOidTable.pl -o DER_OidTable oids.c
+#
+
+use strict;
+use warnings;
+
+my $outBase;
+my @inFiles;
+
+while (@ARGV) {
+	my $arg = shift @ARGV;
+	if ($arg eq '-o') {
+		$outBase = shift @ARGV;
+	} else {
+		push @inFiles, $arg;
+	}
+}
+die "usage: $0 -o base oids.c...\n" unless defined($outBase) && @inFiles;
+
+my %macros;
+my @oids;		# { name, bytes => [...] } in order of definition
+my %seen;
+
+sub expand {
+	my ($tokens, $depth) = @_;
+	die "macro recursion too deep\n" if $depth > 32;
+	my @bytes;
+	foreach my $tok (split /,/, $tokens) {
+		$tok =~ s/^\s+|\s+$//g;
+		next if $tok eq '';
+		if ($tok =~ /^0x[0-9a-fA-F]+$/) {
+			push @bytes, hex($tok);
+		} elsif ($tok =~ /^\d+$/) {
+			push @bytes, $tok + 0;
+		} elsif (exists $macros{$tok}) {
+			push @bytes, expand($macros{$tok}, $depth + 1);
+		} else {
+			die "unknown token '$tok'\n";
+		}
+	}
+	return @bytes;
+}
+
+foreach my $file (@inFiles) {
+	open(my $fh, '<', $file) or die "$file: $!\n";
+	local $/;
+	my $src = <$fh>;
+	close $fh;
+	$src =~ s{/\*.*?\*/}{}gs;
+	$src =~ s{//[^\n]*}{}g;
+	while ($src =~ /^#define\s+(\w+)[ \t]+([^\n]*)$/mg) {
+		$macros{$1} = $2;
+	}
+	while ($src =~ /\b_oid(\w+)\s*\[\s*\]\s*=\s*\{([^{}]*)\}/g) {
+		my ($name, $body) = ($1, $2);
+		die "$file: duplicate OID $name\n" if $seen{$name}++;
+		my @bytes = expand($body, 0);
+		foreach my $b (@bytes) {
+			die "$file: $name: byte $b out of range\n" if $b > 255;
+		}
+		push @oids, { name => $name, bytes => \@bytes };
+	}
+}
+die "no OIDs found\n" unless @oids;
+die "too many OIDs for a DERByte ID\n" if @oids > 254;
+
+# dotted decimal, as SecDERItemCopyOIDDecimalRepresentation() does it
+sub dotted {
+	my @bytes = @_;
+	my $x = int($bytes[0] / 40);
+	my $y = $bytes[0] % 40;
+	if ($x > 2) {
+		$y += ($x - 2) * 40;
+		$x = 2;
+	}
+	my $str = "$x.$y";
+	my $value = 0;
+	foreach my $b (@bytes[1 .. $#bytes]) {
+		$value = ($value << 7) | ($b & 0x7f);
+		if (!($b & 0x80)) {
+			$str .= ".$value";
+			$value = 0;
+		}
+	}
+	return $str;
+}
+
+# 32 bit multiply without overflowing perl's integers
+sub mul32 {
+	my ($a, $b) = @_;
+	return (($a * ($b & 0xffff)) + ((($a * ($b >> 16)) & 0xffff) << 16)) & 0xffffffff;
+}
+
+# FNV-1a with a seed in place of the offset basis, then a final mix so
+# OIDs differing only in their last byte spread out; must match
+# DEROidLookup()
+sub oidHash {
+	my ($seed, $bytes) = @_;
+	my $h = $seed;
+	foreach my $b (@$bytes) {
+		$h = mul32($h ^ $b, 16777619);
+	}
+	$h ^= $h >> 16;
+	$h = mul32($h, 0x85ebca6b);
+	$h ^= $h >> 13;
+	return $h;
+}
+
+my $tableBits = 1;
+$tableBits++ while (1 << $tableBits) < 4 * @oids;
+my $tableSize = 1 << $tableBits;
+my ($seed, @slots);
+SEED: for my $trySeed (1 .. 1000000) {
+	@slots = (0) x $tableSize;
+	for my $dex (0 .. $#oids) {
+		my $slot = oidHash($trySeed, $oids[$dex]{bytes}) & ($tableSize - 1);
+		next SEED if $slots[$slot];
+		$slots[$slot] = $dex + 1;
+	}
+	$seed = $trySeed;
+	last;
+}
+die "no perfect hash seed found\n" unless defined $seed;
+
+(my $shortFiles = join(', ', @inFiles)) =~ s{[^ ,]*/}{}g;
+(my $guard = "_${outBase}_H_") =~ s/\W/_/g;
+$guard = uc($guard);
+
+open(my $h, '>', "$outBase.h") or die "$outBase.h: $!\n";
+print $h <<"EOF";
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * GENERATED FILE - DO NOT EDIT. Generated by genOidTable.pl from
+ * $shortFiles.
+ */
+
+#ifndef	$guard
+#define $guard
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libDER/libDER.h>
+#include <libDER/oids.h>
+
+/* IDs of the OIDs in oids.c */
+typedef enum {
+	DOID_Unknown = 0,
+EOF
+foreach my $oid (@oids) {
+	printf $h "\tDOID_%s,\n", $oid->{name};
+}
+print $h <<"EOF";
+	DOID_Count
+} DEROidID;
+
+/* indexed by DEROidID; entry 0 is NULL */
+extern const DERItem * const DEROidItems[DOID_Count];
+extern const char * const DEROidStrings[DOID_Count];	/* "2.5.29.15" etc. */
+
+/* Map an OID to its DEROidID, DOID_Unknown if it's not in oids.c. */
+DEROidID DEROidLookup(
+	const DERItem		*oid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* $guard */
+EOF
+close $h;
+
+open(my $c, '>', "$outBase.c") or die "$outBase.c: $!\n";
+(my $hName = $outBase) =~ s{.*/}{};
+print $c <<"EOF";
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * GENERATED FILE - DO NOT EDIT. Generated by genOidTable.pl from
+ * $shortFiles.
+ */
+
+#include <libDER/$hName.h>
+
+const DERItem * const DEROidItems[DOID_Count] = {
+	NULL,
+EOF
+foreach my $oid (@oids) {
+	printf $c "\t&oid%s,\n", $oid->{name};
+}
+print $c "};\n\nconst char * const DEROidStrings[DOID_Count] = {\n\tNULL,\n";
+foreach my $oid (@oids) {
+	printf $c "\t\"%s\",\t\t/* %s */\n", dotted(@{$oid->{bytes}}), $oid->{name};
+}
+printf $c "};\n\n#define DER_OID_HASH_SEED\t%uU\n", $seed;
+printf $c "#define DER_OID_HASH_BITS\t%u\n", $tableBits;
+print $c "#define DER_OID_HASH_SIZE\t(1 << DER_OID_HASH_BITS)\n\n";
+print $c "/* DEROidID for each hash slot */\n";
+print $c "static const DERByte DEROidHashSlots[DER_OID_HASH_SIZE] = {";
+for my $dex (0 .. $#slots) {
+	print $c ($dex % 16) ? ' ' : "\n\t";
+	printf $c "%3u,", $slots[$dex];
+}
+print $c <<"EOF";
+
+};
+
+DEROidID DEROidLookup(
+	const DERItem		*oid)
+{
+	uint32_t hash = DER_OID_HASH_SEED;
+	DERSize dex;
+	DEROidID oidID;
+
+	if(oid == NULL) {
+		return DOID_Unknown;
+	}
+	for(dex=0; dex<oid->length; dex++) {
+		hash = (hash ^ oid->data[dex]) * 16777619U;
+	}
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bU;
+	hash ^= hash >> 13;
+	oidID = (DEROidID)DEROidHashSlots[hash & (DER_OID_HASH_SIZE - 1)];
+	if((oidID != DOID_Unknown) && DEROidCompare(oid, DEROidItems[oidID])) {
+		return oidID;
+	}
+	return DOID_Unknown;
+}
+EOF
+close $c;
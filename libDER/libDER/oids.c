@@ -401,6 +401,10 @@ bool DEROidCompare(const DERItem *oid1, const DERItem *oid2) {
 	if (oid1->length != oid2->length) {
 		return false;
 	}
+	if (oid1->data == oid2->data) {
+		/* e.g. both from oids.c, or DEROidItems[] */
+		return true;
+	}
 	if (!DERMemcmp(oid1->data, oid2->data, oid1->length)) {
 		return true;
 	} else {
@@ -76,7 +76,8 @@ extern const DERItem
     oidAppleProvisioningProfile,
     oidAppleApplicationSigning;
 
-/* Compare two decoded OIDs.  Returns true iff they are equivalent. */
+/* Compare two decoded OIDs.  Returns true iff they are equivalent. To map
+   an OID to one of the above, see DEROidLookup() in DER_OidTable.h. */
 bool DEROidCompare(const DERItem *oid1, const DERItem *oid2);
 
 #ifdef __cplusplus
@@ -0,0 +1,790 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ *
+ * bulkParse.c - parse a corpus of certificates and CRLs in parallel
+ */
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#ifdef __APPLE__
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+#include <libDER/DER_Decode.h>
+#include <libDER/DER_CertCrl.h>
+#include <libDER/DER_Keys.h>
+#include <libDER/DER_Generated.h>
+#include <libDER/asn1Types.h>
+#include "bulkParse.h"
+
+/* objects handed to a worker thread at a time */
+#define BULK_BATCH_SIZE		16
+
+#pragma mark ----- Timing -----
+
+#ifdef __APPLE__
+static mach_timebase_info_data_t bulkTimebase;
+#endif
+
+static void bulkTimeInit(void)
+{
+	#ifdef __APPLE__
+	if(bulkTimebase.denom == 0) {
+		mach_timebase_info(&bulkTimebase);
+	}
+	#endif
+}
+
+/* monotonic time in nanoseconds */
+static uint64_t bulkNow(void)
+{
+	#ifdef __APPLE__
+	return mach_absolute_time() * bulkTimebase.numer / bulkTimebase.denom;
+	#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	#endif
+}
+
+#pragma mark ----- Corpus building -----
+
+void bulkCorpusInit(
+	BulkCorpus			*corpus)
+{
+	memset(corpus, 0, sizeof(*corpus));
+	bulkTimeInit();
+}
+
+static int addSource(
+	BulkCorpus			*corpus,
+	const char			*path,
+	unsigned			*sourceDex)		/* RETURNED */
+{
+	BulkSource *src;
+
+	if(corpus->numSources == corpus->sourcesAlloc) {
+		unsigned newAlloc = corpus->sourcesAlloc ? 2 * corpus->sourcesAlloc : 16;
+		src = (BulkSource *)realloc(corpus->sources, newAlloc * sizeof(BulkSource));
+		if(src == NULL) {
+			return ENOMEM;
+		}
+		corpus->sources = src;
+		corpus->sourcesAlloc = newAlloc;
+	}
+	src = &corpus->sources[corpus->numSources];
+	memset(src, 0, sizeof(*src));
+	src->path = strdup(path);
+	if(src->path == NULL) {
+		return ENOMEM;
+	}
+	*sourceDex = corpus->numSources++;
+	return 0;
+}
+
+static BulkObject *addObject(
+	BulkCorpus			*corpus,
+	unsigned			sourceDex,
+	unsigned			index,
+	size_t				offset)
+{
+	BulkObject *obj;
+
+	if(corpus->numObjects == corpus->objectsAlloc) {
+		unsigned newAlloc = corpus->objectsAlloc ? 2 * corpus->objectsAlloc : 256;
+		obj = (BulkObject *)realloc(corpus->objects, newAlloc * sizeof(BulkObject));
+		if(obj == NULL) {
+			return NULL;
+		}
+		corpus->objects = obj;
+		corpus->objectsAlloc = newAlloc;
+	}
+	obj = &corpus->objects[corpus->numObjects++];
+	memset(obj, 0, sizeof(*obj));
+	obj->source = sourceDex;
+	obj->index = index;
+	obj->offset = offset;
+	return obj;
+}
+
+/* mark an object as failed while splitting its source */
+static void splitFailed(
+	BulkCorpus			*corpus,
+	BulkObject			*obj,
+	DERReturn			drtn)
+{
+	obj->status = drtn;
+	obj->failedPhase = BP_Split;
+	corpus->numFailed++;
+}
+
+/*
+ * Split a concatenation of DER objects. Anything which can't be framed
+ * as a SEQUENCE ends the source, as there's no way to resynchronize.
+ */
+static int splitDER(
+	BulkCorpus			*corpus,
+	unsigned			sourceDex,
+	DERByte				*bytes,
+	size_t				length)
+{
+	size_t offset = 0;
+	unsigned index = 0;
+
+	while(offset < length) {
+		DERItem remaining;
+		DERDecodedInfo decoded;
+		DERReturn drtn;
+		BulkObject *obj;
+
+		remaining.data = bytes + offset;
+		remaining.length = (DERSize)(length - offset);
+		obj = addObject(corpus, sourceDex, index++, offset);
+		if(obj == NULL) {
+			return ENOMEM;
+		}
+		drtn = DERDecodeItem(&remaining, &decoded);
+		if((drtn == DR_Success) && (decoded.tag != ASN1_CONSTR_SEQUENCE)) {
+			drtn = DR_UnexpectedTag;
+		}
+		if(drtn) {
+			obj->der = remaining;
+			splitFailed(corpus, obj, drtn);
+			break;
+		}
+		obj->der.data = remaining.data;
+		obj->der.length = (DERSize)(decoded.content.data + decoded.content.length -
+			remaining.data);
+		corpus->totalBytes += obj->der.length;
+		offset += obj->der.length;
+	}
+	return 0;
+}
+
+static int base64Value(
+	unsigned char		c)
+{
+	if((c >= 'A') && (c <= 'Z')) {
+		return c - 'A';
+	}
+	if((c >= 'a') && (c <= 'z')) {
+		return c - 'a' + 26;
+	}
+	if((c >= '0') && (c <= '9')) {
+		return c - '0' + 52;
+	}
+	if(c == '+') {
+		return 62;
+	}
+	if(c == '/') {
+		return 63;
+	}
+	return -1;
+}
+
+/* base64 decode in to out, which has room for at least 3/4 of inLen */
+static DERReturn base64Decode(
+	const unsigned char	*in,
+	size_t				inLen,
+	unsigned char		*out,
+	size_t				*outLen)		/* RETURNED */
+{
+	size_t dex;
+	unsigned accum = 0;
+	unsigned numBits = 0;
+	size_t len = 0;
+	int padding = 0;
+
+	for(dex=0; dex<inLen; dex++) {
+		unsigned char c = in[dex];
+		int value;
+
+		if((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n')) {
+			continue;
+		}
+		if(c == '=') {
+			padding = 1;
+			continue;
+		}
+		value = base64Value(c);
+		if((value < 0) || padding) {
+			return DR_DecodeError;
+		}
+		accum = (accum << 6) | value;
+		numBits += 6;
+		if(numBits >= 8) {
+			numBits -= 8;
+			out[len++] = (unsigned char)(accum >> numBits);
+		}
+	}
+	*outLen = len;
+	return DR_Success;
+}
+
+/* find needle in haystack, for PEM markers; NULL if not found */
+static const unsigned char *findBytes(
+	const unsigned char	*haystack,
+	const unsigned char	*end,
+	const char			*needle)
+{
+	size_t needleLen = strlen(needle);
+
+	while((size_t)(end - haystack) >= needleLen) {
+		const unsigned char *p = memchr(haystack, needle[0], end - haystack);
+		if((p == NULL) || ((size_t)(end - p) < needleLen)) {
+			return NULL;
+		}
+		if(memcmp(p, needle, needleLen) == 0) {
+			return p;
+		}
+		haystack = p + 1;
+	}
+	return NULL;
+}
+
+/* PEM labels we parse; other blocks (keys, etc.) are skipped */
+static int pemLabelWanted(
+	const unsigned char	*label,
+	size_t				labelLen)
+{
+	static const char *wanted[] = {
+		"CERTIFICATE", "X509 CERTIFICATE", "TRUSTED CERTIFICATE", "X509 CRL"
+	};
+	unsigned dex;
+
+	for(dex=0; dex<sizeof(wanted)/sizeof(wanted[0]); dex++) {
+		if((strlen(wanted[dex]) == labelLen) &&
+		   (memcmp(wanted[dex], label, labelLen) == 0)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* split a PEM bundle; the decoded objects live in src->decoded */
+static int splitPEM(
+	BulkCorpus			*corpus,
+	unsigned			sourceDex,
+	const unsigned char	*bytes,
+	size_t				length)
+{
+	static const char beginMarker[] = "-----BEGIN ";
+	static const char endMarker[] = "-----END ";
+	const unsigned char *end = bytes + length;
+	const unsigned char *cur = bytes;
+	unsigned char *out;
+	unsigned index = 0;
+
+	out = (unsigned char *)malloc(length);
+	if(out == NULL) {
+		return ENOMEM;
+	}
+	corpus->sources[sourceDex].decoded = out;
+
+	for(;;) {
+		const unsigned char *begin, *label, *labelEnd, *body, *bodyEnd;
+		BulkObject *obj;
+		DERReturn drtn;
+		size_t outLen;
+
+		begin = findBytes(cur, end, beginMarker);
+		if(begin == NULL) {
+			break;
+		}
+		label = begin + sizeof(beginMarker) - 1;
+		labelEnd = findBytes(label, end, "-----");
+		if(labelEnd == NULL) {
+			break;
+		}
+		body = labelEnd + 5;
+		bodyEnd = findBytes(body, end, endMarker);
+		if(bodyEnd == NULL) {
+			bodyEnd = end;
+		}
+		cur = bodyEnd;
+		if(!pemLabelWanted(label, labelEnd - label)) {
+			continue;
+		}
+
+		obj = addObject(corpus, sourceDex, index++, begin - bytes);
+		if(obj == NULL) {
+			return ENOMEM;
+		}
+		if(bodyEnd == end) {
+			splitFailed(corpus, obj, DR_IncompleteSeq);
+			break;
+		}
+		drtn = base64Decode(body, bodyEnd - body, out, &outLen);
+		if(drtn) {
+			splitFailed(corpus, obj, drtn);
+			continue;
+		}
+		obj->der.data = out;
+		obj->der.length = (DERSize)outLen;
+		corpus->totalBytes += outLen;
+		out += outLen;
+	}
+	return 0;
+}
+
+/*
+ * PEM iff there's a BEGIN marker and it doesn't look like DER; PEM
+ * bundles often have explanatory text ahead of each block.
+ */
+static int isPEM(
+	const unsigned char	*bytes,
+	size_t				length)
+{
+	if((length == 0) || (bytes[0] == 0x30)) {		/* SEQUENCE */
+		return 0;
+	}
+	return findBytes(bytes, bytes + length, "-----BEGIN ") != NULL;
+}
+
+static int addFile(
+	BulkCorpus			*corpus,
+	const char			*path,
+	const struct stat	*sb)
+{
+	unsigned sourceDex;
+	BulkSource *src;
+	uint64_t start, loaded;
+	int fd;
+	int rtn;
+
+	if(sb->st_size == 0) {
+		return 0;
+	}
+	if((uint64_t)sb->st_size > (DERSize)-1) {
+		return EFBIG;
+	}
+	start = bulkNow();
+	rtn = addSource(corpus, path, &sourceDex);
+	if(rtn) {
+		return rtn;
+	}
+	src = &corpus->sources[sourceDex];
+	fd = open(path, O_RDONLY, 0);
+	if(fd < 0) {
+		return errno;
+	}
+	src->map = mmap(NULL, (size_t)sb->st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	rtn = errno;
+	close(fd);
+	if(src->map == MAP_FAILED) {
+		src->map = NULL;
+		return rtn;
+	}
+	src->mapSize = (size_t)sb->st_size;
+	loaded = bulkNow();
+	corpus->phaseTime[BP_Load] += (loaded - start) / 1e9;
+
+	if(isPEM((const unsigned char *)src->map, src->mapSize)) {
+		rtn = splitPEM(corpus, sourceDex, (const unsigned char *)src->map,
+			src->mapSize);
+	}
+	else {
+		rtn = splitDER(corpus, sourceDex, (DERByte *)src->map, src->mapSize);
+	}
+	corpus->phaseTime[BP_Split] += (bulkNow() - loaded) / 1e9;
+	return rtn;
+}
+
+static int addDirectory(
+	BulkCorpus			*corpus,
+	const char			*path)
+{
+	DIR *dir;
+	struct dirent *entry;
+	int rtn = 0;
+
+	dir = opendir(path);
+	if(dir == NULL) {
+		return errno;
+	}
+	while((rtn == 0) && ((entry = readdir(dir)) != NULL)) {
+		size_t len;
+		char *child;
+
+		if(entry->d_name[0] == '.') {
+			continue;
+		}
+		len = strlen(path) + strlen(entry->d_name) + 2;
+		child = (char *)malloc(len);
+		if(child == NULL) {
+			rtn = ENOMEM;
+			break;
+		}
+		snprintf(child, len, "%s/%s", path, entry->d_name);
+		rtn = bulkCorpusAddPath(corpus, child);
+		free(child);
+	}
+	closedir(dir);
+	return rtn;
+}
+
+int bulkCorpusAddPath(
+	BulkCorpus			*corpus,
+	const char			*path)
+{
+	struct stat sb;
+
+	if(stat(path, &sb)) {
+		return errno;
+	}
+	if(S_ISDIR(sb.st_mode)) {
+		return addDirectory(corpus, path);
+	}
+	if(S_ISREG(sb.st_mode)) {
+		return addFile(corpus, path, &sb);
+	}
+	/* devices, sockets, etc. */
+	return 0;
+}
+
+void bulkCorpusFree(
+	BulkCorpus			*corpus)
+{
+	unsigned dex;
+
+	for(dex=0; dex<corpus->numSources; dex++) {
+		BulkSource *src = &corpus->sources[dex];
+		if(src->map) {
+			munmap(src->map, src->mapSize);
+		}
+		free(src->decoded);
+		free(src->path);
+	}
+	free(corpus->sources);
+	free(corpus->objects);
+	memset(corpus, 0, sizeof(*corpus));
+}
+
+#pragma mark ----- Parsing -----
+
+/* per-thread state and results */
+typedef struct {
+	BulkCorpus			*corpus;
+	unsigned			*nextObject;	/* shared */
+	uint64_t			phaseTime[BP_NumPhases];
+	unsigned			numCerts;
+	unsigned			numCrls;
+	unsigned			numFailed;
+} BulkWorker;
+
+/* parse each Extension in the content of an EXPLICITly tagged Extensions */
+static DERReturn parseExtensions(
+	const DERItem		*extensions,
+	unsigned			*numExtensions)		/* RETURNED */
+{
+	DERSequence seq;
+	DERDecodedInfo currDecoded;
+	DERExtension extn;
+	DERTag tag;
+	DERReturn drtn;
+
+	*numExtensions = 0;
+	if(extensions->length == 0) {
+		return DR_Success;
+	}
+	drtn = DERDecodeSeqInit(extensions, &tag, &seq);
+	if(drtn) {
+		return drtn;
+	}
+	if(tag != ASN1_CONSTR_SEQUENCE) {
+		return DR_UnexpectedTag;
+	}
+	while((drtn = DERDecodeSeqNext(&seq, &currDecoded)) == DR_Success) {
+		if(currDecoded.tag != ASN1_CONSTR_SEQUENCE) {
+			return DR_UnexpectedTag;
+		}
+		drtn = DERParseExtensionContent(&currDecoded.content, &extn, sizeof(extn));
+		if(drtn) {
+			return drtn;
+		}
+		(*numExtensions)++;
+	}
+	return (drtn == DR_EndOfSequence) ? DR_Success : drtn;
+}
+
+static DERReturn parseCertFields(
+	const DERSignedCertCrl	*signedCert,
+	const DERTBSCert		*tbs,
+	unsigned				*numItems)
+{
+	DERAlgorithmId algId;
+	DERValidity validity;
+	DERSubjPubKeyInfo pubKeyInfo;
+	DERItem sigBits;
+	DERByte numUnused;
+	DERReturn drtn;
+
+	drtn = DERParseAlgorithmIdContent(&signedCert->sigAlg, &algId, sizeof(algId));
+	if(drtn) {
+		return drtn;
+	}
+	drtn = DERParseBitString(&signedCert->sig, &sigBits, &numUnused);
+	if(drtn) {
+		return drtn;
+	}
+	drtn = DERParseAlgorithmIdContent(&tbs->tbsSigAlg, &algId, sizeof(algId));
+	if(drtn) {
+		return drtn;
+	}
+	drtn = DERParseValidityContent(&tbs->validity, &validity, sizeof(validity));
+	if(drtn) {
+		return drtn;
+	}
+	drtn = DERParseSubjPubKeyInfoContent(&tbs->subjectPubKey, &pubKeyInfo,
+		sizeof(pubKeyInfo));
+	if(drtn) {
+		return drtn;
+	}
+	drtn = DERParseAlgorithmIdContent(&pubKeyInfo.algId, &algId, sizeof(algId));
+	if(drtn) {
+		return drtn;
+	}
+	return parseExtensions(&tbs->extensions, numItems);
+}
+
+static DERReturn parseCrlFields(
+	const DERSignedCertCrl	*signedCert,
+	const DERTBSCrl			*tbs,
+	unsigned				*numItems)
+{
+	DERAlgorithmId algId;
+	DERItem sigBits;
+	DERByte numUnused;
+	DERSequence seq;
+	DERDecodedInfo currDecoded;
+	DERRevokedCert revoked;
+	unsigned numExtensions;
+	DERReturn drtn;
+
+	*numItems = 0;
+	drtn = DERParseAlgorithmIdContent(&signedCert->sigAlg, &algId, sizeof(algId));
+	if(drtn) {
+		return drtn;
+	}
+	drtn = DERParseBitString(&signedCert->sig, &sigBits, &numUnused);
+	if(drtn) {
+		return drtn;
+	}
+	drtn = DERParseAlgorithmIdContent(&tbs->tbsSigAlg, &algId, sizeof(algId));
+	if(drtn) {
+		return drtn;
+	}
+	if(tbs->revokedCerts.length) {
+		drtn = DERDecodeSeqContentInit(&tbs->revokedCerts, &seq);
+		if(drtn) {
+			return drtn;
+		}
+		while((drtn = DERDecodeSeqNext(&seq, &currDecoded)) == DR_Success) {
+			if(currDecoded.tag != ASN1_CONSTR_SEQUENCE) {
+				return DR_UnexpectedTag;
+			}
+			drtn = DERParseRevokedCertContent(&currDecoded.content, &revoked,
+				sizeof(revoked));
+			if(drtn) {
+				return drtn;
+			}
+			(*numItems)++;
+		}
+		if(drtn != DR_EndOfSequence) {
+			return drtn;
+		}
+	}
+	return parseExtensions(&tbs->extensions, &numExtensions);
+}
+
+/* parse one object, accumulating time per phase into worker */
+static void parseObject(
+	BulkWorker			*worker,
+	BulkObject			*obj)
+{
+	DERSignedCertCrl signedCert;
+	DERTBSCert tbsCert;
+	DERTBSCrl tbsCrl;
+	uint64_t t0, t1, t2;
+	DERReturn drtn;
+
+	t0 = bulkNow();
+	obj->type = BO_Unknown;
+	obj->numItems = 0;
+	drtn = DERParseSignedCertCrl(&obj->der, &signedCert, sizeof(signedCert));
+	t1 = bulkNow();
+	worker->phaseTime[BP_Outer] += t1 - t0;
+	if(drtn) {
+		obj->failedPhase = BP_Outer;
+		goto done;
+	}
+
+	/* the TBS tells us which it is; a CRL fails as a cert at the latest
+	 * at the validity/thisUpdate item */
+	drtn = DERParseTBSCert(&signedCert.tbs, &tbsCert, sizeof(tbsCert));
+	if(drtn == DR_Success) {
+		obj->type = BO_Cert;
+	}
+	else if(DERParseTBSCrl(&signedCert.tbs, &tbsCrl, sizeof(tbsCrl)) == DR_Success) {
+		obj->type = BO_Crl;
+		drtn = DR_Success;
+	}
+	t2 = bulkNow();
+	worker->phaseTime[BP_TBS] += t2 - t1;
+	if(drtn) {
+		/* report the cert error, the more likely intent */
+		obj->failedPhase = BP_TBS;
+		goto done;
+	}
+
+	if(obj->type == BO_Cert) {
+		drtn = parseCertFields(&signedCert, &tbsCert, &obj->numItems);
+	}
+	else {
+		drtn = parseCrlFields(&signedCert, &tbsCrl, &obj->numItems);
+	}
+	worker->phaseTime[BP_Fields] += bulkNow() - t2;
+	if(drtn) {
+		obj->failedPhase = BP_Fields;
+	}
+done:
+	obj->status = drtn;
+	if(drtn) {
+		worker->numFailed++;
+	}
+	else if(obj->type == BO_Cert) {
+		worker->numCerts++;
+	}
+	else {
+		worker->numCrls++;
+	}
+}
+
+static void *bulkWorkerThread(
+	void				*arg)
+{
+	BulkWorker *worker = (BulkWorker *)arg;
+	BulkCorpus *corpus = worker->corpus;
+
+	for(;;) {
+		unsigned start = __sync_fetch_and_add(worker->nextObject, BULK_BATCH_SIZE);
+		unsigned end = start + BULK_BATCH_SIZE;
+		unsigned dex;
+
+		if(start >= corpus->numObjects) {
+			break;
+		}
+		if(end > corpus->numObjects) {
+			end = corpus->numObjects;
+		}
+		for(dex=start; dex<end; dex++) {
+			BulkObject *obj = &corpus->objects[dex];
+			if((obj->status != DR_Success) && (obj->failedPhase == BP_Split)) {
+				/* never got as far as having an object */
+				worker->numFailed++;
+				continue;
+			}
+			parseObject(worker, obj);
+		}
+	}
+	return NULL;
+}
+
+int bulkCorpusParse(
+	BulkCorpus			*corpus,
+	unsigned			numThreads)
+{
+	BulkWorker *workers;
+	pthread_t *threads;
+	unsigned nextObject = 0;
+	unsigned dex;
+	unsigned phase;
+	uint64_t start;
+	int rtn = 0;
+
+	if(numThreads == 0) {
+		long numCpus = sysconf(_SC_NPROCESSORS_ONLN);
+		numThreads = (numCpus > 0) ? (unsigned)numCpus : 1;
+	}
+	workers = (BulkWorker *)calloc(numThreads, sizeof(BulkWorker));
+	threads = (pthread_t *)calloc(numThreads, sizeof(pthread_t));
+	if((workers == NULL) || (threads == NULL)) {
+		free(workers);
+		free(threads);
+		return ENOMEM;
+	}
+
+	start = bulkNow();
+	for(dex=0; dex<numThreads; dex++) {
+		workers[dex].corpus = corpus;
+		workers[dex].nextObject = &nextObject;
+		if(dex == 0) {
+			/* the calling thread is worker 0 */
+			continue;
+		}
+		rtn = pthread_create(&threads[dex], NULL, bulkWorkerThread, &workers[dex]);
+		if(rtn) {
+			/* carry on with the threads we have */
+			numThreads = dex;
+			rtn = 0;
+			break;
+		}
+	}
+	bulkWorkerThread(&workers[0]);
+	for(dex=1; dex<numThreads; dex++) {
+		pthread_join(threads[dex], NULL);
+	}
+	corpus->parseTime = (bulkNow() - start) / 1e9;
+
+	corpus->numThreads = numThreads;
+	corpus->numCerts = 0;
+	corpus->numCrls = 0;
+	corpus->numFailed = 0;
+	for(phase=BP_Outer; phase<BP_NumPhases; phase++) {
+		corpus->phaseTime[phase] = 0.0;
+	}
+	for(dex=0; dex<numThreads; dex++) {
+		corpus->numCerts += workers[dex].numCerts;
+		corpus->numCrls += workers[dex].numCrls;
+		corpus->numFailed += workers[dex].numFailed;
+		for(phase=BP_Outer; phase<BP_NumPhases; phase++) {
+			corpus->phaseTime[phase] += workers[dex].phaseTime[phase] / 1e9;
+		}
+	}
+	free(workers);
+	free(threads);
+	return rtn;
+}
+
+const char *bulkPhaseString(
+	BulkPhase			phase)
+{
+	switch(phase) {
+		case BP_Load:	return "load";
+		case BP_Split:	return "split";
+		case BP_Outer:	return "outer";
+		case BP_TBS:	return "tbs";
+		case BP_Fields:	return "fields";
+		default:		return "unknown";
+	}
+}
+
+const char *bulkObjectTypeString(
+	BulkObjectType		type)
+{
+	switch(type) {
+		case BO_Cert:	return "cert";
+		case BO_Crl:	return "crl";
+		default:		return "unknown";
+	}
+}
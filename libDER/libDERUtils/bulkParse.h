@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2010 Apple Inc. All Rights Reserved.
+ */
+
+/*
+ * bulkParse.h - parse a corpus of certificates and CRLs in parallel
+ */
+
+#ifndef	_BULK_PARSE_H_
+#define _BULK_PARSE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <libDER/libDER.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A corpus is built up from any number of paths, each of which may be a
+ * directory (walked recursively, skipping dot files), a single DER
+ * object, a concatenation of DER objects, or a PEM bundle. Files are
+ * mmapped and DER objects are parsed in place; only PEM input is copied,
+ * when it's base64 decoded. The objects are then parsed across a pool of
+ * threads with bulkCorpusParse(), which may be called repeatedly, e.g.
+ * for benchmarking.
+ */
+
+typedef enum {
+	BO_Unknown,			/* not yet parsed, or not recognized */
+	BO_Cert,
+	BO_Crl
+} BulkObjectType;
+
+/* where time goes, and where an object failed */
+typedef enum {
+	BP_Load,			/* open, stat, mmap, directory walk */
+	BP_Split,			/* splitting files into objects, PEM decode */
+	BP_Outer,			/* SignedCertCrl */
+	BP_TBS,				/* TBSCert or TBSCrl */
+	BP_Fields,			/* algorithm IDs, validity, key, extensions, entries */
+	BP_NumPhases
+} BulkPhase;
+
+typedef struct {
+	unsigned			source;			/* index into BulkCorpus.sources */
+	unsigned			index;			/* object number within source */
+	size_t				offset;			/* of object (or PEM block) in source */
+	DERItem				der;
+	BulkObjectType		type;
+	DERReturn			status;
+	BulkPhase			failedPhase;	/* valid if status != DR_Success */
+	unsigned			numItems;		/* extensions (cert), revoked certs (CRL) */
+} BulkObject;
+
+typedef struct {
+	char				*path;
+	void				*map;			/* mmapped file */
+	size_t				mapSize;
+	unsigned char		*decoded;		/* PEM only, mallocd */
+} BulkSource;
+
+typedef struct {
+	BulkSource			*sources;
+	unsigned			numSources;
+	unsigned			sourcesAlloc;
+	BulkObject			*objects;
+	unsigned			numObjects;
+	unsigned			objectsAlloc;
+	uint64_t			totalBytes;		/* of DER objects */
+
+	/*
+	 * Results of the most recent bulkCorpusParse(). Phase times are in
+	 * seconds; BP_Load and BP_Split accumulate over bulkCorpusAddPath()
+	 * calls, the others are summed over all threads.
+	 */
+	unsigned			numCerts;
+	unsigned			numCrls;
+	unsigned			numFailed;		/* including split failures */
+	double				phaseTime[BP_NumPhases];
+	double				parseTime;		/* wall clock */
+	unsigned			numThreads;
+} BulkCorpus;
+
+void bulkCorpusInit(
+	BulkCorpus			*corpus);
+
+/*
+ * Add a file or directory. Returns an errno if a file can't be read;
+ * malformed content is not an error here, it's recorded as a failed
+ * BulkObject.
+ */
+int bulkCorpusAddPath(
+	BulkCorpus			*corpus,
+	const char			*path);
+
+/* Parse every object; numThreads 0 means one per online CPU. */
+int bulkCorpusParse(
+	BulkCorpus			*corpus,
+	unsigned			numThreads);
+
+void bulkCorpusFree(
+	BulkCorpus			*corpus);
+
+const char *bulkPhaseString(
+	BulkPhase			phase);
+const char *bulkObjectTypeString(
+	BulkObjectType		type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* _BULK_PARSE_H_ */
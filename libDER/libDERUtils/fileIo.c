@@ -91,3 +91,52 @@ errOut:
 	close(fd);
 	return rtn;
 }
+
+/*
+ * Read a file in chunks, without ever holding the whole thing in memory.
+ */
+int readFileChunks(
+	const char			*fileName,
+	unsigned			chunkSize,
+	readFileChunkFcn	chunkFcn,
+	void				*context)
+{
+	int rtn = 0;
+	int fd;
+	unsigned char *buf;
+	ssize_t thisRead;
+	
+	if(chunkSize == 0) {
+		return EINVAL;
+	}
+	fd = open(fileName, O_RDONLY, 0);
+	if(fd <= 0) {
+		return errno;
+	}
+	buf = (unsigned char *)malloc(chunkSize);
+	if(buf == NULL) {
+		close(fd);
+		return ENOMEM;
+	}
+	for(;;) {
+		thisRead = read(fd, buf, (size_t)chunkSize);
+		if(thisRead < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			rtn = errno;
+			break;
+		}
+		if(thisRead == 0) {
+			/* EOF */
+			break;
+		}
+		rtn = chunkFcn(context, buf, (unsigned)thisRead);
+		if(rtn) {
+			break;
+		}
+	}
+	free(buf);
+	close(fd);
+	return rtn;
+}
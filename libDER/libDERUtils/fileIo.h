@@ -17,6 +17,23 @@ int readFile(
 	unsigned char		**bytes,		// mallocd and returned
 	unsigned			*numBytes);		// returned
 
+/*
+ * Read a file in chunks of up to chunkSize bytes, passing each chunk to
+ * chunkFcn as it arrives; only one chunk is ever held in memory. Stops
+ * at EOF or when chunkFcn returns nonzero, in which case that value is
+ * returned.
+ */
+typedef int (*readFileChunkFcn)(
+	void				*context,
+	const unsigned char	*bytes,
+	unsigned			numBytes);
+
+int readFileChunks(
+	const char			*fileName,
+	unsigned			chunkSize,
+	readFileChunkFcn	chunkFcn,
+	void				*context);
+
 int writeFile(
 	const char			*fileName,
 	const unsigned char	*bytes,
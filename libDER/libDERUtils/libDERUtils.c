@@ -21,6 +21,8 @@ const char *DERReturnString(
 		case DR_DecodeError: return "DR_DecodeError";
 		case DR_Unimplemented: return "DR_Unimplemented";
 		case DR_IncompleteSeq: return "DR_IncompleteSeq";
+		case DR_ParamErr: return "DR_ParamErr";
+		case DR_BufOverflow: return "DR_BufOverflow";
 		default:
 			sprintf(unknown, "Unknown error (%d)", (int)drtn);
 			return unknown;